@@ -67,6 +67,12 @@ float dayLength = 600.0f;
 bool autoTimeProgression = true;
 float fogDensity = 0.008f;
 int renderDistance = 4;
+const int MAX_RENDER_DISTANCE = 48;
+bool enableMeshLod = true;
+int meshLodRings[3] = {8, 16, 32};
+bool enableHorizon = true;
+int horizonDistance = 64;
+const int MAX_HORIZON_DISTANCE = 128;
 
 bool chatOpen = false;
 bool chatFocusNext = false;
@@ -87,6 +93,11 @@ int frustumSolidDrawn = 0;
 int frustumWaterTested = 0;
 int frustumWaterCulled = 0;
 int frustumWaterDrawn = 0;
+int solidQuadsDrawn = 0;
+int solidQuadsBackfaceCulled = 0;
+int lodChunksDrawn[4] = {};
+int horizonTilesDrawn = 0;
+int lightVolumesRefreshed = 0;
 
 Player* g_player = nullptr;
 ChunkManager* g_chunkManager = nullptr;
@@ -568,7 +579,7 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
           if (c)
           {
             glm::ivec3 local = worldToLocal(hit->blockPos.x, hit->blockPos.y, hit->blockPos.z);
-            skyLight = static_cast<float>(c->skyLight[blockIndex(local.x, local.y, local.z)]) / static_cast<float>(MAX_SKY_LIGHT);
+            skyLight = static_cast<float>(c->skyLight.get(blockIndex(local.x, local.y, local.z))) / static_cast<float>(MAX_SKY_LIGHT);
           }
         }
         glm::vec4 particleTint(1.0f);
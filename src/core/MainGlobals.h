@@ -52,6 +52,16 @@ extern float dayLength;
 extern bool autoTimeProgression;
 extern float fogDensity;
 extern int renderDistance;
+extern const int MAX_RENDER_DISTANCE;
+// Chunks at least meshLodRings[l - 1] chunks away horizontally are meshed
+// at LOD l (2x, 4x, 8x blocks per cell).
+extern bool enableMeshLod;
+extern int meshLodRings[3];
+// Heightfield horizon drawn past the streamed chunks, out to horizonDistance
+// chunks from the player.
+extern bool enableHorizon;
+extern int horizonDistance;
+extern const int MAX_HORIZON_DISTANCE;
 
 extern bool chatOpen;
 extern bool chatFocusNext;
@@ -74,6 +84,11 @@ extern int frustumSolidDrawn;
 extern int frustumWaterTested;
 extern int frustumWaterCulled;
 extern int frustumWaterDrawn;
+extern int solidQuadsDrawn;
+extern int solidQuadsBackfaceCulled;
+extern int lodChunksDrawn[4];
+extern int horizonTilesDrawn;
+extern int lightVolumesRefreshed;
 
 extern Player* g_player;
 extern ChunkManager* g_chunkManager;
@@ -12,8 +12,10 @@
 #include "glm/ext/matrix_transform.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <iostream>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <iostream>
 #include "embedded_assets.h"
 
 void Renderer::init()
@@ -29,6 +31,15 @@ void Renderer::init()
     fogColorLoc   = glGetUniformLocation(shaderProgram->ID, "fogColor");
     fogDensityLoc = glGetUniformLocation(shaderProgram->ID, "fogDensity");
     ambientLightLoc = glGetUniformLocation(shaderProgram->ID, "ambientLight");
+    useLightVolumeLoc = glGetUniformLocation(shaderProgram->ID, "useLightVolume");
+    glUniform1i(glGetUniformLocation(shaderProgram->ID, "lightVolume"), 1);
+
+    // Chunk vertices carry a tint palette index instead of a colour.
+    glm::vec3 tintPalette[TINT_PALETTE_SIZE];
+    for (int i = 0; i < TINT_PALETTE_SIZE; i++)
+        tintPalette[i] = tintPaletteColor(i);
+    glUniform3fv(glGetUniformLocation(shaderProgram->ID, "tintPalette"),
+                 TINT_PALETTE_SIZE, glm::value_ptr(tintPalette[0]));
 
     stbi_set_flip_vertically_on_load(false);
 
@@ -219,6 +230,18 @@ void Renderer::init()
     waterFogDensityLoc     = glGetUniformLocation(waterShader->ID, "fogDensity");
     waterAmbientLightLoc   = glGetUniformLocation(waterShader->ID, "ambientLight");
     waterEnableCausticsLoc = glGetUniformLocation(waterShader->ID, "enableCaustics");
+    waterUseLightVolumeLoc = glGetUniformLocation(waterShader->ID, "useLightVolume");
+    glUniform1i(glGetUniformLocation(waterShader->ID, "lightVolume"), 1);
+
+    horizonShader = std::make_unique<Shader>("horizon.vert", "horizon.frag");
+    horizonTransformLoc      = glGetUniformLocation(horizonShader->ID, "transform");
+    horizonModelLoc          = glGetUniformLocation(horizonShader->ID, "model");
+    horizonTimeOfDayLoc      = glGetUniformLocation(horizonShader->ID, "timeOfDay");
+    horizonAmbientLightLoc   = glGetUniformLocation(horizonShader->ID, "ambientLight");
+    horizonCameraPosLoc      = glGetUniformLocation(horizonShader->ID, "cameraPos");
+    horizonFogColorLoc       = glGetUniformLocation(horizonShader->ID, "fogColor");
+    horizonFogDensityLoc     = glGetUniformLocation(horizonShader->ID, "fogDensity");
+    horizonStreamedBoundsLoc = glGetUniformLocation(horizonShader->ID, "streamedBounds");
 
     const float s = 1.002f;
     const float o = -0.001f;
@@ -277,10 +300,12 @@ void Renderer::cleanup()
     glDeleteVertexArrays(1, &faceVAO);
     glDeleteBuffers(1, &faceVBO);
     glDeleteBuffers(1, &faceEBO);
+    releaseQuadIndexBuffer();
 
     if (selectionShader) selectionShader->Delete();
     if (destroyShader) destroyShader->Delete();
     if (waterShader) waterShader->Delete();
+    if (horizonShader) horizonShader->Delete();
     if (itemModelShader) itemModelShader->Delete();
     if (toolModelShader) toolModelShader->Delete();
 
@@ -304,6 +329,11 @@ void Renderer::beginFrame(const FrameParams& fp)
     frustumWaterTested = 0;
     frustumWaterCulled = 0;
     frustumWaterDrawn = 0;
+    solidQuadsDrawn = 0;
+    solidQuadsBackfaceCulled = 0;
+    std::fill(std::begin(lodChunksDrawn), std::end(lodChunksDrawn), 0);
+    horizonTilesDrawn = 0;
+    lightVolumesRefreshed = 0;
 
     shaderProgram->Activate();
     glBindTexture(GL_TEXTURE_2D_ARRAY, textureArray);
@@ -325,15 +355,80 @@ void Renderer::beginFrame(const FrameParams& fp)
     glUniform1f(ambientLightLoc, fp.ambientLight);
 }
 
+// Bit d is set when some face of direction d inside the box can face the
+// eye. A face with normal +X at plane x is front-facing only for eye.x > x.
+static uint32_t visibleFaceMask(const glm::vec3& eye, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+    uint32_t mask = 0;
+    if (eye.x > boxMin.x) mask |= 1u << DIR_POS_X;
+    if (eye.x < boxMax.x) mask |= 1u << DIR_NEG_X;
+    if (eye.y > boxMin.y) mask |= 1u << DIR_POS_Y;
+    if (eye.y < boxMax.y) mask |= 1u << DIR_NEG_Y;
+    if (eye.z > boxMin.z) mask |= 1u << DIR_POS_Z;
+    if (eye.z < boxMax.z) mask |= 1u << DIR_NEG_Z;
+    return mask;
+}
+
+// LOD for a chunk ring chunks away from the camera's chunk column.
+static uint8_t meshLodForRing(int ring)
+{
+    if (!enableMeshLod)
+        return 0;
+    uint8_t lod = 0;
+    for (int l = 1; l < MESH_LOD_COUNT; l++)
+    {
+        if (ring >= meshLodRings[l - 1])
+            lod = static_cast<uint8_t>(l);
+    }
+    return lod;
+}
+
+// Points the bound chunk shader at c's light volume, refreshing it first if
+// light changed since it was filled. Meshes with baked light skip it.
+static void bindLightVolume(Chunk& c, ChunkManager& cm, GLint useLightVolumeLoc)
+{
+    glUniform1i(useLightVolumeLoc, c.meshLightVolume ? 1 : 0);
+    if (!c.meshLightVolume)
+        return;
+    if (c.lightVolumeDirty)
+    {
+        refreshLightVolume(c, cm);
+        lightVolumesRefreshed++;
+    }
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, c.lightTex);
+    glActiveTexture(GL_TEXTURE0);
+}
+
 void Renderer::renderChunks(const FrameParams& fp, ChunkManager& cm)
 {
     const glm::mat4 viewProj = fp.proj * fp.view;
     const Frustum frustum = Frustum::fromMatrix(viewProj);
     const float chunkSizeF = static_cast<float>(CHUNK_SIZE);
+    const glm::ivec3 eyeChunk = glm::ivec3(glm::floor(fp.eyePos / chunkSizeF));
 
-    for (auto& pair : cm.chunks)
+    for (auto& slot : cm.entries)
     {
-        Chunk* chunk = pair.second.get();
+        Chunk* chunk = slot.value.chunk.get();
+        if (!chunk)
+            continue;
+
+        // Picked before any culling so chunks behind the camera are already
+        // at the right level when it turns. A change is remeshed through the
+        // normal dirty path; the old mesh draws until the new one lands.
+        if (!chunk->isPlaceholder())
+        {
+            const int ring = std::max(std::abs(chunk->position.x - eyeChunk.x),
+                                      std::abs(chunk->position.z - eyeChunk.z));
+            const uint8_t lod = meshLodForRing(ring);
+            if (lod != chunk->wantedLod)
+            {
+                chunk->wantedLod = lod;
+                chunk->markMeshDirty();
+                cm.queueMesh(chunk);
+            }
+        }
+
         if (chunk->indexCount == 0)
             continue;
         frustumSolidTested++;
@@ -356,13 +451,76 @@ void Renderer::renderChunks(const FrameParams& fp, ChunkManager& cm)
 
         glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(chunkMVP));
         glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(chunkModel));
+        bindLightVolume(*chunk, cm, useLightVolumeLoc);
 
         glBindVertexArray(chunk->vao);
-        glDrawElements(GL_TRIANGLES, chunk->indexCount, GL_UNSIGNED_INT, 0);
+
+        // Directions are stored back to back, so adjacent visible ranges
+        // go out as one draw.
+        const FaceRanges& ranges = chunk->faceRanges;
+        const uint32_t visible = visibleFaceMask(fp.eyePos, chunkMin, chunkMax);
+        int dir = 0;
+        while (dir < 6)
+        {
+            if (!(visible & (1u << dir)))
+            {
+                solidQuadsBackfaceCulled += ranges.quadCount(dir);
+                dir++;
+                continue;
+            }
+            int end = dir + 1;
+            while (end < 6 && (visible & (1u << end)))
+                end++;
+            const uint32_t firstQuad = ranges.start[dir];
+            const uint32_t quadCount = ranges.start[end] - firstQuad;
+            if (quadCount > 0)
+            {
+                glDrawElements(GL_TRIANGLES, quadIndexCount(quadCount * 4), GL_UNSIGNED_INT,
+                               (void *)(static_cast<size_t>(quadIndexCount(firstQuad * 4)) * sizeof(uint32_t)));
+                solidQuadsDrawn += quadCount;
+            }
+            dir = end;
+        }
+        lodChunksDrawn[chunk->meshLod]++;
         frustumSolidDrawn++;
     }
 }
 
+void Renderer::renderHorizon(const FrameParams& fp, HorizonRing& horizon)
+{
+    if (!enableHorizon)
+        return;
+
+    horizonShader->Activate();
+    glUniform1f(horizonTimeOfDayLoc, fp.sunBrightness);
+    glUniform1f(horizonAmbientLightLoc, fp.ambientLight);
+    glUniform3fv(horizonCameraPosLoc, 1, glm::value_ptr(fp.eyePos));
+    glUniform3fv(horizonFogColorLoc, 1, glm::value_ptr(fp.fogCol));
+    glUniform1f(horizonFogDensityLoc, fp.effectiveFogDensity);
+    glUniform4fv(horizonStreamedBoundsLoc, 1, glm::value_ptr(horizon.streamedBounds()));
+
+    const glm::mat4 viewProj = fp.proj * fp.view;
+    const Frustum frustum = Frustum::fromMatrix(viewProj);
+    const float tileSizeF = static_cast<float>(HORIZON_TILE_SIZE);
+
+    horizon.forEachReadyTile([&](int tileX, int tileZ, const HorizonRing::Tile& tile)
+    {
+        const glm::vec3 tileMin(tileX * tileSizeF, 0.0f, tileZ * tileSizeF);
+        const glm::vec3 tileMax = tileMin + glm::vec3(tileSizeF, 256.0f, tileSizeF);
+        if (!frustum.intersectsAABB(tileMin, tileMax))
+            return;
+
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), tileMin);
+        glm::mat4 mvp = viewProj * model;
+        glUniformMatrix4fv(horizonTransformLoc, 1, GL_FALSE, glm::value_ptr(mvp));
+        glUniformMatrix4fv(horizonModelLoc, 1, GL_FALSE, glm::value_ptr(model));
+
+        glBindVertexArray(tile.vao);
+        glDrawElements(GL_TRIANGLES, horizon.indexCount(), GL_UNSIGNED_SHORT, 0);
+        horizonTilesDrawn++;
+    });
+}
+
 void Renderer::renderWater(const FrameParams& fp, ChunkManager& cm)
 {
     glEnable(GL_BLEND);
@@ -385,10 +543,10 @@ void Renderer::renderWater(const FrameParams& fp, ChunkManager& cm)
     const Frustum frustum = Frustum::fromMatrix(viewProj);
     const float chunkSizeF = static_cast<float>(CHUNK_SIZE);
 
-    for (auto& pair : cm.chunks)
+    for (auto& slot : cm.entries)
     {
-        Chunk* chunk = pair.second.get();
-        if (chunk->waterIndexCount == 0)
+        Chunk* chunk = slot.value.chunk.get();
+        if (!chunk || chunk->waterIndexCount == 0)
             continue;
         frustumWaterTested++;
 
@@ -410,6 +568,7 @@ void Renderer::renderWater(const FrameParams& fp, ChunkManager& cm)
 
         glUniformMatrix4fv(waterTransformLoc, 1, GL_FALSE, glm::value_ptr(chunkMVP));
         glUniformMatrix4fv(waterModelLoc, 1, GL_FALSE, glm::value_ptr(chunkModel));
+        bindLightVolume(*chunk, cm, waterUseLightVolumeLoc);
 
         glBindVertexArray(chunk->waterVao);
         glDrawElements(GL_TRIANGLES, chunk->waterIndexCount, GL_UNSIGNED_INT, 0);
@@ -491,7 +650,7 @@ void Renderer::renderDestroyOverlay(const FrameParams& fp, const Player& player,
             glm::ivec3 local = worldToLocal(player.breakingBlockPos.x,
                                              player.breakingBlockPos.y,
                                              player.breakingBlockPos.z);
-            skyLightVal = static_cast<float>(c->skyLight[blockIndex(local.x, local.y, local.z)])
+            skyLightVal = static_cast<float>(c->skyLight.get(blockIndex(local.x, local.y, local.z)))
                         / static_cast<float>(MAX_SKY_LIGHT);
         }
     }
@@ -8,6 +8,7 @@
 #include "../rendering/ParticleSystem.h"
 #include "../gameplay/Player.h"
 #include "../world/ChunkManager.h"
+#include "../rendering/HorizonRing.h"
 #include "../gameplay/Raycast.h"
 
 struct FrameParams
@@ -30,7 +31,7 @@ struct Renderer
     std::unique_ptr<Shader> shaderProgram;
     GLint transformLoc = 0, modelLoc = 0, timeOfDayLoc = 0;
     GLint cameraPosLoc = 0, skyColorLoc = 0, fogColorLoc = 0;
-    GLint fogDensityLoc = 0, ambientLightLoc = 0;
+    GLint fogDensityLoc = 0, ambientLightLoc = 0, useLightVolumeLoc = 0;
 
     unsigned int textureArray = 0;
 
@@ -53,7 +54,13 @@ struct Renderer
     GLint waterTimeOfDayLoc = 0, waterCameraPosLoc = 0;
     GLint waterSkyColorLoc = 0, waterFogColorLoc = 0;
     GLint waterFogDensityLoc = 0, waterAmbientLightLoc = 0;
-    GLint waterEnableCausticsLoc = 0;
+    GLint waterEnableCausticsLoc = 0, waterUseLightVolumeLoc = 0;
+
+    std::unique_ptr<Shader> horizonShader;
+    GLint horizonTransformLoc = 0, horizonModelLoc = 0, horizonTimeOfDayLoc = 0;
+    GLint horizonAmbientLightLoc = 0, horizonCameraPosLoc = 0;
+    GLint horizonFogColorLoc = 0, horizonFogDensityLoc = 0;
+    GLint horizonStreamedBoundsLoc = 0;
 
     GLuint destroyTextures[10] = {};
 
@@ -66,6 +73,7 @@ struct Renderer
     void beginFrame(const FrameParams& fp);
     void renderChunks(const FrameParams& fp, ChunkManager& cm);
     void renderWater(const FrameParams& fp, ChunkManager& cm);
+    void renderHorizon(const FrameParams& fp, HorizonRing& horizon);
     void renderParticles(ParticleSystem& ps, const FrameParams& fp);
     void renderSelectionBox(const FrameParams& fp, const std::optional<RaycastHit>& sel);
     void renderDestroyOverlay(const FrameParams& fp, const Player& player,
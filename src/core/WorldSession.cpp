@@ -5,6 +5,7 @@
 #include "../world/WaterSimulator.h"
 #include "../world/TerrainGenerator.h"
 #include "../utils/JobSystem.h"
+#include "../rendering/HorizonRing.h"
 #include "../gameplay/Player.h"
 #include "../rendering/ToolModelGenerator.h"
 #include <filesystem>
@@ -51,6 +52,9 @@ void WorldSession::init(const std::string& worldName, int requestedGamemode,
     waterSimulator = std::make_unique<WaterSimulator>();
     waterSimulator->setChunkManager(chunkManager.get());
 
+    horizon = std::make_unique<HorizonRing>();
+    horizon->setJobSystem(jobSystem.get());
+
     g_chunkManager = chunkManager.get();
     g_waterSimulator = waterSimulator.get();
 
@@ -128,28 +132,34 @@ void WorldSession::shutdown(Player& player, GLFWwindow* window)
     playerToSave.gamemode = static_cast<int32_t>(player.gamemode);
     regionManager->savePlayerData(playerToSave);
 
-    for (auto& pair : chunkManager->chunks)
+    BlockID blocks[CHUNK_VOLUME];
+    SectionLight light;
+    chunkManager->forEachChunk([&](Chunk* chunk)
     {
-        Chunk* chunk = pair.second.get();
-        if (!chunk->dirtyData)
-            continue;
+        if (!chunkManager->needsSave(chunk))
+            return;
+        chunk->blocks.copyTo(blocks);
+        bool withLight = chunkManager->collectLightForSave(chunk, light);
         regionManager->saveChunkData(
-            chunk->position.x, chunk->position.y, chunk->position.z, chunk->blocks);
-    }
+            chunk->position.x, chunk->position.y, chunk->position.z, blocks, withLight ? &light : nullptr);
+    });
     regionManager->flush();
 
     player.inventory.heldItem.clear();
     player.inventory.saveToFile("saves/" + currentWorldName + "/inventory.dat");
     inventoryOpen = false;
 
-    chunkManager->chunks.clear();
+    chunkManager->clear();
+    horizon.reset();
 
     g_chunkManager = nullptr;
     g_waterSimulator = nullptr;
 
+    // Unfinished generate jobs still hold pooled chunks, so the job system
+    // has to go before the chunk manager that owns the pool.
     waterSimulator.reset();
-    chunkManager.reset();
     jobSystem.reset();
+    chunkManager.reset();
     regionManager.reset();
 
     selectedBlock.reset();
@@ -11,6 +11,7 @@ class RegionManager;
 struct ChunkManager;
 class JobSystem;
 class WaterSimulator;
+class HorizonRing;
 struct Player;
 
 class WorldSession
@@ -20,6 +21,7 @@ public:
     std::unique_ptr<ChunkManager> chunkManager;
     std::unique_ptr<JobSystem> jobSystem;
     std::unique_ptr<WaterSimulator> waterSimulator;
+    std::unique_ptr<HorizonRing> horizon;
     std::optional<RaycastHit> selectedBlock;
 
     bool active() const { return jobSystem != nullptr; }
@@ -48,6 +48,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 #include <thread>
@@ -143,8 +144,11 @@ int main(int argc, char* argv[])
     auto& waterSimulator = session.waterSimulator;
     auto& regionManager  = session.regionManager;
     auto& selectedBlock  = session.selectedBlock;
+    auto& horizon        = session.horizon;
     std::vector<glm::ivec2> loadOffsets;
     int cachedLoadRadius = -1;
+    // (cx, cz, unload radius) of the last unload pass.
+    glm::ivec3 lastUnloadScan(std::numeric_limits<int>::min());
 
     while (!glfwWindowShouldClose(window))
     {
@@ -342,7 +346,14 @@ int main(int argc, char* argv[])
           if (player.isDead)
           {
             if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
-              respawnPlayer(player, respawnPos);
+            {
+              // Stand on the surface if the spawn column is loaded.
+              glm::vec3 spawn = respawnPos;
+              int surface = chunkManager->surfaceHeight(static_cast<int>(floor(spawn.x)), static_cast<int>(floor(spawn.z)));
+              if (surface > 0)
+                spawn.y = static_cast<float>(surface);
+              respawnPlayer(player, spawn);
+            }
           }
 
           if (enableWaterSimulation)
@@ -437,7 +448,9 @@ int main(int argc, char* argv[])
             glm::vec3(0.0f, 1.0f, 0.0f));
 
         float aspect = static_cast<float>(fbWidth) / static_cast<float>(fbHeight);
-        glm::mat4 proj = glm::perspective(glm::radians(fov), aspect, 0.1f, 1000.f);
+        // Far enough for the horizon's far corners.
+        float farPlane = std::max(1000.0f, horizonDistance * CHUNK_SIZE * 1.5f);
+        glm::mat4 proj = glm::perspective(glm::radians(fov), aspect, 0.1f, farPlane);
 
         FrameParams fp{};
         fp.view = view;
@@ -524,9 +537,15 @@ int main(int argc, char* argv[])
               });
           cachedLoadRadius = LOAD_RADIUS;
         }
+        chunkManager->setViewCenter(cx, cz, UNLOAD_RADIUS, CHUNK_HEIGHT_MIN, CHUNK_HEIGHT_MAX);
+        if (enableHorizon)
+          horizon->update(cx, cz, LOAD_RADIUS, std::max(horizonDistance, LOAD_RADIUS + HORIZON_TILE_CHUNKS));
         size_t pendingJobs = jobSystem ? jobSystem->pendingJobCount() : 0;
         int maxLoadEnqueuePerFrame = 32;
         int maxMeshEnqueuePerFrame = 16;
+        // How long a dirty chunk waits on unsettled neighbours before it is
+        // meshed regardless.
+        constexpr uint16_t MESH_NEIGHBOR_TIMEOUT_FRAMES = 60;
         if (pendingJobs > 200)
         {
           maxLoadEnqueuePerFrame = 4;
@@ -561,9 +580,7 @@ int main(int argc, char* argv[])
             {
               if (useAsyncLoading && enqueuedLoads >= maxLoadEnqueuePerFrame)
                 break;
-              if (!chunkManager->hasChunk(chunkX, cy, chunkZ) &&
-                  !chunkManager->isLoading(chunkX, cy, chunkZ) &&
-                  !chunkManager->isSaving(chunkX, cy, chunkZ))
+              if (chunkManager->stateOf(chunkX, cy, chunkZ) == ChunkState::Absent)
               {
                 if (useAsyncLoading)
                 {
@@ -576,75 +593,75 @@ int main(int argc, char* argv[])
             }
           }
 
-          std::vector<ChunkManager::ChunkCoord> toUnload;
-          for (auto& pair : chunkManager->chunks)
+          // Chunks only leave the unload square when it moves or shrinks;
+          // ones that finish loading outside it are dropped on arrival.
+          const glm::ivec3 unloadScan(cx, cz, UNLOAD_RADIUS);
+          if (unloadScan != lastUnloadScan)
           {
-            Chunk* chunk = pair.second.get();
-            int distX = chunk->position.x - cx;
-            int distZ = chunk->position.z - cz;
-            if (std::abs(distX) > UNLOAD_RADIUS || std::abs(distZ) > UNLOAD_RADIUS)
+            lastUnloadScan = unloadScan;
+            std::vector<ChunkManager::ChunkCoord> toUnload;
+            chunkManager->forEachChunk([&](Chunk* chunk)
+            {
+              int distX = chunk->position.x - cx;
+              int distZ = chunk->position.z - cz;
+              if (std::abs(distX) > UNLOAD_RADIUS || std::abs(distZ) > UNLOAD_RADIUS)
+                toUnload.push_back(chunk->position);
+            });
+            for (const auto& coord : toUnload)
             {
-              if (!chunkManager->isSaving(chunk->position.x, chunk->position.y, chunk->position.z))
-                toUnload.push_back({chunk->position.x, chunk->position.y, chunk->position.z});
+              if (useAsyncLoading)
+                chunkManager->enqueueSaveAndUnload(coord.x, coord.y, coord.z);
+              else
+                chunkManager->unloadChunk(coord.x, coord.y, coord.z);
             }
           }
-          for (const auto& coord : toUnload)
-          {
-            if (useAsyncLoading)
-              chunkManager->enqueueSaveAndUnload(coord.x, coord.y, coord.z);
-            else
-              chunkManager->unloadChunk(coord.x, coord.y, coord.z);
-          }
         }
 
-        std::vector<std::pair<int, Chunk*>> meshCandidates;
-        meshCandidates.reserve(chunkManager->chunks.size());
-        for (auto& pair : chunkManager->chunks)
+        // Only chunks that were marked dirty are visited, nearest ring first.
+        chunkManager->setMeshCenter(cx, cz);
+        int enqueuedMeshes = 0;
+        chunkManager->visitMeshQueue([&](Chunk* chunk)
         {
-          Chunk* chunk = pair.second.get();
-          if (chunk->dirtyMesh && !chunkManager->isMeshing(chunk->position.x, chunk->position.y, chunk->position.z))
+          if (useAsyncLoading && enqueuedMeshes >= maxMeshEnqueuePerFrame)
+            return MeshQueueStep::Stop;
+          // In-flight chunks are requeued on completion if still dirty.
+          ChunkState state = chunkManager->stateOf(chunk->position.x, chunk->position.y, chunk->position.z);
+          if ((!chunk->dirtyMesh && !chunk->dirtyLight) || state != ChunkState::Resident || chunk->lightJobPending)
+            return MeshQueueStep::Remove;
+
+          // Light runs as its own job ahead of the mesh, column by column
+          // from the top. The synchronous path lights inside buildChunkMesh.
+          if (useAsyncLoading && chunk->dirtyLight)
           {
-            bool neighborsReady = true;
-            for (int i = 0; i < 6; i++)
-            {
-              int nx = chunk->position.x + DIRS[i].x;
-              int ny = chunk->position.y + DIRS[i].y;
-              int nz = chunk->position.z + DIRS[i].z;
-              if (ny >= CHUNK_HEIGHT_MIN && ny <= CHUNK_HEIGHT_MAX)
-              {
-                if (!chunkManager->hasChunk(nx, ny, nz))
-                {
-                  if (chunkManager->isLoading(nx, ny, nz))
-                  {
-                    neighborsReady = false;
-                    break;
-                  }
-                }
-              }
-            }
-
-            if (neighborsReady)
+            if (!chunkManager->aboveLit(chunk, cx, cz, LOAD_RADIUS, CHUNK_HEIGHT_MIN, CHUNK_HEIGHT_MAX))
+              return MeshQueueStep::Keep;
+            if (chunkManager->enqueueLightChunk(chunk))
+              enqueuedMeshes++;
+            return MeshQueueStep::Remove;
+          }
+          if (!useAsyncLoading && chunk->dirtyLight && !chunk->dirtyMesh)
+          {
+            // Sections without a mesh are still lit for their neighbours.
+            if (chunk->isPlaceholder())
             {
-              int dx = chunk->position.x - cx;
-              int dz = chunk->position.z - cz;
-              int dist2 = dx * dx + dz * dz;
-              meshCandidates.push_back({dist2, chunk});
+              calculateSkyLight(*chunk, *chunkManager);
+              return MeshQueueStep::Remove;
             }
+            chunk->markMeshDirty();
           }
-        }
-        std::sort(meshCandidates.begin(), meshCandidates.end(),
-            [](const std::pair<int, Chunk*>& a, const std::pair<int, Chunk*>& b)
-            {
-              return a.first < b.first;
-            });
-        int enqueuedMeshes = 0;
-        for (const auto& candidate : meshCandidates)
-        {
-          Chunk* chunk = candidate.second;
+          if (!chunk->dirtyMesh || !chunkManager->needsMesh(chunk))
+            return MeshQueueStep::Remove;
+
+          // Wait for neighbours that are still to stream in, so the chunk
+          // isn't meshed with open borders and then again when they land.
+          bool neighborsReady = chunkManager->neighborsSettled(
+              chunk, cx, cz, LOAD_RADIUS, CHUNK_HEIGHT_MIN, CHUNK_HEIGHT_MAX) &&
+              (!useAsyncLoading || chunkManager->neighborsLit(chunk));
+          if (!neighborsReady && ++chunk->meshWaitFrames < MESH_NEIGHBOR_TIMEOUT_FRAMES)
+            return MeshQueueStep::Keep;
+
           if (useAsyncLoading)
           {
-            if (enqueuedMeshes >= maxMeshEnqueuePerFrame)
-              break;
             chunkManager->enqueueMeshChunk(chunk->position.x, chunk->position.y, chunk->position.z);
             enqueuedMeshes++;
           }
@@ -653,9 +670,12 @@ int main(int argc, char* argv[])
             buildChunkMesh(*chunk, *chunkManager);
             chunk->dirtyMesh = false;
           }
-        }
+          chunk->meshWaitFrames = 0;
+          return MeshQueueStep::Remove;
+        });
 
         renderer.renderChunks(fp, *chunkManager);
+        renderer.renderHorizon(fp, *horizon);
         renderer.renderWater(fp, *chunkManager);
         renderer.renderParticles(particleSystem, fp);
 
@@ -704,7 +724,7 @@ int main(int argc, char* argv[])
                       if (c)
                       {
                         glm::ivec3 local = worldToLocal(hit->blockPos.x, hit->blockPos.y, hit->blockPos.z);
-                        skyLightVal = static_cast<float>(c->skyLight[blockIndex(local.x, local.y, local.z)]) / static_cast<float>(MAX_SKY_LIGHT);
+                        skyLightVal = static_cast<float>(c->skyLight.get(blockIndex(local.x, local.y, local.z))) / static_cast<float>(MAX_SKY_LIGHT);
                       }
                     }
                     glm::vec4 particleTint(1.0f);
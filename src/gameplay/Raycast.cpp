@@ -13,7 +13,7 @@ uint8_t getBlockAtWorld(int wx, int wy, int wz, ChunkManager& chunkManager)
     return 0;
 
   glm::ivec3 local = worldToLocal(wx, wy, wz);
-  return c->blocks[blockIndex(local.x, local.y, local.z)];
+  return c->getBlock(local.x, local.y, local.z);
 }
 
 void setBlockAtWorld(int wx, int wy, int wz, uint8_t blockId, ChunkManager& chunkManager)
@@ -24,10 +24,18 @@ void setBlockAtWorld(int wx, int wy, int wz, uint8_t blockId, ChunkManager& chun
     return;
 
   glm::ivec3 local = worldToLocal(wx, wy, wz);
-  c->blocks[blockIndex(local.x, local.y, local.z)] = blockId;
-  c->dirtyMesh = true;
-  c->dirtyLight = true;
+  chunkManager.tallySection(c, -1);
+  c->setBlock(local.x, local.y, local.z, blockId);
+  chunkManager.tallySection(c, 1);
+  if (ChunkColumn* column = chunkManager.getColumn(chunk.x, chunk.z))
+    column->blockChanged(local.x, wy, local.z);
+  c->markBlockDirty(local.x, local.y, local.z);
+  chunkManager.queueMesh(c);
   c->dirtyData = true;
+  // Unlit chunks get the edit with their first light.
+  const bool relit = chunkManager.updateLightAt(wx, wy, wz);
+  if (!relit)
+    c->dirtyLight = true;
 
   for (int i = 0; i < 6; i++)
   {
@@ -41,8 +49,11 @@ void setBlockAtWorld(int wx, int wy, int wz, uint8_t blockId, ChunkManager& chun
       Chunk* neighbor = chunkManager.getChunk(neighborChunk.x, neighborChunk.y, neighborChunk.z);
       if (neighbor)
       {
-        neighbor->dirtyMesh = true;
-        neighbor->dirtyLight = true;
+        glm::ivec3 wrapped = neighborLocal - DIRS[i] * CHUNK_SIZE;
+        neighbor->markBlockDirty(wrapped.x, wrapped.y, wrapped.z);
+        chunkManager.queueMesh(neighbor);
+        if (!relit)
+          neighbor->dirtyLight = true;
       }
     }
   }
@@ -0,0 +1,1101 @@
+#include "GreedyMesher.h"
+#include "../utils/BlockTypes.h"
+#include "../world/Chunk.h"
+#include "../world/TerrainGenerator.h"
+#include "../world/WaterSimulator.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const Vertex FACE_POS_X[4] = { {{1, 0, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_NEG_X[4] = { {{0, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{0, 1, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{0, 0, 0}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_POS_Y[4] = { {{0, 1, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_NEG_Y[4] = { {{0, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 0, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 0, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_POS_Z[4] = { {{1, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{0, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_NEG_Z[4] = { {{0, 0, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 0}, {0, 0}, 0, 1.0f, 1.0f} };
+
+static const Vertex *FACE_TABLE[6] = {
+    FACE_POS_X, FACE_NEG_X,
+    FACE_POS_Y, FACE_NEG_Y,
+    FACE_POS_Z, FACE_NEG_Z
+};
+
+
+static float getFluidHeight(const MeshInput& in, int cornerX, int cornerY, int cornerZ)
+{
+    int count = 0;
+    float totalHeight = 0.0f;
+    bool hasWaterAbove = false;
+    
+    for (int j = 0; j < 4; j++)
+    {
+        int sampleX = cornerX - (j & 1);
+        int sampleZ = cornerZ - ((j >> 1) & 1);
+        
+        BlockID above = in.block(sampleX, cornerY + 1, sampleZ);
+        BlockID block = in.block(sampleX, cornerY, sampleZ);
+        
+        if (isWater(block))
+        {
+            if (isWater(above))
+            {
+                hasWaterAbove = true;
+            }
+            
+            int depth = getRenderedDepth(block);
+            float heightPercent = getLiquidHeightPercent(depth);
+            
+            if (depth >= 8 || depth == 0)
+            {
+                totalHeight += heightPercent * 10.0f;
+                count += 10;
+            }
+            totalHeight += heightPercent;
+            count++;
+        }
+        else if (!isBlockSolid(block))
+        {
+            totalHeight += 1.0f;
+            count++;
+        }
+    }
+    
+    if (hasWaterAbove)
+        return 0.95f;
+    
+    if (count == 0)
+        return 0.5f;
+    
+    float height = 1.0f - totalHeight / static_cast<float>(count);
+    return glm::clamp(height, 0.15f, 0.9f);
+}
+
+static glm::vec3 getFlowDirection(const MeshInput& in, int x, int y, int z)
+{
+    glm::vec3 flow(0.0f);
+    
+    BlockID currentBlock = in.block(x, y, z);
+    if (!isWater(currentBlock))
+        return flow;
+    
+    int currentDepth = getRenderedDepth(currentBlock);
+    
+    static const int dx[] = {1, -1, 0, 0};
+    static const int dz[] = {0, 0, 1, -1};
+    
+    for (int i = 0; i < 4; i++)
+    {
+        int nx = x + dx[i];
+        int nz = z + dz[i];
+        
+        BlockID neighborBlock = in.block(nx, y, nz);
+        int neighborDepth = getRenderedDepth(neighborBlock);
+        
+        if (neighborDepth < 0)
+        {
+            if (!isBlockSolid(neighborBlock))
+            {
+                BlockID belowNeighbor = in.block(nx, y - 1, nz);
+                int belowDepth = getRenderedDepth(belowNeighbor);
+                if (belowDepth >= 0)
+                {
+                    int diff = belowDepth - (currentDepth - 8);
+                    flow.x += static_cast<float>(dx[i] * diff);
+                    flow.z += static_cast<float>(dz[i] * diff);
+                }
+            }
+        }
+        else
+        {
+            int diff = neighborDepth - currentDepth;
+            flow.x += static_cast<float>(dx[i] * diff);
+            flow.z += static_cast<float>(dz[i] * diff);
+        }
+    }
+    
+    float len = glm::length(flow);
+    if (len > 0.0f)
+    {
+        flow = glm::normalize(flow);
+    }
+    
+    return flow;
+}
+
+static float getSlopeAngle(const MeshInput& in, int x, int y, int z)
+{
+    glm::vec3 flow = getFlowDirection(in, x, y, z);
+    if (flow.x == 0.0f && flow.z == 0.0f)
+        return -1000.0f;
+    return std::atan2(flow.z, flow.x) - (3.14159265359f / 2.0f);
+}
+
+struct WaterVertexUV
+{
+    float u0, v0, u1, v1, u2, v2, u3, v3;
+};
+
+static WaterVertexUV calculateWaterUV(float angle)
+{
+    WaterVertexUV uv;
+    
+    if (angle < -999.0f)
+    {
+        uv.u0 = 0.0f; uv.v0 = 0.0f;
+        uv.u1 = 0.0f; uv.v1 = 1.0f;
+        uv.u2 = 1.0f; uv.v2 = 1.0f;
+        uv.u3 = 1.0f; uv.v3 = 0.0f;
+    }
+    else
+    {
+        float sinA = std::sin(angle) * 0.25f;
+        float cosA = std::cos(angle) * 0.25f;
+        
+        uv.u0 = 0.5f + (-cosA - sinA);
+        uv.v0 = 0.5f + (-cosA + sinA);
+        uv.u1 = 0.5f + (-cosA + sinA);
+        uv.v1 = 0.5f + (cosA + sinA);
+        uv.u2 = 0.5f + (cosA + sinA);
+        uv.v2 = 0.5f + (cosA - sinA);
+        uv.u3 = 0.5f + (cosA - sinA);
+        uv.v3 = 0.5f + (-cosA - sinA);
+    }
+    
+    return uv;
+}
+
+enum class MeshPass { Opaque, Liquid };
+
+// Slice layout for one face direction, in FaceDir order. Each slice is
+// perpendicular to axis; u runs along a mask row and v across rows.
+template <int Dir>
+struct FaceAxes
+{
+  static constexpr int axis = Dir / 2;
+  static constexpr int u = (axis + 1) % 3;
+  static constexpr int v = (axis + 2) % 3;
+  static constexpr int normal = (Dir % 2 == 0) ? 1 : -1;
+  static constexpr int axisOffset = normal > 0 ? 1 : 0;
+};
+
+template <MeshPass Pass, int Dir>
+static inline bool isFaceVisible(BlockID current, BlockID neighbor)
+{
+  bool isNeighborLiquid = g_blockTypes[neighbor].isLiquid;
+
+  if constexpr (Pass == MeshPass::Liquid)
+  {
+    // For +Y the neighbour is the block above, so water over water hides
+    // the surface.
+    if constexpr (Dir == DIR_POS_Y)
+      return !isNeighborLiquid && !isWater(neighbor);
+    else
+      return !isNeighborLiquid && !isBlockSolid(neighbor);
+  }
+  else
+  {
+    if (current == 0)
+      return false;
+    if (neighbor == 0 || isNeighborLiquid)
+      return true;
+    // Same-type transparent neighbours never show a face between them,
+    // whether or not the type connects to itself.
+    return isBlockTransparent(neighbor) && current != neighbor;
+  }
+}
+
+static inline int faceTintIndex(BlockID type, int dir, const glm::ivec3& chunkWorldOrigin, int blockX, int blockZ)
+{
+  if (!g_blockTypes[type].faceTint[dir])
+    return TINT_NONE;
+
+  int biome = static_cast<int>(getBiomeAt(chunkWorldOrigin.x + blockX, chunkWorldOrigin.z + blockZ));
+  bool isLeaf = g_blockTypes[type].transparent && g_blockTypes[type].solid;
+  return isLeaf ? foliageTintIndex(biome) : grassTintIndex(biome);
+}
+
+glm::vec3 tintPaletteColor(int index)
+{
+  if (index >= grassTintIndex(0) && index < foliageTintIndex(0))
+    return getBiomeGrassTint(static_cast<BiomeID>(index - grassTintIndex(0)));
+  if (index >= foliageTintIndex(0) && index < TINT_PALETTE_SIZE)
+    return getBiomeFoliageTint(static_cast<BiomeID>(index - foliageTintIndex(0)));
+  return glm::vec3(1.0f);
+}
+
+// Grows a quad from mask cell (j, k) along the row, then row by row, while
+// same(row, column) holds, and clears the covered cells.
+template <typename SameFn>
+static inline void mergeQuad(BlockID (&mask)[CHUNK_SIZE][CHUNK_SIZE], int j, int k, int& w, int& h, SameFn&& same)
+{
+  w = 1;
+  h = 1;
+  while (k + w < CHUNK_SIZE && same(j, k + w))
+    w++;
+
+  bool done = false;
+  while (j + h < CHUNK_SIZE)
+  {
+    for (int dx = 0; dx < w; dx++)
+    {
+      if (!same(j + h, k + dx))
+      {
+        done = true;
+        break;
+      }
+    }
+    if (done) break;
+    h++;
+  }
+
+  for (int dy = 0; dy < h; dy++)
+    for (int dx = 0; dx < w; dx++)
+      mask[j + dy][k + dx] = 0;
+}
+
+// Emits one merged still water surface covering w x h cells of slice i. The
+// UVs span the quad in block units; water.frag wraps them back per block.
+static inline void emitStillWaterQuad(
+    int i, int j, int k, int w, int h,
+    BlockID type, uint8_t light, float height,
+    std::vector<PackedVertex>& outVertices)
+{
+  using F = FaceAxes<DIR_POS_Y>;
+  const Vertex *face = FACE_TABLE[DIR_POS_Y];
+  int tileIndex = g_blockTypes[type].faceTexture[DIR_POS_Y];
+
+  glm::ivec3 extent;
+  extent[F::u] = w;
+  extent[F::v] = h;
+
+  for (int vIdx = 0; vIdx < 4; vIdx++)
+  {
+    const Vertex& corner = face[vIdx];
+    glm::vec3 finalPos;
+    finalPos[F::axis] = static_cast<float>(i) + height - 0.01f;
+    finalPos[F::u] = static_cast<float>(corner.pos[F::u] > 0.5f ? k + w : k);
+    finalPos[F::v] = static_cast<float>(corner.pos[F::v] > 0.5f ? j + h : j);
+
+    // Still water UVs follow x and z (see calculateWaterUV).
+    float localU = corner.pos.x > 0.5f ? static_cast<float>(extent.x) : 0.0f;
+    float localV = corner.pos.z > 0.5f ? static_cast<float>(extent.z) : 0.0f;
+
+    outVertices.push_back(packVertex(finalPos, glm::vec2(localU, localV), tileIndex, light, DIR_POS_Y, TINT_NONE));
+  }
+}
+
+// Emits one merged opaque quad covering w x h cells of slice i, starting at
+// row j, column k.
+template <int Dir>
+static inline void emitOpaqueQuad(
+    int i, int j, int k, int w, int h,
+    BlockID type, uint8_t light,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices)
+{
+  using F = FaceAxes<Dir>;
+  const Vertex *face = FACE_TABLE[Dir];
+
+  glm::ivec3 blockPos;
+  blockPos[F::axis] = i;
+  blockPos[F::u] = k;
+  blockPos[F::v] = j;
+
+  int tileIndex = g_blockTypes[type].faceTexture[Dir];
+  int tint = faceTintIndex(type, Dir, chunkWorldOrigin, blockPos.x, blockPos.z);
+  int rotation = g_blockTypes[type].faceRotation[Dir];
+
+  for (int vIdx = 0; vIdx < 4; vIdx++)
+  {
+    const Vertex& corner = face[vIdx];
+    bool uHigh = corner.uv.x > 0.5f;
+    bool vHigh = corner.uv.y > 0.5f;
+
+    glm::vec3 finalPos;
+    finalPos[F::axis] = static_cast<float>(i + F::axisOffset);
+    finalPos[F::u] = static_cast<float>(uHigh ? k + w : k);
+    finalPos[F::v] = static_cast<float>(vHigh ? j + h : j);
+
+    float localU = uHigh ? static_cast<float>(w) : 0.0f;
+    float localV = vHigh ? static_cast<float>(h) : 0.0f;
+    switch (rotation)
+    {
+      case 1:
+        {
+          float tmp = localU;
+          localU = localV;
+          localV = static_cast<float>(w) - tmp;
+        }
+        break;
+      case 2:
+        localV = static_cast<float>(h) - localV;
+        break;
+      case 3:
+        {
+          float tmp = localU;
+          localU = static_cast<float>(h) - localV;
+          localV = tmp;
+        }
+        break;
+      default:
+        break;
+    }
+
+    outVertices.push_back(packVertex(finalPos, glm::vec2(localU, localV), tileIndex, light, Dir, tint));
+  }
+}
+
+// Each direction is emitted in one run, so its range starts at the quad
+// count reached before it; slices likewise within it. Slices left out of a
+// partial build are marked where the output stood, so they come out empty.
+static inline void markFaceStart(FaceRanges& ranges, int dir, const std::vector<PackedVertex>& outVertices)
+{
+  ranges.start[dir] = static_cast<uint32_t>(outVertices.size() / 4);
+}
+
+static inline void markSliceStart(FaceRanges& ranges, int dir, int slice, const std::vector<PackedVertex>& outVertices)
+{
+  ranges.sliceStart[dir][slice] = static_cast<uint32_t>(outVertices.size() / 4);
+}
+
+// Slices [begin, end) of direction dir to mesh: all of them, or the dirty
+// span along its axis.
+static inline void sliceSpan(const DirtySlices* slices, int dir, int& begin, int& end)
+{
+  begin = 0;
+  end = CHUNK_SIZE;
+  if (slices && !slices->all)
+  {
+    begin = slices->lo[dir / 2];
+    end = std::max<int>(slices->hi[dir / 2] + 1, begin);
+  }
+}
+
+// Emits every face of one pass facing one direction. Instantiated once per
+// (pass, direction) pair so the slice permutation, visibility rules and
+// vertex shaping are all resolved at compile time.
+template <MeshPass Pass, int Dir>
+static void meshDirection(
+    const MeshInput& in,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges,
+    int sliceBegin,
+    int sliceEnd)
+{
+  using F = FaceAxes<Dir>;
+  constexpr bool liquid = Pass == MeshPass::Liquid;
+  const Vertex *face = FACE_TABLE[Dir];
+
+  BlockID mask[CHUNK_SIZE][CHUNK_SIZE];
+  uint8_t lightMask[CHUNK_SIZE][CHUNK_SIZE];
+
+  // Water top faces share corners with their neighbours. Cache the
+  // (CHUNK_SIZE+1)² corner heights of a Y-slice the first time it needs them.
+  float cornerHeightCache[CHUNK_SIZE + 1][CHUNK_SIZE + 1];
+  // Per water top face: its flow angle, and its surface height if the face
+  // is still (no flow, four equal corners) or -1 otherwise. Still faces of
+  // the same type, light and height merge like opaque faces.
+  float slopeMask[CHUNK_SIZE][CHUNK_SIZE];
+  float stillHeightMask[CHUNK_SIZE][CHUNK_SIZE];
+
+  for (int i = 0; i < sliceBegin; i++)
+    markSliceStart(outFaceRanges, Dir, i, outVertices);
+
+  for (int i = sliceBegin; i < sliceEnd; i++)
+  {
+    markSliceStart(outFaceRanges, Dir, i, outVertices);
+    bool cornerCacheValid = false;
+    auto ensureCornerCache = [&]()
+    {
+      if (cornerCacheValid)
+        return;
+      cornerCacheValid = true;
+      for (int cz = 0; cz <= CHUNK_SIZE; ++cz)
+        for (int cx = 0; cx <= CHUNK_SIZE; ++cx)
+          cornerHeightCache[cz][cx] = getFluidHeight(in, cx, i, cz);
+    };
+
+    for (int j = 0; j < CHUNK_SIZE; j++)
+    {
+      for (int k = 0; k < CHUNK_SIZE; k++)
+      {
+        glm::ivec3 pos;
+        pos[F::axis] = i;
+        pos[F::u] = k;
+        pos[F::v] = j;
+
+        BlockID current = in.block(pos.x, pos.y, pos.z);
+        if (g_blockTypes[current].isLiquid != liquid)
+        {
+          mask[j][k] = 0;
+          continue;
+        }
+
+        glm::ivec3 npos = pos;
+        npos[F::axis] += F::normal;
+        BlockID neighbor = in.block(npos.x, npos.y, npos.z);
+
+        bool showFace = isFaceVisible<Pass, Dir>(current, neighbor);
+        mask[j][k] = showFace ? current : 0;
+        lightMask[j][k] = showFace && !in.lightVolume ? in.light(npos.x, npos.y, npos.z) : 0;
+
+        if constexpr (liquid && Dir == DIR_POS_Y)
+        {
+          if (!showFace)
+            continue;
+          ensureCornerCache();
+          float angle = getSlopeAngle(in, pos.x, pos.y, pos.z);
+          float height = cornerHeightCache[pos.z][pos.x];
+          bool still = angle < -999.0f &&
+                       !g_blockTypes[current].faceTint[Dir] &&
+                       cornerHeightCache[pos.z][pos.x + 1] == height &&
+                       cornerHeightCache[pos.z + 1][pos.x] == height &&
+                       cornerHeightCache[pos.z + 1][pos.x + 1] == height;
+          slopeMask[j][k] = angle;
+          stillHeightMask[j][k] = still ? height : -1.0f;
+        }
+      }
+    }
+
+    for (int j = 0; j < CHUNK_SIZE; j++)
+    {
+      for (int k = 0; k < CHUNK_SIZE; k++)
+      {
+        if (mask[j][k] == 0)
+          continue;
+
+        BlockID type = mask[j][k];
+        uint8_t light = lightMask[j][k];
+        if constexpr (!liquid)
+        {
+          int w, h;
+          mergeQuad(mask, j, k, w, h, [&](int row, int col)
+          {
+            return mask[row][col] == type && lightMask[row][col] == light;
+          });
+          emitOpaqueQuad<Dir>(i, j, k, w, h, type, light, chunkWorldOrigin, outVertices);
+        }
+        else
+        {
+          if constexpr (Dir == DIR_POS_Y)
+          {
+            float height = stillHeightMask[j][k];
+            if (height >= 0.0f)
+            {
+              int w, h;
+              mergeQuad(mask, j, k, w, h, [&](int row, int col)
+              {
+                return mask[row][col] == type && lightMask[row][col] == light &&
+                       stillHeightMask[row][col] == height;
+              });
+              emitStillWaterQuad(i, j, k, w, h, type, light, height, outVertices);
+              continue;
+            }
+          }
+
+          // Flowing faces stay one block wide so each can bend to its own
+          // corner heights.
+          glm::ivec3 blockPos;
+          blockPos[F::axis] = i;
+          blockPos[F::u] = k;
+          blockPos[F::v] = j;
+
+          int tileIndex = g_blockTypes[type].faceTexture[Dir];
+          int tint = faceTintIndex(type, Dir, chunkWorldOrigin, blockPos.x, blockPos.z);
+
+          WaterVertexUV waterUV;
+          if constexpr (Dir == DIR_POS_Y)
+            waterUV = calculateWaterUV(slopeMask[j][k]);
+
+          for (int vIdx = 0; vIdx < 4; vIdx++)
+          {
+            const Vertex& corner = face[vIdx];
+            glm::vec3 originalPos = corner.pos;
+            glm::vec3 finalPos(
+                static_cast<float>(blockPos.x) + originalPos.x,
+                static_cast<float>(blockPos.y) + originalPos.y,
+                static_cast<float>(blockPos.z) + originalPos.z);
+            float localU = (corner.uv.x > 0.5f) ? 1.0f : 0.0f;
+            float localV = (corner.uv.y > 0.5f) ? 1.0f : 0.0f;
+
+            if constexpr (Dir == DIR_POS_Y)
+            {
+              int cornerX = blockPos.x + static_cast<int>(originalPos.x);
+              int cornerZ = blockPos.z + static_cast<int>(originalPos.z);
+              float cornerHeight = cornerHeightCache[cornerZ][cornerX];
+              finalPos.y = static_cast<float>(blockPos.y) + cornerHeight - 0.01f;
+
+              switch (vIdx)
+              {
+                case 0: localU = waterUV.u0; localV = waterUV.v0; break;
+                case 1: localU = waterUV.u1; localV = waterUV.v1; break;
+                case 2: localU = waterUV.u2; localV = waterUV.v2; break;
+                case 3: localU = waterUV.u3; localV = waterUV.v3; break;
+              }
+            }
+            else if constexpr (Dir != DIR_NEG_Y)
+            {
+              if (originalPos.y > 0.5f)
+              {
+                int cornerX = blockPos.x + static_cast<int>(originalPos.x);
+                int cornerZ = blockPos.z + static_cast<int>(originalPos.z);
+                float cornerHeight = getFluidHeight(in, cornerX, blockPos.y, cornerZ);
+                finalPos.y = static_cast<float>(blockPos.y) + cornerHeight - 0.01f;
+                localV = cornerHeight;
+              }
+              else
+              {
+                finalPos.y = static_cast<float>(blockPos.y);
+                localV = 0.0f;
+              }
+            }
+
+            outVertices.push_back(packVertex(finalPos, glm::vec2(localU, localV), tileIndex, light, Dir, tint));
+          }
+        }
+      }
+    }
+  }
+
+  for (int i = sliceEnd; i < CHUNK_SIZE; i++)
+    markSliceStart(outFaceRanges, Dir, i, outVertices);
+}
+
+
+static void resetMeshOutput(std::vector<PackedVertex>& outVertices)
+{
+  outVertices.clear();
+  // Reserve a realistic starting size; when vectors are reused from the job
+  // pool their existing capacity is preserved by clear(), so this only
+  // allocates on the very first use of each vector.
+  constexpr size_t MESH_VERT_RESERVE = CHUNK_SIZE * CHUNK_SIZE * 6;  // 1536
+  if (outVertices.capacity() < MESH_VERT_RESERVE)
+      outVertices.reserve(MESH_VERT_RESERVE);
+}
+
+template <MeshPass Pass, int Dir>
+static inline void meshDirectionSpan(
+    const MeshInput& in,
+    const DirtySlices* slices,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges)
+{
+  int begin, end;
+  sliceSpan(slices, Dir, begin, end);
+  markFaceStart(outFaceRanges, Dir, outVertices);
+  meshDirection<Pass, Dir>(in, chunkWorldOrigin, outVertices, outFaceRanges, begin, end);
+}
+
+// slices == nullptr meshes everything.
+template <MeshPass Pass>
+static void buildGreedyMesh(
+    const MeshInput& in,
+    const DirtySlices* slices,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges)
+{
+  resetMeshOutput(outVertices);
+
+  meshDirectionSpan<Pass, DIR_POS_X>(in, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  meshDirectionSpan<Pass, DIR_NEG_X>(in, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  meshDirectionSpan<Pass, DIR_POS_Y>(in, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  meshDirectionSpan<Pass, DIR_NEG_Y>(in, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  meshDirectionSpan<Pass, DIR_POS_Z>(in, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  meshDirectionSpan<Pass, DIR_NEG_Z>(in, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  markFaceStart(outFaceRanges, 6, outVertices);
+}
+
+// ---------------------------------------------------------------------------
+// Bitmask mesher for the opaque pass. Each column along a face axis is one
+// word with a bit per cell, so culling a whole column is a shift and an AND;
+// quads then grow across per-slice row masks with bit scans.
+// ---------------------------------------------------------------------------
+
+static inline int lowestBit(uint32_t v)
+{
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, v);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctz(v);
+#endif
+}
+
+// Bit p + 1 of a column is axis position p, for p in [-1, CHUNK_SIZE], so the
+// apron cells on both ends are included. Indexed [axis][v][u] as in FaceAxes.
+struct BinaryColumns
+{
+  uint32_t solid[3][CHUNK_SIZE][CHUNK_SIZE];       // non-air, non-liquid
+  uint32_t occluder[3][CHUNK_SIZE][CHUNK_SIZE];    // solid and opaque
+  uint32_t seeThrough[3][CHUNK_SIZE][CHUNK_SIZE];  // solid and transparent
+};
+
+// Faces of one slice sharing a block type and light level; a quad may only
+// merge cells with the same key.
+struct FaceRows
+{
+  uint16_t key;
+  uint16_t rows[CHUNK_SIZE];
+};
+
+// Key is type | light << 8; light never exceeds MAX_SKY_LIGHT.
+constexpr int FACE_KEY_COUNT = 256 << 4;
+
+struct BinaryScratch
+{
+  BinaryColumns columns;
+  FaceRows buckets[CHUNK_SIZE * CHUNK_SIZE];
+  int16_t bucketOfKey[FACE_KEY_COUNT];
+};
+
+static void buildBinaryColumns(const MeshInput& in, BinaryColumns& cols)
+{
+  std::memset(&cols, 0, sizeof(cols));
+
+  for (int z = -1; z <= CHUNK_SIZE; z++)
+  {
+    for (int y = -1; y <= CHUNK_SIZE; y++)
+    {
+      for (int x = -1; x <= CHUNK_SIZE; x++)
+      {
+        const BlockType& type = g_blockTypes[in.block(x, y, z)];
+        if (in.block(x, y, z) == 0 || type.isLiquid)
+          continue;
+
+        auto mark = [&](int axis, int p, int u, int v)
+        {
+          if (u < 0 || u >= CHUNK_SIZE || v < 0 || v >= CHUNK_SIZE)
+            return;
+          uint32_t bit = 1u << (p + 1);
+          cols.solid[axis][v][u] |= bit;
+          if (type.transparent)
+            cols.seeThrough[axis][v][u] |= bit;
+          else
+            cols.occluder[axis][v][u] |= bit;
+        };
+        mark(0, x, y, z);
+        mark(1, y, z, x);
+        mark(2, z, x, y);
+      }
+    }
+  }
+}
+
+template <int Dir>
+static void binaryMeshDirection(
+    const MeshInput& in,
+    BinaryScratch& scratch,
+    const DirtySlices* dirty,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges)
+{
+  using F = FaceAxes<Dir>;
+  constexpr uint32_t INTERIOR = ((1u << CHUNK_SIZE) - 1) << 1;
+  const BinaryColumns& cols = scratch.columns;
+
+  uint32_t visible[CHUNK_SIZE][CHUNK_SIZE];
+  uint32_t slices = 0;
+
+  for (int j = 0; j < CHUNK_SIZE; j++)
+  {
+    for (int k = 0; k < CHUNK_SIZE; k++)
+    {
+      uint32_t solid = cols.solid[F::axis][j][k] & INTERIOR;
+      uint32_t occluder = cols.occluder[F::axis][j][k];
+      uint32_t seeThrough = cols.seeThrough[F::axis][j][k];
+      if constexpr (F::normal > 0)
+      {
+        occluder >>= 1;
+        seeThrough >>= 1;
+      }
+      else
+      {
+        occluder <<= 1;
+        seeThrough <<= 1;
+      }
+
+      uint32_t faces = solid & ~occluder;
+
+      // A transparent neighbour only hides a face of its own type.
+      for (uint32_t check = faces & seeThrough; check; check &= check - 1)
+      {
+        int b = lowestBit(check);
+        glm::ivec3 pos;
+        pos[F::axis] = b - 1;
+        pos[F::u] = k;
+        pos[F::v] = j;
+        glm::ivec3 npos = pos;
+        npos[F::axis] += F::normal;
+        if (in.block(pos.x, pos.y, pos.z) == in.block(npos.x, npos.y, npos.z))
+          faces &= ~(1u << b);
+      }
+
+      visible[j][k] = faces;
+      slices |= faces;
+    }
+  }
+
+  int sliceBegin, sliceEnd;
+  sliceSpan(dirty, Dir, sliceBegin, sliceEnd);
+  slices &= ((1u << (sliceEnd - sliceBegin)) - 1) << (sliceBegin + 1);
+
+  markFaceStart(outFaceRanges, Dir, outVertices);
+  int marked = 0;
+  for (; slices; slices &= slices - 1)
+  {
+    int b = lowestBit(slices);
+    int i = b - 1;
+    int bucketCount = 0;
+    while (marked <= i)
+      markSliceStart(outFaceRanges, Dir, marked++, outVertices);
+
+    for (int j = 0; j < CHUNK_SIZE; j++)
+    {
+      for (int k = 0; k < CHUNK_SIZE; k++)
+      {
+        if (!(visible[j][k] & (1u << b)))
+          continue;
+
+        glm::ivec3 pos;
+        pos[F::axis] = i;
+        pos[F::u] = k;
+        pos[F::v] = j;
+        glm::ivec3 npos = pos;
+        npos[F::axis] += F::normal;
+
+        const uint8_t light = in.lightVolume ? 0 : in.light(npos.x, npos.y, npos.z);
+        uint16_t key = static_cast<uint16_t>(in.block(pos.x, pos.y, pos.z) | (light << 8));
+        int16_t& slot = scratch.bucketOfKey[key];
+        if (slot < 0)
+        {
+          slot = static_cast<int16_t>(bucketCount++);
+          FaceRows& bucket = scratch.buckets[slot];
+          bucket.key = key;
+          std::memset(bucket.rows, 0, sizeof(bucket.rows));
+        }
+        scratch.buckets[slot].rows[j] |= static_cast<uint16_t>(1u << k);
+      }
+    }
+
+    for (int s = 0; s < bucketCount; s++)
+    {
+      FaceRows& bucket = scratch.buckets[s];
+      scratch.bucketOfKey[bucket.key] = -1;
+
+      BlockID type = static_cast<BlockID>(bucket.key & 0xff);
+      uint8_t light = static_cast<uint8_t>(bucket.key >> 8);
+
+      for (int j = 0; j < CHUNK_SIZE; j++)
+      {
+        uint32_t row = bucket.rows[j];
+        while (row)
+        {
+          int k = lowestBit(row);
+          int w = lowestBit(~(row >> k));
+          uint32_t run = ((1u << w) - 1) << k;
+          row &= ~run;
+
+          int h = 1;
+          while (j + h < CHUNK_SIZE && (bucket.rows[j + h] & run) == run)
+          {
+            bucket.rows[j + h] &= static_cast<uint16_t>(~run);
+            h++;
+          }
+
+          emitOpaqueQuad<Dir>(i, j, k, w, h, type, light, chunkWorldOrigin, outVertices);
+        }
+      }
+    }
+  }
+
+  while (marked < CHUNK_SIZE)
+    markSliceStart(outFaceRanges, Dir, marked++, outVertices);
+}
+
+static void buildBinaryMesh(
+    const MeshInput& in,
+    const DirtySlices* slices,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges)
+{
+  resetMeshOutput(outVertices);
+
+  // ~25 KB; kept per thread so workers don't each put it on their stacks.
+  thread_local BinaryScratch scratch;
+  thread_local bool scratchReady = false;
+  if (!scratchReady)
+  {
+    std::fill(std::begin(scratch.bucketOfKey), std::end(scratch.bucketOfKey), -1);
+    scratchReady = true;
+  }
+
+  buildBinaryColumns(in, scratch.columns);
+  binaryMeshDirection<DIR_POS_X>(in, scratch, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  binaryMeshDirection<DIR_NEG_X>(in, scratch, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  binaryMeshDirection<DIR_POS_Y>(in, scratch, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  binaryMeshDirection<DIR_NEG_Y>(in, scratch, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  binaryMeshDirection<DIR_POS_Z>(in, scratch, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  binaryMeshDirection<DIR_NEG_Z>(in, scratch, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  markFaceStart(outFaceRanges, 6, outVertices);
+}
+
+// ---------------------------------------------------------------------------
+// Distance LOD. The coarse cells are written back at full resolution, so
+// both opaque kernels mesh them unchanged and merge whole cells into quads.
+// ---------------------------------------------------------------------------
+
+void downsampleMeshInput(const MeshInput& input, int lod, MeshInput& out)
+{
+  const int scale = 1 << lod;
+  const int cellVolume = scale * scale * scale;
+  uint8_t layerCounts[256] = {};
+
+  for (int z0 = 0; z0 < CHUNK_SIZE; z0 += scale)
+  {
+    for (int y0 = 0; y0 < CHUNK_SIZE; y0 += scale)
+    {
+      for (int x0 = 0; x0 < CHUNK_SIZE; x0 += scale)
+      {
+        int solidCount = 0;
+        uint8_t light = 0;
+        BlockID topType = 0;
+        bool topFound = false;
+
+        // Scan top down so the surface block (grass over dirt) wins.
+        for (int y = y0 + scale - 1; y >= y0; y--)
+        {
+          int bestCount = 0;
+          for (int z = z0; z < z0 + scale; z++)
+          {
+            for (int x = x0; x < x0 + scale; x++)
+            {
+              BlockID b = input.block(x, y, z);
+              light = std::max(light, input.light(x, y, z));
+              if (!isBlockSolid(b))
+                continue;
+              solidCount++;
+              if (topFound)
+                continue;
+              int count = ++layerCounts[b];
+              if (count > bestCount)
+              {
+                bestCount = count;
+                topType = b;
+              }
+            }
+          }
+          if (bestCount > 0)
+          {
+            topFound = true;
+            for (int z = z0; z < z0 + scale; z++)
+              for (int x = x0; x < x0 + scale; x++)
+                layerCounts[input.block(x, y, z)] = 0;
+          }
+        }
+
+        bool filled = solidCount * 2 >= cellVolume;
+        if (!filled && y0 == 0 && solidCount > 0)
+        {
+          // Fully solid sections below are placeholders with no mesh, so a
+          // bottom cell resting on majority-solid ground keeps its ground
+          // rather than leaving a hole down to nothing.
+          int bottomSolid = 0, belowSolid = 0;
+          for (int z = z0; z < z0 + scale; z++)
+          {
+            for (int x = x0; x < x0 + scale; x++)
+            {
+              bottomSolid += isBlockSolid(input.block(x, 0, z));
+              belowSolid += isBlockSolid(input.block(x, -1, z));
+            }
+          }
+          filled = bottomSolid * 2 >= scale * scale && belowSolid * 2 >= scale * scale;
+        }
+        for (int z = z0; z < z0 + scale; z++)
+        {
+          for (int y = y0; y < y0 + scale; y++)
+          {
+            for (int x = x0; x < x0 + scale; x++)
+            {
+              int idx = MeshInput::index(x, y, z);
+              BlockID b = input.blocks[idx];
+              out.blocks[idx] = filled ? topType : (isBlockLiquid(b) ? b : 0);
+              out.skyLight[idx] = light;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Apron cells keep liquids, so water surfaces continue across borders,
+  // and take the light of the cell they touch.
+  for (int z = -1; z <= CHUNK_SIZE; z++)
+  {
+    for (int y = -1; y <= CHUNK_SIZE; y++)
+    {
+      for (int x = -1; x <= CHUNK_SIZE; x++)
+      {
+        bool apron = x < 0 || x >= CHUNK_SIZE || y < 0 || y >= CHUNK_SIZE || z < 0 || z >= CHUNK_SIZE;
+        if (!apron)
+          continue;
+        int idx = MeshInput::index(x, y, z);
+        BlockID b = input.blocks[idx];
+        out.blocks[idx] = isBlockLiquid(b) ? b : 0;
+        out.skyLight[idx] = out.light(std::clamp(x, 0, CHUNK_SIZE - 1),
+                                      std::clamp(y, 0, CHUNK_SIZE - 1),
+                                      std::clamp(z, 0, CHUNK_SIZE - 1));
+      }
+    }
+  }
+  out.lightVolume = false;
+}
+
+static std::atomic<OpaqueMesher> g_opaqueMesher{OpaqueMesher::Greedy};
+
+void setOpaqueMesher(OpaqueMesher mesher)
+{
+  g_opaqueMesher.store(mesher, std::memory_order_relaxed);
+}
+
+OpaqueMesher opaqueMesher()
+{
+  return g_opaqueMesher.load(std::memory_order_relaxed);
+}
+
+static std::atomic<MeshLighting> g_meshLighting{MeshLighting::Volume};
+
+void setMeshLighting(MeshLighting lighting)
+{
+  g_meshLighting.store(lighting, std::memory_order_relaxed);
+}
+
+MeshLighting meshLighting()
+{
+  return g_meshLighting.load(std::memory_order_relaxed);
+}
+
+static void buildPasses(
+    const MeshInput& input,
+    const DirtySlices* slices,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges,
+    std::vector<PackedVertex>& outWaterVertices,
+    FaceRanges& outWaterFaceRanges)
+{
+  if (opaqueMesher() == OpaqueMesher::Binary)
+    buildBinaryMesh(input, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+  else
+    buildGreedyMesh<MeshPass::Opaque>(input, slices, chunkWorldOrigin, outVertices, outFaceRanges);
+
+  // Water is blended and seen from both sides, so it is drawn whole; its
+  // ranges only serve slice splicing.
+  buildGreedyMesh<MeshPass::Liquid>(input, slices, chunkWorldOrigin, outWaterVertices, outWaterFaceRanges);
+}
+
+void buildChunkMeshOffThread(
+    const MeshInput& input,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges,
+    std::vector<PackedVertex>& outWaterVertices,
+    FaceRanges& outWaterFaceRanges)
+{
+  buildPasses(input, nullptr, chunkWorldOrigin, outVertices, outFaceRanges,
+              outWaterVertices, outWaterFaceRanges);
+}
+
+void buildChunkMeshSlices(
+    const MeshInput& input,
+    const DirtySlices& slices,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges,
+    std::vector<PackedVertex>& outWaterVertices,
+    FaceRanges& outWaterFaceRanges)
+{
+  buildPasses(input, &slices, chunkWorldOrigin, outVertices, outFaceRanges,
+              outWaterVertices, outWaterFaceRanges);
+}
+
+bool planSliceSplice(
+    const FaceRanges& oldRanges,
+    const FaceRanges& patchRanges,
+    const DirtySlices& slices,
+    FaceRanges& outRanges,
+    std::vector<SpliceRun>& outRuns)
+{
+  outRuns.clear();
+  bool inPlace = true;
+  auto addRun = [&](bool fromPatch, uint32_t src, uint32_t dst, uint32_t count)
+  {
+    if (count == 0)
+      return;
+    if (!fromPatch && src != dst)
+      inPlace = false;
+    if (!outRuns.empty())
+    {
+      SpliceRun& last = outRuns.back();
+      if (last.fromPatch == fromPatch && last.srcQuad + last.quadCount == src &&
+          last.dstQuad + last.quadCount == dst)
+      {
+        last.quadCount += count;
+        return;
+      }
+    }
+    outRuns.push_back({fromPatch, src, dst, count});
+  };
+
+  uint32_t cursor = 0;
+  for (int dir = 0; dir < 6; dir++)
+  {
+    int begin, end;
+    sliceSpan(&slices, dir, begin, end);
+    outRanges.start[dir] = cursor;
+    for (int s = 0; s < CHUNK_SIZE; s++)
+    {
+      const bool patched = s >= begin && s < end;
+      const FaceRanges& from = patched ? patchRanges : oldRanges;
+      const uint32_t src = from.sliceStart[dir][s];
+      const uint32_t count = from.sliceEnd(dir, s) - src;
+      outRanges.sliceStart[dir][s] = cursor;
+      addRun(patched, src, cursor, count);
+      cursor += count;
+    }
+  }
+  outRanges.start[6] = cursor;
+  return inPlace && cursor == oldRanges.start[6];
+}
+
+void buildChunkMeshAtLod(
+    const MeshInput& input,
+    int lod,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges,
+    std::vector<PackedVertex>& outWaterVertices,
+    FaceRanges& outWaterFaceRanges)
+{
+  if (lod <= 0)
+  {
+    buildChunkMeshOffThread(input, chunkWorldOrigin, outVertices, outFaceRanges,
+                            outWaterVertices, outWaterFaceRanges);
+    return;
+  }
+
+  // ~17 KB; per thread for the same reason as BinaryScratch.
+  thread_local MeshInput lodInput;
+  downsampleMeshInput(input, std::min(lod, MESH_LOD_COUNT - 1), lodInput);
+  buildChunkMeshOffThread(lodInput, chunkWorldOrigin, outVertices, outFaceRanges,
+                          outWaterVertices, outWaterFaceRanges);
+}
@@ -0,0 +1,224 @@
+#pragma once
+#include "../world/Chunk.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Unpacked chunk vertex: what the shaders rebuild from a PackedVertex.
+struct Vertex
+{
+  glm::vec3 pos;
+  glm::vec2 uv;
+  float tileIndex;
+  float skyLight;
+  float faceShade;
+  glm::vec3 biomeTint;
+};
+
+enum FaceDir {
+  DIR_POS_X = 0,
+  DIR_NEG_X = 1,
+  DIR_POS_Y = 2,
+  DIR_NEG_Y = 3,
+  DIR_POS_Z = 4,
+  DIR_NEG_Z = 5
+};
+
+constexpr float FACE_SHADE[6] = {
+  0.8f,   // +X (East)
+  0.8f,   // -X (West)
+  1.0f,   // +Y (Top) - full sunlight
+  0.5f,   // -Y (Bottom) - darkest
+  0.6f,   // +Z (South)
+  0.6f    // -Z (North)
+};
+
+// Biome tints are sent as a palette index; 0 means untinted.
+constexpr int BIOME_TINT_COUNT = 4;
+constexpr int TINT_NONE = 0;
+constexpr int TINT_PALETTE_SIZE = 1 + 2 * BIOME_TINT_COUNT;
+
+inline int grassTintIndex(int biome) { return 1 + biome; }
+inline int foliageTintIndex(int biome) { return 1 + BIOME_TINT_COUNT + biome; }
+glm::vec3 tintPaletteColor(int index);
+
+// Chunk vertex as uploaded, two 32-bit words decoded in default.vert and
+// water.vert:
+//   lo: x:5 | y:11 | z:5 | face:3 | skyLight:4 | tint:4
+//   hi: u:10 | v:10 | tileIndex:12
+// x and z are whole chunk-local units. y is in 1/64 steps so water surfaces
+// keep their corner heights, and uv is in 1/32 steps for the rotated flow UVs.
+// Face shade comes from the face direction.
+struct PackedVertex
+{
+  uint32_t lo;
+  uint32_t hi;
+};
+static_assert(sizeof(PackedVertex) == 8, "PackedVertex must stay two words");
+
+constexpr int VERTEX_Y_STEPS = 64;
+constexpr int VERTEX_UV_STEPS = 32;
+
+inline PackedVertex packVertex(const glm::vec3& pos, const glm::vec2& uv, int tileIndex,
+                               uint8_t skyLight, int face, int tint)
+{
+  auto fixed = [](float v, int steps) { return static_cast<uint32_t>(v * steps + 0.5f); };
+  PackedVertex p;
+  p.lo = (fixed(pos.x, 1) & 31u) |
+         ((fixed(pos.y, VERTEX_Y_STEPS) & 2047u) << 5) |
+         ((fixed(pos.z, 1) & 31u) << 16) |
+         ((static_cast<uint32_t>(face) & 7u) << 21) |
+         ((static_cast<uint32_t>(skyLight) & 15u) << 24) |
+         ((static_cast<uint32_t>(tint) & 15u) << 28);
+  p.hi = (fixed(uv.x, VERTEX_UV_STEPS) & 1023u) |
+         ((fixed(uv.y, VERTEX_UV_STEPS) & 1023u) << 10) |
+         ((static_cast<uint32_t>(tileIndex) & 4095u) << 20);
+  return p;
+}
+
+inline int packedFace(PackedVertex p) { return (p.lo >> 21) & 7u; }
+inline uint8_t packedSkyLight(PackedVertex p) { return (p.lo >> 24) & 15u; }
+inline int packedTint(PackedVertex p) { return p.lo >> 28; }
+
+inline Vertex unpackVertex(PackedVertex p)
+{
+  Vertex v;
+  v.pos = glm::vec3(
+      static_cast<float>(p.lo & 31u),
+      static_cast<float>((p.lo >> 5) & 2047u) / VERTEX_Y_STEPS,
+      static_cast<float>((p.lo >> 16) & 31u));
+  v.uv = glm::vec2(
+      static_cast<float>(p.hi & 1023u) / VERTEX_UV_STEPS,
+      static_cast<float>((p.hi >> 10) & 1023u) / VERTEX_UV_STEPS);
+  v.tileIndex = static_cast<float>(p.hi >> 20);
+  v.skyLight = static_cast<float>(packedSkyLight(p)) / static_cast<float>(MAX_SKY_LIGHT);
+  v.faceShade = FACE_SHADE[packedFace(p)];
+  v.biomeTint = tintPaletteColor(packedTint(p));
+  return v;
+}
+
+// A section plus a one-block apron taken from all 26 neighbours, so the
+// mesher can sample any coordinate in [-1, CHUNK_SIZE] without bounds checks
+// or calls back into the world. Missing neighbours read as air in full light.
+constexpr int MESH_INPUT_SIZE = CHUNK_SIZE + 2;
+constexpr int MESH_INPUT_VOLUME = MESH_INPUT_SIZE * MESH_INPUT_SIZE * MESH_INPUT_SIZE;
+
+struct MeshInput
+{
+  BlockID blocks[MESH_INPUT_VOLUME];
+  uint8_t skyLight[MESH_INPUT_VOLUME];
+  // Leave light out of the quads: the renderer reads it per cell from
+  // skyLight uploaded as a light volume, so faces merge across light levels.
+  bool lightVolume = false;
+
+  // Takes section-local coordinates; -1 and CHUNK_SIZE address the apron.
+  static int index(int x, int y, int z)
+  {
+    return (x + 1) + MESH_INPUT_SIZE * ((y + 1) + MESH_INPUT_SIZE * (z + 1));
+  }
+
+  BlockID block(int x, int y, int z) const { return blocks[index(x, y, z)]; }
+  uint8_t light(int x, int y, int z) const { return skyLight[index(x, y, z)]; }
+};
+
+// Distance LOD. Level l meshes a section as (CHUNK_SIZE >> l)^3 cells of
+// 2^l blocks: a cell is filled when at least half its blocks are solid (or,
+// at the bottom of the section, when it rests on solid ground), and takes
+// the most common block of its highest solid layer. Liquids stay at
+// full resolution in unfilled cells. Solid apron blocks become air, so the
+// section closes itself off with walls along its borders; these act as
+// skirts hiding cracks against neighbours meshed at another level.
+constexpr int MESH_LOD_COUNT = 4;
+
+// Downsampled meshes always bake their light.
+void downsampleMeshInput(const MeshInput& input, int lod, MeshInput& out);
+
+// Which kernel meshes the opaque pass. Both emit the same quads, in a
+// different order; Binary culls and merges with per-row bitmasks. Liquids
+// always use the scalar greedy pass. Safe to switch while workers run.
+enum class OpaqueMesher : uint8_t
+{
+  Greedy,
+  Binary
+};
+
+void setOpaqueMesher(OpaqueMesher mesher);
+OpaqueMesher opaqueMesher();
+
+// Where full-detail meshes take their skylight from: baked into each quad,
+// or sampled from the chunk's light volume (see MeshInput::lightVolume).
+// Meshes built in one mode must be rebuilt after switching.
+enum class MeshLighting : uint8_t
+{
+  Baked,
+  Volume
+};
+
+void setMeshLighting(MeshLighting lighting);
+MeshLighting meshLighting();
+
+// Every quad is four consecutive vertices drawn as the triangles below, so
+// meshes carry no index data and share one quad index buffer.
+constexpr uint32_t QUAD_INDEX_PATTERN[6] = {0, 1, 2, 0, 2, 3};
+
+inline uint32_t quadIndexCount(size_t vertexCount)
+{
+  return static_cast<uint32_t>(vertexCount / 4 * 6);
+}
+
+void buildChunkMeshOffThread(
+    const MeshInput& input,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges,
+    std::vector<PackedVertex>& outWaterVertices,
+    FaceRanges& outWaterFaceRanges
+);
+
+// Meshes only the dirty slices of both passes (slices must be partial).
+// Quads come out in the usual order; every slice outside the dirty spans is
+// empty in the output ranges. Each slice holds exactly what a full build
+// would put there, so the result can be spliced into the current mesh.
+void buildChunkMeshSlices(
+    const MeshInput& input,
+    const DirtySlices& slices,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges,
+    std::vector<PackedVertex>& outWaterVertices,
+    FaceRanges& outWaterFaceRanges
+);
+
+// One run of a spliced mesh: quadCount quads taken from the old mesh or the
+// patch at srcQuad, landing at dstQuad.
+struct SpliceRun
+{
+  bool fromPatch;
+  uint32_t srcQuad;
+  uint32_t dstQuad;
+  uint32_t quadCount;
+};
+
+// Lays out the mesh that results from replacing the dirty slices of a mesh
+// with oldRanges by a buildChunkMeshSlices patch. outRuns cover the new mesh
+// in order, adjacent runs merged. Returns true when no old quad moves, so
+// only the patch runs need writing into the existing buffer.
+bool planSliceSplice(
+    const FaceRanges& oldRanges,
+    const FaceRanges& patchRanges,
+    const DirtySlices& slices,
+    FaceRanges& outRanges,
+    std::vector<SpliceRun>& outRuns
+);
+
+// buildChunkMeshOffThread on the input downsampled to lod; lod 0 meshes the
+// input as is.
+void buildChunkMeshAtLod(
+    const MeshInput& input,
+    int lod,
+    const glm::ivec3& chunkWorldOrigin,
+    std::vector<PackedVertex>& outVertices,
+    FaceRanges& outFaceRanges,
+    std::vector<PackedVertex>& outWaterVertices,
+    FaceRanges& outWaterFaceRanges
+);
@@ -0,0 +1,87 @@
+#include "Horizon.h"
+#include "../world/TerrainGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+// Rough average colours of the top textures.
+static const glm::vec3 SAND_COLOR(0.86f, 0.81f, 0.62f);
+static const glm::vec3 SNOW_COLOR(0.93f, 0.95f, 0.97f);
+static const glm::vec3 GRASS_ALBEDO(0.62f);
+static const glm::vec3 WATER_COLOR(0.16f, 0.32f, 0.62f);
+
+// Matches the generator: water fills up to SEA_LEVEL, so its surface sits
+// just under the top of that block.
+constexpr float WATER_SURFACE_OFFSET = 0.9f;
+
+static glm::vec3 surfaceColor(BiomeID biome, int height, int seaLevel)
+{
+  bool beach = biome != BiomeID::Desert && height >= seaLevel - 1 && height <= seaLevel + 1;
+  if (beach || biome == BiomeID::Desert)
+    return SAND_COLOR;
+  if (biome == BiomeID::Tundra)
+    return SNOW_COLOR;
+  return getBiomeGrassTint(biome) * GRASS_ALBEDO;
+}
+
+void buildHorizonTile(int tileX, int tileZ, std::vector<HorizonVertex>& outVertices)
+{
+  // Heights with a one-sample apron for the slope normals.
+  constexpr int SAMPLES = HORIZON_TILE_SIDE + 2;
+  int heights[SAMPLES * SAMPLES];
+  const int baseX = tileX * HORIZON_TILE_SIZE;
+  const int baseZ = tileZ * HORIZON_TILE_SIZE;
+  for (int j = 0; j < SAMPLES; j++)
+    for (int i = 0; i < SAMPLES; i++)
+      heights[j * SAMPLES + i] = getTerrainHeightAt(
+          baseX + (i - 1) * HORIZON_CELL_SIZE, baseZ + (j - 1) * HORIZON_CELL_SIZE);
+  auto height = [&](int i, int j) { return heights[(j + 1) * SAMPLES + (i + 1)]; };
+
+  const int seaLevel = getSeaLevel();
+  outVertices.clear();
+  outVertices.reserve(HORIZON_TILE_VERTICES);
+  for (int j = 0; j < HORIZON_TILE_SIDE; j++)
+  {
+    for (int i = 0; i < HORIZON_TILE_SIDE; i++)
+    {
+      const int h = height(i, j);
+      HorizonVertex v;
+      v.pos = glm::vec3(static_cast<float>(i * HORIZON_CELL_SIZE), 0.0f,
+                        static_cast<float>(j * HORIZON_CELL_SIZE));
+      if (h < seaLevel)
+      {
+        v.pos.y = seaLevel + WATER_SURFACE_OFFSET;
+        v.color = WATER_COLOR;
+      }
+      else
+      {
+        v.pos.y = static_cast<float>(h + 1);
+        glm::vec3 normal = glm::normalize(glm::vec3(
+            static_cast<float>(height(i - 1, j) - height(i + 1, j)),
+            2.0f * HORIZON_CELL_SIZE,
+            static_cast<float>(height(i, j - 1) - height(i, j + 1))));
+        BiomeID biome = getBiomeAt(baseX + i * HORIZON_CELL_SIZE, baseZ + j * HORIZON_CELL_SIZE);
+        v.color = surfaceColor(biome, h, seaLevel) * (0.5f + 0.5f * normal.y);
+      }
+      outVertices.push_back(v);
+    }
+  }
+}
+
+std::vector<uint16_t> horizonTileIndices()
+{
+  std::vector<uint16_t> indices;
+  indices.reserve(HORIZON_TILE_CELLS * HORIZON_TILE_CELLS * 6);
+  for (int j = 0; j < HORIZON_TILE_CELLS; j++)
+  {
+    for (int i = 0; i < HORIZON_TILE_CELLS; i++)
+    {
+      const uint16_t a = static_cast<uint16_t>(j * HORIZON_TILE_SIDE + i);
+      const uint16_t b = static_cast<uint16_t>(a + 1);
+      const uint16_t c = static_cast<uint16_t>(a + HORIZON_TILE_SIDE + 1);
+      const uint16_t d = static_cast<uint16_t>(a + HORIZON_TILE_SIDE);
+      // Counter-clockwise seen from above.
+      indices.insert(indices.end(), {a, d, c, a, c, b});
+    }
+  }
+  return indices;
+}
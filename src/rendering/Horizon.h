@@ -0,0 +1,32 @@
+#pragma once
+#include "../world/Chunk.h"
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Far terrain past the streamed chunks. A horizon tile is a coarse
+// heightfield over HORIZON_TILE_CHUNKS x HORIZON_TILE_CHUNKS chunk columns,
+// sampled from the terrain generator alone: no voxels, chunks or region
+// files are involved, so tiles can be built for any distance.
+constexpr int HORIZON_TILE_CHUNKS = 8;
+constexpr int HORIZON_TILE_CELLS = 16;
+constexpr int HORIZON_TILE_SIZE = HORIZON_TILE_CHUNKS * CHUNK_SIZE;
+constexpr int HORIZON_CELL_SIZE = HORIZON_TILE_SIZE / HORIZON_TILE_CELLS;
+constexpr int HORIZON_TILE_SIDE = HORIZON_TILE_CELLS + 1;
+constexpr int HORIZON_TILE_VERTICES = HORIZON_TILE_SIDE * HORIZON_TILE_SIDE;
+
+struct HorizonVertex
+{
+  glm::vec3 pos;
+  glm::vec3 color;
+};
+
+// Tile (tileX, tileZ) covers world x in [tileX, tileX + 1) * HORIZON_TILE_SIZE,
+// likewise z. Vertex (i, j) sits at tile-local (i, j) * HORIZON_CELL_SIZE and
+// is stored at j * HORIZON_TILE_SIDE + i. Positions are tile-local in x and z
+// and world height in y. Ground below sea level becomes a flat water plane;
+// colours are the biome's surface block with a slope shade baked in.
+void buildHorizonTile(int tileX, int tileZ, std::vector<HorizonVertex>& outVertices);
+
+// Triangle list over the vertex grid, shared by every tile.
+std::vector<uint16_t> horizonTileIndices();
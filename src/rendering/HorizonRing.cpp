@@ -0,0 +1,169 @@
+#include "HorizonRing.h"
+#include "../utils/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Tiles in flight at once, and how busy the job queue may be before the
+// ring stops adding work; chunk streaming always goes first.
+constexpr int MAX_PENDING_TILES = 4;
+constexpr size_t MAX_QUEUED_JOBS = 32;
+
+static int floorDivTile(int chunk)
+{
+  return static_cast<int>(std::floor(static_cast<float>(chunk) / HORIZON_TILE_CHUNKS));
+}
+
+HorizonRing::~HorizonRing()
+{
+  clear();
+}
+
+void HorizonRing::update(int centerCX, int centerCZ, int streamedRadius, int radius)
+{
+  center = glm::ivec2(centerCX, centerCZ);
+  streamed = streamedRadius;
+  if (!jobSystem)
+    return;
+
+  // Results for tiles evicted while in flight are dropped.
+  for (auto& job : jobSystem->pollCompletedHorizonTiles())
+  {
+    pendingTiles--;
+    Tile* tile = tiles.find(packCoordKey(job->cx, 0, job->cz));
+    if (tile && !tile->ready)
+      upload(*tile, job->vertices);
+    jobSystem->releaseHorizonJob(std::move(job));
+  }
+
+  // Chebyshev distance in chunks from the centre to the tile's nearest column.
+  auto tileRing = [&](int tx, int tz)
+  {
+    int minX = tx * HORIZON_TILE_CHUNKS, maxX = minX + HORIZON_TILE_CHUNKS - 1;
+    int minZ = tz * HORIZON_TILE_CHUNKS, maxZ = minZ + HORIZON_TILE_CHUNKS - 1;
+    int dx = std::max({minX - centerCX, centerCX - maxX, 0});
+    int dz = std::max({minZ - centerCZ, centerCZ - maxZ, 0});
+    return std::max(dx, dz);
+  };
+  auto insideStreamed = [&](int tx, int tz)
+  {
+    int minX = tx * HORIZON_TILE_CHUNKS, maxX = minX + HORIZON_TILE_CHUNKS - 1;
+    int minZ = tz * HORIZON_TILE_CHUNKS, maxZ = minZ + HORIZON_TILE_CHUNKS - 1;
+    return minX >= centerCX - streamedRadius && maxX <= centerCX + streamedRadius &&
+           minZ >= centerCZ - streamedRadius && maxZ <= centerCZ + streamedRadius;
+  };
+
+  // One tile of hysteresis on the outside so walking along a tile border
+  // doesn't rebuild the same row over and over.
+  std::vector<uint64_t> evicted;
+  for (auto& slot : tiles)
+  {
+    glm::ivec3 t = unpackCoordKey(slot.key);
+    if (tileRing(t.x, t.z) > radius + HORIZON_TILE_CHUNKS || insideStreamed(t.x, t.z))
+    {
+      release(slot.value);
+      evicted.push_back(slot.key);
+    }
+  }
+  for (uint64_t key : evicted)
+    tiles.erase(key);
+
+  if (pendingTiles >= MAX_PENDING_TILES || jobSystem->pendingJobCount() > MAX_QUEUED_JOBS)
+    return;
+
+  // (tx, tz, ring), nearest first.
+  std::vector<glm::ivec3> wanted;
+  const int minTX = floorDivTile(centerCX - radius), maxTX = floorDivTile(centerCX + radius);
+  const int minTZ = floorDivTile(centerCZ - radius), maxTZ = floorDivTile(centerCZ + radius);
+  for (int tz = minTZ; tz <= maxTZ; tz++)
+  {
+    for (int tx = minTX; tx <= maxTX; tx++)
+    {
+      if (insideStreamed(tx, tz) || tiles.find(packCoordKey(tx, 0, tz)))
+        continue;
+      int ring = tileRing(tx, tz);
+      if (ring <= radius)
+        wanted.push_back({tx, tz, ring});
+    }
+  }
+  std::sort(wanted.begin(), wanted.end(),
+      [](const glm::ivec3& a, const glm::ivec3& b) { return a.z < b.z; });
+
+  for (const glm::ivec3& t : wanted)
+  {
+    if (pendingTiles >= MAX_PENDING_TILES)
+      break;
+    tiles.emplace(packCoordKey(t.x, 0, t.y));
+    auto job = jobSystem->acquireHorizonJob();
+    job->cx = t.x;
+    job->cy = 0;
+    job->cz = t.y;
+    jobSystem->enqueue(std::move(job));
+    pendingTiles++;
+  }
+}
+
+void HorizonRing::clear()
+{
+  for (auto& slot : tiles)
+    release(slot.value);
+  tiles.clear();
+  if (ebo != 0)
+  {
+    glDeleteBuffers(1, &ebo);
+    ebo = 0;
+  }
+  // In-flight results are dropped by the next update, or go with the job system.
+  pendingTiles = 0;
+}
+
+glm::vec4 HorizonRing::streamedBounds() const
+{
+  return glm::vec4(
+      static_cast<float>((center.x - streamed) * CHUNK_SIZE),
+      static_cast<float>((center.y - streamed) * CHUNK_SIZE),
+      static_cast<float>((center.x + streamed + 1) * CHUNK_SIZE),
+      static_cast<float>((center.y + streamed + 1) * CHUNK_SIZE));
+}
+
+void HorizonRing::upload(Tile& tile, const std::vector<HorizonVertex>& verts)
+{
+  if (ebo == 0)
+  {
+    // Unbind first: the element binding is VAO state.
+    std::vector<uint16_t> indices = horizonTileIndices();
+    glBindVertexArray(0);
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t),
+                 indices.data(), GL_STATIC_DRAW);
+  }
+
+  glGenVertexArrays(1, &tile.vao);
+  glGenBuffers(1, &tile.vbo);
+  glBindVertexArray(tile.vao);
+
+  glBindBuffer(GL_ARRAY_BUFFER, tile.vbo);
+  glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(HorizonVertex), verts.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(HorizonVertex),
+                        (void *)offsetof(HorizonVertex, pos));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(HorizonVertex),
+                        (void *)offsetof(HorizonVertex, color));
+  glEnableVertexAttribArray(1);
+
+  glBindVertexArray(0);
+  tile.ready = true;
+}
+
+void HorizonRing::release(Tile& tile)
+{
+  if (tile.vao != 0)
+    glDeleteVertexArrays(1, &tile.vao);
+  if (tile.vbo != 0)
+    glDeleteBuffers(1, &tile.vbo);
+  tile = Tile{};
+}
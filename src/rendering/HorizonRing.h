@@ -0,0 +1,61 @@
+#pragma once
+#include "Horizon.h"
+#include "../utils/PackedKeyTable.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class JobSystem;
+
+// Streams horizon tiles around the player, out to a radius in chunks.
+// Tiles are built on the job system and uploaded here on the main thread;
+// the ring never reads ChunkManager or RegionManager, so it can run far
+// ahead of chunk streaming. Tiles wholly inside the streamed square are not
+// kept, and the renderer clips the rest against it.
+class HorizonRing
+{
+public:
+  struct Tile
+  {
+    bool ready = false;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+  };
+
+  ~HorizonRing();
+
+  void setJobSystem(JobSystem* js) { jobSystem = js; }
+
+  // centerCX/CZ is the player's chunk, streamedRadius the half-size of the
+  // loaded chunk square and radius how far out tiles are wanted.
+  void update(int centerCX, int centerCZ, int streamedRadius, int radius);
+  void clear();
+
+  // World-space xz bounds of the streamed square: (minX, minZ, maxX, maxZ).
+  glm::vec4 streamedBounds() const;
+
+  GLsizei indexCount() const { return HORIZON_TILE_CELLS * HORIZON_TILE_CELLS * 6; }
+  size_t tileCount() const { return tiles.size(); }
+
+  template <typename Fn>
+  void forEachReadyTile(Fn&& fn)
+  {
+    for (auto& slot : tiles)
+    {
+      if (!slot.value.ready)
+        continue;
+      glm::ivec3 t = unpackCoordKey(slot.key);
+      fn(t.x, t.z, slot.value);
+    }
+  }
+
+private:
+  PackedKeyTable<Tile> tiles;
+  JobSystem* jobSystem = nullptr;
+  GLuint ebo = 0;
+  int pendingTiles = 0;
+  glm::ivec2 center{0};
+  int streamed = 0;
+
+  void upload(Tile& tile, const std::vector<HorizonVertex>& verts);
+  static void release(Tile& tile);
+};
@@ -1,499 +1,186 @@
 #include "Meshing.h"
 #include "../utils/BlockTypes.h"
 #include "../world/ChunkManager.h"
+#include "../world/SkyLight.h"
 #include "../world/TerrainGenerator.h"
 #include "../world/WaterSimulator.h"
 #include <glad/glad.h>
+#include <algorithm>
 #include <cstddef>
-#include <queue>
+#include <cstring>
 #include <cmath>
 
-static const Vertex FACE_POS_X[4] = { {{1, 0, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
-static const Vertex FACE_NEG_X[4] = { {{0, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{0, 1, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{0, 0, 0}, {0, 0}, 0, 1.0f, 1.0f} };
-static const Vertex FACE_POS_Y[4] = { {{0, 1, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {0, 0}, 0, 1.0f, 1.0f} };
-static const Vertex FACE_NEG_Y[4] = { {{0, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 0, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 0, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
-static const Vertex FACE_POS_Z[4] = { {{1, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{0, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
-static const Vertex FACE_NEG_Z[4] = { {{0, 0, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 0}, {0, 0}, 0, 1.0f, 1.0f} };
-
-static const Vertex *FACE_TABLE[6] = {
-    FACE_POS_X, FACE_NEG_X,
-    FACE_POS_Y, FACE_NEG_Y,
-    FACE_POS_Z, FACE_NEG_Z
-};
-
-static const uint32_t FACE_INDICES[6] = {
-    0, 1, 2,
-    0, 2, 3};
-
+void gatherLightNeighbors(LightNeighbors &out, Chunk &c, ChunkManager &chunkManager)
+{
+  for (int i = 0; i < 6; i++)
+  {
+    Chunk *n = chunkManager.getChunk(c.position.x + DIRS[i].x, c.position.y + DIRS[i].y, c.position.z + DIRS[i].z);
+    // Sections that haven't been lit yet still hold full light everywhere.
+    out[i] = n && n->lightReady ? n->snapshot() : nullptr;
+  }
+}
 
-static float getFluidHeight(BlockGetter getBlock, int cornerX, int cornerY, int cornerZ)
+void calculateSkyLight(Chunk &c, ChunkManager &chunkManager)
 {
-    int count = 0;
-    float totalHeight = 0.0f;
-    bool hasWaterAbove = false;
-    
-    for (int j = 0; j < 4; j++)
-    {
-        int sampleX = cornerX - (j & 1);
-        int sampleZ = cornerZ - ((j >> 1) & 1);
-        
-        BlockID above = getBlock(sampleX, cornerY + 1, sampleZ);
-        BlockID block = getBlock(sampleX, cornerY, sampleZ);
-        
-        if (isWater(block))
-        {
-            if (isWater(above))
-            {
-                hasWaterAbove = true;
-            }
-            
-            int depth = getRenderedDepth(block);
-            float heightPercent = getLiquidHeightPercent(depth);
-            
-            if (depth >= 8 || depth == 0)
-            {
-                totalHeight += heightPercent * 10.0f;
-                count += 10;
-            }
-            totalHeight += heightPercent;
-            count++;
-        }
-        else if (!isBlockSolid(block))
-        {
-            totalHeight += 1.0f;
-            count++;
-        }
-    }
-    
-    if (hasWaterAbove)
-        return 0.95f;
-    
-    if (count == 0)
-        return 0.5f;
-    
-    float height = 1.0f - totalHeight / static_cast<float>(count);
-    return glm::clamp(height, 0.15f, 0.9f);
+  LightNeighbors neighbors;
+  gatherLightNeighbors(neighbors, c, chunkManager);
+  const SectionSnapshot *raw[6];
+  for (int i = 0; i < 6; i++)
+    raw[i] = neighbors[i].get();
+
+  uint8_t skyFloor[CHUNK_SIZE * CHUNK_SIZE];
+  ChunkColumn *column = chunkManager.getColumn(c.position.x, c.position.z);
+  if (column)
+    column->skyFloor(c.position.y, skyFloor);
+
+  uint8_t light[CHUNK_VOLUME];
+  computeSkyLight(*c.snapshot(), raw, light, column ? skyFloor : nullptr);
+  c.skyLight.assign(light);
+  c.dirtyLight = false;
+  c.lightReady = true;
+  c.lightUnchecked = 0;
 }
 
-static glm::vec3 getFlowDirection(BlockGetter getBlock, int x, int y, int z)
+void buildChunkMesh(Chunk &c, ChunkManager &chunkManager)
 {
-    glm::vec3 flow(0.0f);
-    
-    BlockID currentBlock = getBlock(x, y, z);
-    if (!isWater(currentBlock))
-        return flow;
-    
-    int currentDepth = getRenderedDepth(currentBlock);
-    
-    static const int dx[] = {1, -1, 0, 0};
-    static const int dz[] = {0, 0, 1, -1};
-    
-    for (int i = 0; i < 4; i++)
-    {
-        int nx = x + dx[i];
-        int nz = z + dz[i];
-        
-        BlockID neighborBlock = getBlock(nx, y, nz);
-        int neighborDepth = getRenderedDepth(neighborBlock);
-        
-        if (neighborDepth < 0)
-        {
-            if (!isBlockSolid(neighborBlock))
-            {
-                BlockID belowNeighbor = getBlock(nx, y - 1, nz);
-                int belowDepth = getRenderedDepth(belowNeighbor);
-                if (belowDepth >= 0)
-                {
-                    int diff = belowDepth - (currentDepth - 8);
-                    flow.x += static_cast<float>(dx[i] * diff);
-                    flow.z += static_cast<float>(dz[i] * diff);
-                }
-            }
-        }
-        else
-        {
-            int diff = neighborDepth - currentDepth;
-            flow.x += static_cast<float>(dx[i] * diff);
-            flow.z += static_cast<float>(dz[i] * diff);
-        }
-    }
-    
-    float len = glm::length(flow);
-    if (len > 0.0f)
+  const bool partial = canRemeshSlices(c);
+  if (c.dirtyLight)
+  {
+    uint8_t before[CHUNK_VOLUME];
+    if (partial)
+      c.skyLight.copyTo(before);
+    calculateSkyLight(c, chunkManager);
+    if (partial)
     {
-        flow = glm::normalize(flow);
+      // Faces read light from the cell in front of them, so every slice
+      // next to a cell whose light changed has to be meshed again too.
+      uint8_t after[CHUNK_VOLUME];
+      c.skyLight.copyTo(after);
+      glm::ivec3 min, max;
+      if (lightChangeBounds(before, after, min, max))
+        c.dirtySlices.markBox(min, max);
     }
-    
-    return flow;
+  }
+
+  MeshSections sections;
+  gatherMeshSections(sections, c, chunkManager);
+  MeshInput input;
+  fillMeshInput(input, sections);
+  input.lightVolume = meshLighting() == MeshLighting::Volume && c.wantedLod == 0;
+
+  std::vector<PackedVertex> verts;
+  FaceRanges faceRanges;
+  std::vector<PackedVertex> waterVerts;
+  FaceRanges waterFaceRanges;
+  
+  glm::ivec3 chunkWorldOrigin(
+      c.position.x * CHUNK_SIZE,
+      c.position.y * CHUNK_SIZE,
+      c.position.z * CHUNK_SIZE);
+  if (partial)
+  {
+    buildChunkMeshSlices(input, c.dirtySlices, chunkWorldOrigin, verts, faceRanges, waterVerts, waterFaceRanges);
+    uploadSlicesToGPU(c, c.dirtySlices, verts, faceRanges, waterVerts, waterFaceRanges);
+  }
+  else
+  {
+    buildChunkMeshAtLod(input, c.wantedLod, chunkWorldOrigin, verts, faceRanges, waterVerts, waterFaceRanges);
+    uploadToGPU(c, verts, faceRanges);
+    uploadWaterToGPU(c, waterVerts, waterFaceRanges);
+    c.meshLod = c.wantedLod;
+    c.meshLightVolume = input.lightVolume;
+  }
+  if (input.lightVolume)
+  {
+    uploadLightVolume(c, input.skyLight);
+    c.lightVolumeDirty = false;
+  }
+  c.dirtySlices.clear();
+  chunkManager.countMeshBuild(&c);
 }
 
-static float getSlopeAngle(BlockGetter getBlock, int x, int y, int z)
+// Apron cells along one axis for a neighbour offset of d (-1, 0 or +1).
+static void apronRange(int d, int &begin, int &end)
 {
-    glm::vec3 flow = getFlowDirection(getBlock, x, y, z);
-    if (flow.x == 0.0f && flow.z == 0.0f)
-        return -1000.0f;
-    return std::atan2(flow.z, flow.x) - (3.14159265359f / 2.0f);
+  if (d < 0) { begin = -1; end = 0; }
+  else if (d > 0) { begin = CHUNK_SIZE; end = CHUNK_SIZE + 1; }
+  else { begin = 0; end = CHUNK_SIZE; }
 }
 
-struct WaterVertexUV
+static int wrapLocal(int v)
 {
-    float u0, v0, u1, v1, u2, v2, u3, v3;
-};
+  if (v < 0) return v + CHUNK_SIZE;
+  if (v >= CHUNK_SIZE) return v - CHUNK_SIZE;
+  return v;
+}
 
-static WaterVertexUV calculateWaterUV(float angle)
+void gatherMeshSections(MeshSections &out, Chunk &c, ChunkManager &chunkManager)
 {
-    WaterVertexUV uv;
-    
-    if (angle < -999.0f)
-    {
-        uv.u0 = 0.0f; uv.v0 = 0.0f;
-        uv.u1 = 0.0f; uv.v1 = 1.0f;
-        uv.u2 = 1.0f; uv.v2 = 1.0f;
-        uv.u3 = 1.0f; uv.v3 = 0.0f;
-    }
-    else
-    {
-        float sinA = std::sin(angle) * 0.25f;
-        float cosA = std::cos(angle) * 0.25f;
-        
-        uv.u0 = 0.5f + (-cosA - sinA);
-        uv.v0 = 0.5f + (-cosA + sinA);
-        uv.u1 = 0.5f + (-cosA + sinA);
-        uv.v1 = 0.5f + (cosA + sinA);
-        uv.u2 = 0.5f + (cosA + sinA);
-        uv.v2 = 0.5f + (cosA - sinA);
-        uv.u3 = 0.5f + (cosA - sinA);
-        uv.v3 = 0.5f + (-cosA - sinA);
-    }
-    
-    return uv;
+  for (int dz = -1; dz <= 1; dz++)
+    for (int dy = -1; dy <= 1; dy++)
+      for (int dx = -1; dx <= 1; dx++)
+      {
+        Chunk *n = (dx == 0 && dy == 0 && dz == 0)
+                       ? &c
+                       : chunkManager.getChunk(c.position.x + dx, c.position.y + dy, c.position.z + dz);
+        out.sections[MeshSections::index(dx, dy, dz)] = n ? n->snapshot() : nullptr;
+      }
 }
 
-static void buildGreedyMesh(
-    const BlockID* blocks,
-    const glm::ivec3& chunkWorldOrigin,
-    BlockGetter getBlock,
-    LightGetter getSkyLight,
-    std::vector<Vertex>& outVertices,
-    std::vector<uint32_t>& outIndices,
-    bool liquidsOnly = false)
+void fillMeshInput(MeshInput &input, const MeshSections &sections)
 {
-  outVertices.clear();
-  outIndices.clear();
-  // Reserve a realistic starting size; when vectors are reused from the job
-  // pool their existing capacity is preserved by clear(), so this only
-  // allocates on the very first use of each vector.
-  constexpr size_t MESH_VERT_RESERVE = CHUNK_SIZE * CHUNK_SIZE * 6;  // 1536
-  constexpr size_t MESH_IDX_RESERVE  = CHUNK_SIZE * CHUNK_SIZE * 9;  // 2304
-  if (outVertices.capacity() < MESH_VERT_RESERVE)
-      outVertices.reserve(MESH_VERT_RESERVE);
-  if (outIndices.capacity() < MESH_IDX_RESERVE)
-      outIndices.reserve(MESH_IDX_RESERVE);
-
-  // Water top-face (dir==2) calls getFluidHeight for every corner of every
-  // face, but adjacent water blocks share corners. Cache the (CHUNK_SIZE+1)²
-  // corner heights for the current Y-slice to avoid redundant block reads.
-  float cornerHeightCache[CHUNK_SIZE + 1][CHUNK_SIZE + 1];
-  bool cornerCacheValid = false;
-
-  for (int dir = 0; dir < 6; dir++)
+  const SectionSnapshot &c = *sections.sections[MeshSections::index(0, 0, 0)];
+  BlockID blocks[CHUNK_VOLUME];
+  uint8_t light[CHUNK_VOLUME];
+  c.blocks.copyTo(blocks);
+  c.skyLight.copyTo(light);
+
+  // x is the fastest axis in both layouts, so the interior goes row by row.
+  for (int z = 0; z < CHUNK_SIZE; z++)
   {
-    glm::ivec3 n = DIRS[dir];
-    int axis = 0;
-    if (n.y != 0) axis = 1;
-    if (n.z != 0) axis = 2;
-
-    int u = (axis + 1) % 3;
-    int v = (axis + 2) % 3;
-
-    BlockID mask[CHUNK_SIZE][CHUNK_SIZE];
-    uint8_t lightMask[CHUNK_SIZE][CHUNK_SIZE];
-    float heightMask[CHUNK_SIZE][CHUNK_SIZE];
-
-    for (int i = 0; i < CHUNK_SIZE; i++)
+    for (int y = 0; y < CHUNK_SIZE; y++)
     {
-      if (liquidsOnly && dir == 2)
-          cornerCacheValid = false;  // invalidate on each new Y-slice
+      std::memcpy(&input.blocks[MeshInput::index(0, y, z)], &blocks[blockIndex(0, y, z)], CHUNK_SIZE * sizeof(BlockID));
+      std::memcpy(&input.skyLight[MeshInput::index(0, y, z)], &light[blockIndex(0, y, z)], CHUNK_SIZE);
+    }
+  }
 
-      for (int j = 0; j < CHUNK_SIZE; j++)
+  for (int dz = -1; dz <= 1; dz++)
+  {
+    for (int dy = -1; dy <= 1; dy++)
+    {
+      for (int dx = -1; dx <= 1; dx++)
       {
-        for (int k = 0; k < CHUNK_SIZE; k++)
-        {
-          glm::ivec3 pos;
-          pos[axis] = i;
-          pos[u] = k;
-          pos[v] = j;
-
-          BlockID current = blocks[blockIndex(pos.x, pos.y, pos.z)];
-          bool isCurrentLiquid = g_blockTypes[current].isLiquid;
-
-          if (liquidsOnly != isCurrentLiquid)
-          {
-            mask[j][k] = 0;
-            lightMask[j][k] = 0;
-            heightMask[j][k] = 1.0f;
-            continue;
-          }
-
-          glm::ivec3 npos = pos + n;
-          BlockID neighbor = getBlock(npos.x, npos.y, npos.z);
-          bool isNeighborLiquid = g_blockTypes[neighbor].isLiquid;
+        if (dx == 0 && dy == 0 && dz == 0)
+          continue;
 
-          bool showFace = false;
-          float waterHeight = 1.0f;
-
-          if (current != 0)
-          {
-            if (liquidsOnly)
-            {
-              if (dir == 2 && !isNeighborLiquid)
-              {
-                showFace = true;
-                waterHeight = getWaterHeight(current);
-                
-                BlockID above = getBlock(pos.x, pos.y + 1, pos.z);
-                if (isWater(above))
-                {
-                    showFace = false;
-                }
-              }
-              else if (dir != 2 && dir != 3)
-              {
-                if (!isNeighborLiquid && !isBlockSolid(neighbor))
-                {
-                  showFace = true;
-                  waterHeight = getWaterHeight(current);
-                }
-              }
-              else if (dir == 3)
-              {
-                if (!isNeighborLiquid && !isBlockSolid(neighbor))
-                {
-                  showFace = true;
-                }
-              }
-            }
-            else
-            {
-              if (neighbor == 0)
-              {
-                showFace = true;
-              }
-              else if (isNeighborLiquid)
-              {
-                showFace = true;
-              }
-              else if (isBlockTransparent(neighbor))
-              {
-                if (current == neighbor && g_blockTypes[current].connectsToSame)
-                {
-                  showFace = false;
-                }
-                else if (current != neighbor)
-                {
-                  showFace = true;
-                }
-              }
-            }
-          }
+        int x0, x1, y0, y1, z0, z1;
+        apronRange(dx, x0, x1);
+        apronRange(dy, y0, y1);
+        apronRange(dz, z0, z1);
 
-          mask[j][k] = showFace ? current : 0;
-          lightMask[j][k] = showFace ? getSkyLight(npos.x, npos.y, npos.z) : 0;
-          heightMask[j][k] = waterHeight;
-        }
-      }
+        const SectionSnapshot *n = sections.sections[MeshSections::index(dx, dy, dz)].get();
+        bool uniform = !n || (n->blocks.isUniform() && n->skyLight.isUniform());
+        BlockID fillBlock = n ? n->blocks.uniformBlock() : 0;
+        uint8_t fillLight = n ? n->skyLight.uniformLight() : MAX_SKY_LIGHT;
 
-      for (int j = 0; j < CHUNK_SIZE; j++)
-      {
-        for (int k = 0; k < CHUNK_SIZE; k++)
+        for (int z = z0; z < z1; z++)
         {
-          if (mask[j][k] != 0)
+          for (int y = y0; y < y1; y++)
           {
-            BlockID type = mask[j][k];
-            uint8_t light = lightMask[j][k];
-            float height = heightMask[j][k];
-            int w = 1;
-            int h = 1;
-
-            if (!liquidsOnly)
-            {
-              while (k + w < CHUNK_SIZE && mask[j][k + w] == type && lightMask[j][k + w] == light)
-                w++;
-
-              bool done = false;
-              while (j + h < CHUNK_SIZE)
-              {
-                for (int dx = 0; dx < w; dx++)
-                {
-                  if (mask[j + h][k + dx] != type || lightMask[j + h][k + dx] != light)
-                  {
-                    done = true;
-                    break;
-                  }
-                }
-                if (done) break;
-                h++;
-              }
-            }
-
-            const Vertex *face = FACE_TABLE[dir];
-            uint32_t baseIndex = static_cast<uint32_t>(outVertices.size());
-
-            int tileIndex = g_blockTypes[type].faceTexture[dir];
-            int rotation = g_blockTypes[type].faceRotation[dir];
-
-            float faceShade = FACE_SHADE[dir];
-            float skyLightNormalized = static_cast<float>(light) / static_cast<float>(MAX_SKY_LIGHT);
-
-            int axisOffset = (n[axis] > 0) ? 1 : 0;
-            
-            glm::ivec3 blockWorldPos;
-            blockWorldPos[axis] = i;
-            blockWorldPos[u] = k;
-            blockWorldPos[v] = j;
-            
-            float flowAngle = -1000.0f;
-            if (liquidsOnly && dir == 2)
+            for (int x = x0; x < x1; x++)
             {
-                flowAngle = getSlopeAngle(getBlock, blockWorldPos.x, blockWorldPos.y, blockWorldPos.z);
-            }
-            WaterVertexUV waterUV = calculateWaterUV(flowAngle);
-
-            int blockX = blockWorldPos.x;
-            int blockY = blockWorldPos.y;
-            int blockZ = blockWorldPos.z;
-            glm::vec3 biomeTint(1.0f);
-            if (g_blockTypes[type].faceTint[dir])
-            {
-                BiomeID biome = getBiomeAt(
-                    chunkWorldOrigin.x + blockX,
-                    chunkWorldOrigin.z + blockZ);
-                bool isLeaf = g_blockTypes[type].transparent && g_blockTypes[type].solid;
-                biomeTint = isLeaf
-                    ? getBiomeFoliageTint(biome)
-                    : getBiomeGrassTint(biome);
-            }
-
-            for (int vIdx = 0; vIdx < 4; vIdx++)
-            {
-              Vertex vtx = face[vIdx];
-              glm::vec3 originalPos = vtx.pos;
-              glm::vec3 finalPos;
-              bool isTopVertex = originalPos.y > 0.5f;
-              float vertexWaterHeight = height;
-
-              if (liquidsOnly)
+              int dst = MeshInput::index(x, y, z);
+              if (uniform)
               {
-                finalPos.x = static_cast<float>(blockX) + originalPos.x;
-                finalPos.y = static_cast<float>(blockY) + originalPos.y;
-                finalPos.z = static_cast<float>(blockZ) + originalPos.z;
-                
-                if (dir == 2)
-                {
-                  int cornerX = blockX + static_cast<int>(originalPos.x);
-                  int cornerZ = blockZ + static_cast<int>(originalPos.z);
-                  if (!cornerCacheValid)
-                  {
-                    cornerCacheValid = true;
-                    for (int cz = 0; cz <= CHUNK_SIZE; ++cz)
-                      for (int cx = 0; cx <= CHUNK_SIZE; ++cx)
-                        cornerHeightCache[cz][cx] = getFluidHeight(getBlock, cx, i, cz);
-                  }
-                  float cornerHeight = cornerHeightCache[cornerZ][cornerX];
-                  finalPos.y = static_cast<float>(blockY) + cornerHeight - 0.01f;
-                  vertexWaterHeight = cornerHeight;
-                }
-                else if (dir == 0 || dir == 1 || dir == 4 || dir == 5)
-                {
-                  if (isTopVertex)
-                  {
-                    int cornerX = blockX + static_cast<int>(originalPos.x);
-                    int cornerZ = blockZ + static_cast<int>(originalPos.z);
-                    float cornerHeight = getFluidHeight(getBlock, cornerX, blockY, cornerZ);
-                    finalPos.y = static_cast<float>(blockY) + cornerHeight - 0.01f;
-                    vertexWaterHeight = cornerHeight;
-                  }
-                  else
-                  {
-                    finalPos.y = static_cast<float>(blockY);
-                  }
-                }
+                input.blocks[dst] = fillBlock;
+                input.skyLight[dst] = fillLight;
               }
               else
               {
-                finalPos[axis] = static_cast<float>(i + axisOffset);
-
-                if (vtx.uv.x > 0.5f) finalPos[u] = static_cast<float>(k + w);
-                else finalPos[u] = static_cast<float>(k);
-
-                if (vtx.uv.y > 0.5f) finalPos[v] = static_cast<float>(j + h);
-                else finalPos[v] = static_cast<float>(j);
-              }
-
-              vtx.pos = finalPos;
-
-              float localU = (vtx.uv.x > 0.5f) ? static_cast<float>(w) : 0.0f;
-              float localV = (vtx.uv.y > 0.5f) ? static_cast<float>(h) : 0.0f;
-
-              if (liquidsOnly && dir == 2)
-              {
-                  switch (vIdx)
-                  {
-                      case 0: localU = waterUV.u0; localV = waterUV.v0; break;
-                      case 1: localU = waterUV.u1; localV = waterUV.v1; break;
-                      case 2: localU = waterUV.u2; localV = waterUV.v2; break;
-                      case 3: localU = waterUV.u3; localV = waterUV.v3; break;
-                  }
-              }
-              else if (liquidsOnly && (dir == 0 || dir == 1 || dir == 4 || dir == 5))
-              {
-                localV = isTopVertex ? vertexWaterHeight : 0.0f;
-              }
-
-              if (!liquidsOnly)
-              {
-                  switch (rotation)
-                  {
-                    case 1:
-                      {
-                        float tmp = localU;
-                        localU = localV;
-                        localV = static_cast<float>(w) - tmp;
-                      }
-                      break;
-                    case 2:
-                      localV = static_cast<float>(h) - localV;
-                      break;
-                    case 3:
-                      {
-                        float tmp = localU;
-                        localU = static_cast<float>(h) - localV;
-                        localV = tmp;
-                      }
-                      break;
-                    default:
-                      break;
-                  }
-              }
-
-              vtx.uv = glm::vec2(localU, localV);
-              vtx.tileIndex = static_cast<float>(tileIndex);
-              vtx.skyLight = skyLightNormalized;
-              vtx.faceShade = faceShade;
-              vtx.biomeTint = biomeTint;
-
-              outVertices.push_back(vtx);
-            }
-
-            for (int idx = 0; idx < 6; idx++)
-              outIndices.push_back(baseIndex + FACE_INDICES[idx]);
-
-            for (int dy = 0; dy < h; dy++)
-            {
-              for (int dx = 0; dx < w; dx++)
-              {
-                mask[j + dy][k + dx] = 0;
-                lightMask[j + dy][k + dx] = 0;
+                int src = blockIndex(wrapLocal(x), wrapLocal(y), wrapLocal(z));
+                input.blocks[dst] = n->blocks.get(src);
+                input.skyLight[dst] = n->skyLight.get(src);
               }
             }
           }
@@ -503,260 +190,131 @@ static void buildGreedyMesh(
   }
 }
 
-void calculateSkyLight(Chunk &c, ChunkManager &chunkManager)
+void uploadLightVolume(Chunk &c, const uint8_t *volume)
 {
-  auto getBlockWorld = [&](int x, int y, int z) -> BlockID
+  if (c.lightTex == 0)
   {
-    if (x >= 0 && x < CHUNK_SIZE &&
-        y >= 0 && y < CHUNK_SIZE &&
-        z >= 0 && z < CHUNK_SIZE)
-    {
-      return c.blocks[blockIndex(x, y, z)];
-    }
-    
-    int neighborCX = c.position.x;
-    int neighborCY = c.position.y;
-    int neighborCZ = c.position.z;
-    int localX = x, localY = y, localZ = z;
-    
-    if (x < 0) { neighborCX--; localX = CHUNK_SIZE + x; }
-    else if (x >= CHUNK_SIZE) { neighborCX++; localX = x - CHUNK_SIZE; }
-    if (y < 0) { neighborCY--; localY = CHUNK_SIZE + y; }
-    else if (y >= CHUNK_SIZE) { neighborCY++; localY = y - CHUNK_SIZE; }
-    if (z < 0) { neighborCZ--; localZ = CHUNK_SIZE + z; }
-    else if (z >= CHUNK_SIZE) { neighborCZ++; localZ = z - CHUNK_SIZE; }
-    
-    Chunk *neighbor = chunkManager.getChunk(neighborCX, neighborCY, neighborCZ);
-    if (!neighbor) return 0;
-    return neighbor->blocks[blockIndex(localX, localY, localZ)];
-  };
-
-  std::fill(std::begin(c.skyLight), std::end(c.skyLight), 0);
-
-  std::queue<glm::ivec3> lightQueue;
-
-  Chunk *chunkAbove = chunkManager.getChunk(c.position.x, c.position.y + 1, c.position.z);
-  
-  for (int x = 0; x < CHUNK_SIZE; x++)
+    glGenTextures(1, &c.lightTex);
+    glBindTexture(GL_TEXTURE_3D, c.lightTex);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_R8UI, MESH_INPUT_SIZE, MESH_INPUT_SIZE, MESH_INPUT_SIZE);
+  }
+  else
   {
-    for (int z = 0; z < CHUNK_SIZE; z++)
-    {
-      uint8_t incomingLight = MAX_SKY_LIGHT;
-      if (chunkAbove)
-      {
-        BlockID blockAbove = chunkAbove->blocks[blockIndex(x, 0, z)];
-        if (!isBlockTransparent(blockAbove))
-        {
-          incomingLight = chunkAbove->skyLight[blockIndex(x, 0, z)];
-        }
-        else
-        {
-          incomingLight = chunkAbove->skyLight[blockIndex(x, 0, z)];
-        }
-      }
-      
-      uint8_t currentLight = incomingLight;
-      for (int y = CHUNK_SIZE - 1; y >= 0; y--)
-      {
-        int idx = blockIndex(x, y, z);
-        BlockID block = c.blocks[idx];
-        
-        if (block == 0)
-        {
-          c.skyLight[idx] = currentLight;
-          if (currentLight > 1)
-            lightQueue.push({x, y, z});
-        }
-        else if (isBlockTransparent(block))
-        {
-          if (currentLight > 0 && (y % 2 == 0))
-            currentLight = currentLight > 1 ? currentLight - 1 : currentLight;
-          c.skyLight[idx] = currentLight;
-          if (currentLight > 1)
-            lightQueue.push({x, y, z});
-        }
-        else
-        {
-          currentLight = 0;
-          c.skyLight[idx] = 0;
-        }
-      }
-    }
+    glBindTexture(GL_TEXTURE_3D, c.lightTex);
   }
 
-  while (!lightQueue.empty())
+  // Rows are MESH_INPUT_SIZE bytes, which isn't a multiple of four.
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, MESH_INPUT_SIZE, MESH_INPUT_SIZE, MESH_INPUT_SIZE,
+                  GL_RED_INTEGER, GL_UNSIGNED_BYTE, volume);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void refreshLightVolume(Chunk &c, ChunkManager &chunkManager)
+{
+  // Same cells and fallbacks as fillMeshInput, read from the live chunks.
+  uint8_t volume[MESH_INPUT_VOLUME];
+  for (int dz = -1; dz <= 1; dz++)
   {
-    glm::ivec3 pos = lightQueue.front();
-    lightQueue.pop();
-    
-    int idx = blockIndex(pos.x, pos.y, pos.z);
-    uint8_t currentLight = c.skyLight[idx];
-    
-    if (currentLight <= 1) continue;
-    
-    const glm::ivec3 dirs[6] = {{1,0,0}, {-1,0,0}, {0,1,0}, {0,-1,0}, {0,0,1}, {0,0,-1}};
-    
-    for (const auto& dir : dirs)
+    for (int dy = -1; dy <= 1; dy++)
     {
-      int nx = pos.x + dir.x;
-      int ny = pos.y + dir.y;
-      int nz = pos.z + dir.z;
-      
-      if (nx < 0 || nx >= CHUNK_SIZE ||
-          ny < 0 || ny >= CHUNK_SIZE ||
-          nz < 0 || nz >= CHUNK_SIZE)
-        continue;
-      
-      int nidx = blockIndex(nx, ny, nz);
-      BlockID neighborBlock = c.blocks[nidx];
-      
-      if (!isBlockTransparent(neighborBlock))
-        continue;
-      
-      uint8_t attenuation = 1;
-      uint8_t newLight = (currentLight > attenuation) ? currentLight - attenuation : 0;
-      
-      if (newLight > c.skyLight[nidx])
+      for (int dx = -1; dx <= 1; dx++)
       {
-        c.skyLight[nidx] = newLight;
-        if (newLight > 1)
-          lightQueue.push({nx, ny, nz});
+        int x0, x1, y0, y1, z0, z1;
+        apronRange(dx, x0, x1);
+        apronRange(dy, y0, y1);
+        apronRange(dz, z0, z1);
+
+        const Chunk *n = (dx == 0 && dy == 0 && dz == 0)
+                             ? &c
+                             : chunkManager.getChunk(c.position.x + dx, c.position.y + dy, c.position.z + dz);
+        const bool uniform = !n || n->skyLight.isUniform();
+        const uint8_t fillLight = n ? n->skyLight.uniformLight() : MAX_SKY_LIGHT;
+        for (int z = z0; z < z1; z++)
+          for (int y = y0; y < y1; y++)
+            for (int x = x0; x < x1; x++)
+              volume[MeshInput::index(x, y, z)] =
+                  uniform ? fillLight : n->skyLight.get(blockIndex(wrapLocal(x), wrapLocal(y), wrapLocal(z)));
       }
     }
   }
-  
-  c.dirtyLight = false;
+  uploadLightVolume(c, volume);
+  c.lightVolumeDirty = false;
 }
 
-void buildChunkMesh(Chunk &c, ChunkManager &chunkManager)
+static GLuint g_quadIndexBuffer = 0;
+static size_t g_quadIndexCapacity = 0;
+
+// Binds the shared quad index buffer to the current VAO, growing it to at
+// least quadCount quads first. Growing respecifies the same buffer name, so
+// VAOs that already reference it keep working.
+static void bindQuadIndexBuffer(size_t quadCount)
 {
-  if (c.dirtyLight)
-  {
-    calculateSkyLight(c, chunkManager);
-  }
+  if (g_quadIndexBuffer == 0)
+    glGenBuffers(1, &g_quadIndexBuffer);
 
-  auto getBlock = [&](int x, int y, int z) -> BlockID
-  {
-    if (x >= 0 && x < CHUNK_SIZE &&
-        y >= 0 && y < CHUNK_SIZE &&
-        z >= 0 && z < CHUNK_SIZE)
-    {
-      return c.blocks[blockIndex(x, y, z)];
-    }
-    
-    int neighborCX = c.position.x;
-    int neighborCY = c.position.y;
-    int neighborCZ = c.position.z;
-    int localX = x;
-    int localY = y;
-    int localZ = z;
-    
-    if (x < 0) { neighborCX--; localX = CHUNK_SIZE + x; }
-    else if (x >= CHUNK_SIZE) { neighborCX++; localX = x - CHUNK_SIZE; }
-    
-    if (y < 0) { neighborCY--; localY = CHUNK_SIZE + y; }
-    else if (y >= CHUNK_SIZE) { neighborCY++; localY = y - CHUNK_SIZE; }
-    
-    if (z < 0) { neighborCZ--; localZ = CHUNK_SIZE + z; }
-    else if (z >= CHUNK_SIZE) { neighborCZ++; localZ = z - CHUNK_SIZE; }
-    
-    Chunk *neighbor = chunkManager.getChunk(neighborCX, neighborCY, neighborCZ);
-    if (neighbor == nullptr)
-    {
-      return 0;
-    }
-    
-    return neighbor->blocks[blockIndex(localX, localY, localZ)];
-  };
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_quadIndexBuffer);
+  if (quadCount <= g_quadIndexCapacity)
+    return;
 
-  auto getSkyLight = [&](int x, int y, int z) -> uint8_t
-  {
-    if (x >= 0 && x < CHUNK_SIZE &&
-        y >= 0 && y < CHUNK_SIZE &&
-        z >= 0 && z < CHUNK_SIZE)
-    {
-      return c.skyLight[blockIndex(x, y, z)];
-    }
-    
-    int neighborCX = c.position.x;
-    int neighborCY = c.position.y;
-    int neighborCZ = c.position.z;
-    int localX = x, localY = y, localZ = z;
-    
-    if (x < 0) { neighborCX--; localX = CHUNK_SIZE + x; }
-    else if (x >= CHUNK_SIZE) { neighborCX++; localX = x - CHUNK_SIZE; }
-    if (y < 0) { neighborCY--; localY = CHUNK_SIZE + y; }
-    else if (y >= CHUNK_SIZE) { neighborCY++; localY = y - CHUNK_SIZE; }
-    if (z < 0) { neighborCZ--; localZ = CHUNK_SIZE + z; }
-    else if (z >= CHUNK_SIZE) { neighborCZ++; localZ = z - CHUNK_SIZE; }
-    
-    Chunk *neighbor = chunkManager.getChunk(neighborCX, neighborCY, neighborCZ);
-    if (!neighbor) return MAX_SKY_LIGHT;
-    return neighbor->skyLight[blockIndex(localX, localY, localZ)];
-  };
-
-  std::vector<Vertex> verts;
-  std::vector<uint32_t> inds;
-  std::vector<Vertex> waterVerts;
-  std::vector<uint32_t> waterInds;
-  
-  glm::ivec3 chunkWorldOrigin(
-      c.position.x * CHUNK_SIZE,
-      c.position.y * CHUNK_SIZE,
-      c.position.z * CHUNK_SIZE);
-  buildGreedyMesh(c.blocks, chunkWorldOrigin, getBlock, getSkyLight, verts, inds, false);
-  buildGreedyMesh(c.blocks, chunkWorldOrigin, getBlock, getSkyLight, waterVerts, waterInds, true);
-  
-  uploadToGPU(c, verts, inds);
-  uploadWaterToGPU(c, waterVerts, waterInds);
+  // A full checkerboard section is the worst case for one pass.
+  size_t capacity = std::max(quadCount, static_cast<size_t>(CHUNK_VOLUME / 2 * 6));
+  std::vector<uint32_t> indices(capacity * 6);
+  for (size_t q = 0; q < capacity; q++)
+    for (int i = 0; i < 6; i++)
+      indices[q * 6 + i] = static_cast<uint32_t>(q * 4) + QUAD_INDEX_PATTERN[i];
+
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+               indices.size() * sizeof(uint32_t),
+               indices.data(),
+               GL_STATIC_DRAW);
+  g_quadIndexCapacity = capacity;
 }
 
-void uploadToGPU(Chunk &c, const std::vector<Vertex> &verts, const std::vector<uint32_t> &inds)
+void releaseQuadIndexBuffer()
 {
+  if (g_quadIndexBuffer)
+    glDeleteBuffers(1, &g_quadIndexBuffer);
+  g_quadIndexBuffer = 0;
+  g_quadIndexCapacity = 0;
+}
+
+void uploadToGPU(Chunk &c, const std::vector<PackedVertex> &verts, const FaceRanges &faceRanges)
+{
+  if (c.vao == 0)
+  {
+    glGenVertexArrays(1, &c.vao);
+    glGenBuffers(1, &c.vbo);
+  }
+
   glBindVertexArray(c.vao);
 
   glBindBuffer(GL_ARRAY_BUFFER, c.vbo);
   glBufferData(GL_ARRAY_BUFFER,
-               verts.size() * sizeof(Vertex),
+               verts.size() * sizeof(PackedVertex),
                verts.data(),
                GL_STATIC_DRAW);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, c.ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-               inds.size() * sizeof(uint32_t),
-               inds.data(),
-               GL_STATIC_DRAW);
+  bindQuadIndexBuffer(verts.size() / 4);
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, pos));
+  glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(PackedVertex),
+                         (void *)offsetof(PackedVertex, lo));
   glEnableVertexAttribArray(0);
 
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, uv));
-  glEnableVertexAttribArray(1);
-
-  glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, tileIndex));
-  glEnableVertexAttribArray(2);
-
-  glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, skyLight));
-  glEnableVertexAttribArray(3);
-
-  glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, faceShade));
-  glEnableVertexAttribArray(4);
-
-  glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, biomeTint));
-  glEnableVertexAttribArray(5);
-
-  c.indexCount = static_cast<uint32_t>(inds.size());
+  c.indexCount = quadIndexCount(verts.size());
   c.vertexCount = static_cast<uint32_t>(verts.size());
+  c.faceRanges = faceRanges;
 }
 
-void uploadWaterToGPU(Chunk &c, const std::vector<Vertex> &verts, const std::vector<uint32_t> &inds)
+void uploadWaterToGPU(Chunk &c, const std::vector<PackedVertex> &verts, const FaceRanges &faceRanges)
 {
+  c.waterFaceRanges = faceRanges;
   if (verts.empty())
   {
     c.waterIndexCount = 0;
@@ -768,62 +326,98 @@ void uploadWaterToGPU(Chunk &c, const std::vector<Vertex> &verts, const std::vec
   {
     glGenVertexArrays(1, &c.waterVao);
     glGenBuffers(1, &c.waterVbo);
-    glGenBuffers(1, &c.waterEbo);
   }
 
   glBindVertexArray(c.waterVao);
 
   glBindBuffer(GL_ARRAY_BUFFER, c.waterVbo);
   glBufferData(GL_ARRAY_BUFFER,
-               verts.size() * sizeof(Vertex),
+               verts.size() * sizeof(PackedVertex),
                verts.data(),
                GL_STATIC_DRAW);
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, c.waterEbo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-               inds.size() * sizeof(uint32_t),
-               inds.data(),
-               GL_STATIC_DRAW);
+  bindQuadIndexBuffer(verts.size() / 4);
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, pos));
+  glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(PackedVertex),
+                         (void *)offsetof(PackedVertex, lo));
   glEnableVertexAttribArray(0);
 
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, uv));
-  glEnableVertexAttribArray(1);
-
-  glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, tileIndex));
-  glEnableVertexAttribArray(2);
-
-  glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, skyLight));
-  glEnableVertexAttribArray(3);
+  c.waterIndexCount = quadIndexCount(verts.size());
+  c.waterVertexCount = static_cast<uint32_t>(verts.size());
+}
 
-  glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, faceShade));
-  glEnableVertexAttribArray(4);
+// Applies one pass of a slice patch to vao/vbo, whose contents ranges
+// describes. Returns the new quad count.
+static uint32_t spliceSlices(GLuint &vao, GLuint &vbo, FaceRanges &ranges,
+                             const std::vector<PackedVertex> &patch, const FaceRanges &patchRanges,
+                             const DirtySlices &slices)
+{
+  // Main thread only, like every other GL call here.
+  static std::vector<SpliceRun> runs;
+  FaceRanges newRanges;
+  bool inPlace = planSliceSplice(ranges, patchRanges, slices, newRanges, runs);
+  const uint32_t quadCount = newRanges.start[6];
+  ranges = newRanges;
+  if (vao == 0)
+  {
+    // Nothing uploaded yet; the old mesh is empty, so every run is patch.
+    if (quadCount == 0)
+      return 0;
+    glGenVertexArrays(1, &vao);
+    inPlace = false;
+  }
 
-  glVertexAttribPointer(5, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                        (void *)offsetof(Vertex, biomeTint));
-  glEnableVertexAttribArray(5);
+  constexpr GLsizeiptr QUAD_BYTES = 4 * sizeof(PackedVertex);
+  glBindVertexArray(vao);
+  if (inPlace)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    for (const SpliceRun &run : runs)
+    {
+      if (run.fromPatch)
+        glBufferSubData(GL_ARRAY_BUFFER, run.dstQuad * QUAD_BYTES, run.quadCount * QUAD_BYTES,
+                        &patch[run.srcQuad * 4]);
+    }
+  }
+  else
+  {
+    GLuint target = 0;
+    glGenBuffers(1, &target);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, target);
+    glBufferData(GL_COPY_WRITE_BUFFER, quadCount * QUAD_BYTES, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, vbo);
+    for (const SpliceRun &run : runs)
+    {
+      if (run.fromPatch)
+        glBufferSubData(GL_COPY_WRITE_BUFFER, run.dstQuad * QUAD_BYTES, run.quadCount * QUAD_BYTES,
+                        &patch[run.srcQuad * 4]);
+      else
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            run.srcQuad * QUAD_BYTES, run.dstQuad * QUAD_BYTES, run.quadCount * QUAD_BYTES);
+    }
+    if (vbo)
+      glDeleteBuffers(1, &vbo);
+    vbo = target;
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(PackedVertex),
+                           (void *)offsetof(PackedVertex, lo));
+    glEnableVertexAttribArray(0);
+  }
 
-  c.waterIndexCount = static_cast<uint32_t>(inds.size());
-  c.waterVertexCount = static_cast<uint32_t>(verts.size());
+  bindQuadIndexBuffer(quadCount);
+  return quadCount;
 }
 
-void buildChunkMeshOffThread(
-    const BlockID* blocks,
-    const uint8_t* skyLight,
-    const glm::ivec3& chunkWorldOrigin,
-    BlockGetter getBlock,
-    LightGetter getSkyLight,
-    std::vector<Vertex>& outVertices,
-    std::vector<uint32_t>& outIndices,
-    std::vector<Vertex>& outWaterVertices,
-    std::vector<uint32_t>& outWaterIndices)
+void uploadSlicesToGPU(Chunk &c, const DirtySlices &slices,
+                       const std::vector<PackedVertex> &verts, const FaceRanges &faceRanges,
+                       const std::vector<PackedVertex> &waterVerts, const FaceRanges &waterFaceRanges)
 {
-  buildGreedyMesh(blocks, chunkWorldOrigin, getBlock, getSkyLight, outVertices, outIndices, false);
-  buildGreedyMesh(blocks, chunkWorldOrigin, getBlock, getSkyLight, outWaterVertices, outWaterIndices, true);
+  uint32_t quads = spliceSlices(c.vao, c.vbo, c.faceRanges, verts, faceRanges, slices);
+  c.indexCount = quadIndexCount(quads * 4);
+  c.vertexCount = quads * 4;
+
+  quads = spliceSlices(c.waterVao, c.waterVbo, c.waterFaceRanges, waterVerts, waterFaceRanges, slices);
+  c.waterIndexCount = quadIndexCount(quads * 4);
+  c.waterVertexCount = quads * 4;
 }
@@ -1,55 +1,72 @@
 #pragma once
 #include "../world/Chunk.h"
 #include "../world/ChunkManager.h"
+#include "GreedyMesher.h"
+#include <array>
+#include <memory>
 #include <vector>
-#include <functional>
 #include <glm/glm.hpp>
 
-struct Vertex
+// Face neighbours of a section in DIRS order, as handed to computeSkyLight.
+using LightNeighbors = std::array<std::shared_ptr<const SectionSnapshot>, 6>;
+
+// Snapshots c's face neighbours that have been lit; the rest are null.
+void gatherLightNeighbors(LightNeighbors &out, Chunk &c, ChunkManager &chunkManager);
+
+// Lights c in place on the calling thread. The async pipeline runs the
+// same computeSkyLight in a Light job instead.
+void calculateSkyLight(Chunk &c, ChunkManager &chunkManager);
+
+void buildChunkMesh(Chunk &c, ChunkManager &chunkManager);
+void uploadToGPU(Chunk &c, const std::vector<PackedVertex> &verts, const FaceRanges &faceRanges);
+void uploadWaterToGPU(Chunk &c, const std::vector<PackedVertex> &verts, const FaceRanges &faceRanges);
+
+// True when c's pending edits can be meshed as a slice patch over its
+// current full-detail mesh rather than from scratch.
+inline bool canRemeshSlices(const Chunk &c)
 {
-  glm::vec3 pos;
-  glm::vec2 uv;
-  float tileIndex;
-  float skyLight;
-  float faceShade;
-  glm::vec3 biomeTint;
-};
+  return c.dirtySlices.partial() && c.vao != 0 && c.meshLod == 0 && c.wantedLod == 0 &&
+         c.meshLightVolume == (meshLighting() == MeshLighting::Volume);
+}
 
-enum FaceDir {
-  DIR_POS_X = 0,
-  DIR_NEG_X = 1,
-  DIR_POS_Y = 2,
-  DIR_NEG_Y = 3,
-  DIR_POS_Z = 4,
-  DIR_NEG_Z = 5
-};
+// Uploads a MESH_INPUT_SIZE^3 skylight volume, laid out like
+// MeshInput::skyLight, as c's light volume texture.
+void uploadLightVolume(Chunk &c, const uint8_t *volume);
 
-constexpr float FACE_SHADE[6] = {
-  0.8f,   // +X (East)
-  0.8f,   // -X (West) 
-  1.0f,   // +Y (Top) - full sunlight
-  0.5f,   // -Y (Bottom) - darkest
-  0.6f,   // +Z (South)
-  0.6f    // -Z (North)
+// Gathers c's padded skylight from it and its loaded neighbours and uploads
+// it, clearing lightVolumeDirty. Main thread.
+void refreshLightVolume(Chunk &c, ChunkManager &chunkManager);
+
+// Splices a buildChunkMeshSlices patch into c's uploaded meshes. Slices
+// that keep their size are overwritten in place with glBufferSubData;
+// otherwise the buffer is rebuilt on the GPU, copying the untouched runs
+// from the old one, so nothing is read back or re-uploaded in full.
+void uploadSlicesToGPU(Chunk &c, const DirtySlices &slices,
+                       const std::vector<PackedVertex> &verts, const FaceRanges &faceRanges,
+                       const std::vector<PackedVertex> &waterVerts, const FaceRanges &waterFaceRanges);
+
+// Chunk VAOs all draw through one shared quad index buffer, created on the
+// first upload. Call once at shutdown with the GL context still current.
+void releaseQuadIndexBuffer();
+
+// A section and its 26 neighbours as shared snapshots; missing neighbours
+// are null.
+struct MeshSections
+{
+  std::shared_ptr<const SectionSnapshot> sections[27];
+
+  static int index(int dx, int dy, int dz) { return (dx + 1) + 3 * ((dy + 1) + 3 * (dz + 1)); }
+  void reset()
+  {
+    for (auto &s : sections)
+      s.reset();
+  }
 };
 
-void calculateSkyLight(Chunk &c, ChunkManager &chunkManager);
+// Takes snapshots of c and its neighbours. Runs on the main thread; with
+// no edits since the last call it is 27 reference count increments.
+void gatherMeshSections(MeshSections &out, Chunk &c, ChunkManager &chunkManager);
 
-void buildChunkMesh(Chunk &c, ChunkManager &chunkManager);
-void uploadToGPU(Chunk &c, const std::vector<Vertex> &verts, const std::vector<uint32_t> &inds);
-void uploadWaterToGPU(Chunk &c, const std::vector<Vertex> &verts, const std::vector<uint32_t> &inds);
-
-using BlockGetter = std::function<BlockID(int x, int y, int z)>;
-using LightGetter = std::function<uint8_t(int x, int y, int z)>;
-
-void buildChunkMeshOffThread(
-    const BlockID* blocks,
-    const uint8_t* skyLight,
-    const glm::ivec3& chunkWorldOrigin,
-    BlockGetter getBlock,
-    LightGetter getSkyLight,
-    std::vector<Vertex>& outVertices,
-    std::vector<uint32_t>& outIndices,
-    std::vector<Vertex>& outWaterVertices,
-    std::vector<uint32_t>& outWaterIndices
-);
\ No newline at end of file
+// Expands gathered snapshots into the padded mesher input. Safe on any
+// thread.
+void fillMeshInput(MeshInput &input, const MeshSections &sections);
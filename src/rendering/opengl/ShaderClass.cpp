@@ -47,6 +47,8 @@ std::string get_file_contents(const char* filename)
 		{"item_model.frag", embed_item_model_frag_data, embed_item_model_frag_size},
 		{"tool_model.vert", embed_tool_model_vert_data, embed_tool_model_vert_size},
 		{"tool_model.frag", embed_tool_model_frag_data, embed_tool_model_frag_size},
+		{"horizon.vert", embed_horizon_vert_data, embed_horizon_vert_size},
+		{"horizon.frag", embed_horizon_frag_data, embed_horizon_frag_size},
 	};
 
 	for (const auto& s : shaders)
@@ -7,6 +7,8 @@ in float SkyLight;
 in float FaceShade;
 in float FragDepth;
 in vec3 WorldPos;
+in vec3 LocalPos;
+flat in uint Face;
 in vec3 BiomeTint;
 
 uniform sampler2DArray textureArray;
@@ -16,6 +18,23 @@ uniform vec3 skyColor;
 uniform vec3 fogColor;
 uniform float fogDensity;
 uniform float ambientLight;
+uniform bool useLightVolume;
+uniform usampler3D lightVolume;
+
+const vec3 FACE_NORMAL[6] = vec3[](vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 1, 0),
+                                   vec3(0, -1, 0), vec3(0, 0, 1), vec3(0, 0, -1));
+
+// Light of the cell in front of the face, from the chunk's light volume
+// (one-cell apron) when the mesh left it out of the vertices. Backing off
+// the face plane by less than a vertex step finds the face's own block.
+float faceSkyLight()
+{
+    if (!useLightVolume)
+        return SkyLight;
+    vec3 n = FACE_NORMAL[Face];
+    ivec3 cell = ivec3(floor(LocalPos - n / 128.0)) + ivec3(n) + 1;
+    return float(texelFetch(lightVolume, clamp(cell, ivec3(0), ivec3(17)), 0).r) / 15.0;
+}
 
 void main()
 {
@@ -24,8 +43,9 @@ void main()
     if (texColor.a < 0.5)
         discard;
     
+    float skyLight = faceSkyLight();
     float sunBrightness = timeOfDay;
-    float skyLightContribution = SkyLight * sunBrightness;
+    float skyLightContribution = skyLight * sunBrightness;
     float totalLight = max(skyLightContribution, ambientLight);
     float finalLight = totalLight * FaceShade;
     
@@ -37,7 +57,7 @@ void main()
     float fogFactor = 1.0 - exp(-dist * fogDensity);
     fogFactor = clamp(fogFactor, 0.0, 1.0);
     
-    float shadowFogBoost = 1.0 - SkyLight;
+    float shadowFogBoost = 1.0 - skyLight;
     fogFactor = fogFactor + shadowFogBoost * 0.15;
     fogFactor = clamp(fogFactor, 0.0, 0.95);
     
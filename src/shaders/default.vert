@@ -1,10 +1,8 @@
 #version 460 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aLocalUV;
-layout (location = 2) in float aTileIndex;
-layout (location = 3) in float aSkyLight;
-layout (location = 4) in float aFaceShade;
-layout (location = 5) in vec3 aBiomeTint;
+// Packed chunk vertex, see PackedVertex in GreedyMesher.h:
+//   x: posX:5 | posY:11 (1/64) | posZ:5 | face:3 | skyLight:4 | tint:4
+//   y: u:10 | v:10 (1/32) | tileIndex:12
+layout (location = 0) in uvec2 aPacked;
 
 out vec2 LocalUV;
 flat out float TileIndex;
@@ -12,20 +10,33 @@ out float SkyLight;
 out float FaceShade;
 out float FragDepth;
 out vec3 WorldPos;
+out vec3 LocalPos;
+flat out uint Face;
 out vec3 BiomeTint;
 
 uniform mat4 transform;
 uniform mat4 model;
+uniform vec3 tintPalette[9];
+
+const float FACE_SHADE[6] = float[](0.8, 0.8, 1.0, 0.5, 0.6, 0.6);
 
 void main()
 {
+   uint lo = aPacked.x;
+   uint hi = aPacked.y;
+   vec3 aPos = vec3(float(lo & 31u),
+                    float((lo >> 5) & 2047u) / 64.0,
+                    float((lo >> 16) & 31u));
+
    vec4 worldPosition = model * vec4(aPos, 1.0);
    gl_Position = transform * vec4(aPos, 1.0);
-   LocalUV = aLocalUV;
-   TileIndex = aTileIndex;
-   SkyLight = aSkyLight;
-   FaceShade = aFaceShade;
+   LocalUV = vec2(float(hi & 1023u), float((hi >> 10) & 1023u)) / 32.0;
+   TileIndex = float(hi >> 20);
+   SkyLight = float((lo >> 24) & 15u) / 15.0;
+   Face = (lo >> 21) & 7u;
+   FaceShade = FACE_SHADE[Face];
+   LocalPos = aPos;
    FragDepth = gl_Position.z;
    WorldPos = worldPosition.xyz;
-   BiomeTint = aBiomeTint;
+   BiomeTint = tintPalette[lo >> 28];
 }
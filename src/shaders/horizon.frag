@@ -0,0 +1,27 @@
+#version 460 core
+out vec4 FragColor;
+
+in vec3 Color;
+in vec3 WorldPos;
+
+uniform float timeOfDay;
+uniform float ambientLight;
+uniform vec3 cameraPos;
+uniform vec3 fogColor;
+uniform float fogDensity;
+// (minX, minZ, maxX, maxZ) of the streamed chunks, which draw themselves.
+uniform vec4 streamedBounds;
+
+void main()
+{
+    if (WorldPos.x >= streamedBounds.x && WorldPos.x < streamedBounds.z &&
+        WorldPos.z >= streamedBounds.y && WorldPos.z < streamedBounds.w)
+        discard;
+
+    vec3 litColor = Color * max(timeOfDay, ambientLight);
+
+    float dist = length(WorldPos - cameraPos);
+    float fogFactor = clamp(1.0 - exp(-dist * fogDensity), 0.0, 1.0);
+
+    FragColor = vec4(mix(litColor, fogColor, fogFactor), 1.0);
+}
@@ -0,0 +1,18 @@
+#version 460 core
+// Horizon tile vertex, see HorizonVertex in Horizon.h. Positions are
+// tile-local in x and z; model moves the tile into place.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+out vec3 Color;
+out vec3 WorldPos;
+
+uniform mat4 transform;
+uniform mat4 model;
+
+void main()
+{
+   WorldPos = (model * vec4(aPos, 1.0)).xyz;
+   Color = aColor;
+   gl_Position = transform * vec4(aPos, 1.0);
+}
@@ -6,6 +6,8 @@ flat in float TileIndex;
 in float SkyLight;
 in float FaceShade;
 in vec3 WorldPos;
+in vec3 LocalPos;
+flat in uint Face;
 
 uniform float timeOfDay;
 uniform vec3 cameraPos;
@@ -14,13 +16,30 @@ uniform vec3 fogColor;
 uniform float fogDensity;
 uniform float ambientLight;
 uniform float time;
+uniform bool useLightVolume;
+uniform usampler3D lightVolume;
+
+const vec3 FACE_NORMAL[6] = vec3[](vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 1, 0),
+                                   vec3(0, -1, 0), vec3(0, 0, 1), vec3(0, 0, -1));
+
+// As in default.frag; backing off the face plane first keeps a lowered
+// surface reading the cell above its own block.
+float faceSkyLight()
+{
+    if (!useLightVolume)
+        return SkyLight;
+    vec3 n = FACE_NORMAL[Face];
+    ivec3 cell = ivec3(floor(LocalPos - n / 128.0)) + ivec3(n) + 1;
+    return float(texelFetch(lightVolume, clamp(cell, ivec3(0), ivec3(17)), 0).r) / 15.0;
+}
 
 void main()
 {
     float sunBrightness = timeOfDay;
-    float totalLight = max(SkyLight * sunBrightness, ambientLight);
+    float totalLight = max(faceSkyLight() * sunBrightness, ambientLight);
 
-    vec2 flowUV = LocalUV;
+    // Merged still surfaces carry UVs in block units; wrap them per block.
+    vec2 flowUV = fract(LocalUV);
     bool isFlowing = abs(flowUV.x - 0.5) > 0.01 || abs(flowUV.y - 0.5) > 0.01;
     
     vec2 animatedUV;
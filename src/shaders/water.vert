@@ -1,27 +1,36 @@
 #version 460 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aLocalUV;
-layout (location = 2) in float aTileIndex;
-layout (location = 3) in float aSkyLight;
-layout (location = 4) in float aFaceShade;
+// Same packed layout as default.vert; water never uses the tint bits.
+layout (location = 0) in uvec2 aPacked;
 
 out vec2 LocalUV;
 flat out float TileIndex;
 out float SkyLight;
 out float FaceShade;
 out vec3 WorldPos;
+out vec3 LocalPos;
+flat out uint Face;
 
 uniform mat4 transform;
 uniform mat4 model;
 
+const float FACE_SHADE[6] = float[](0.8, 0.8, 1.0, 0.5, 0.6, 0.6);
+
 void main()
 {
+   uint lo = aPacked.x;
+   uint hi = aPacked.y;
+   vec3 aPos = vec3(float(lo & 31u),
+                    float((lo >> 5) & 2047u) / 64.0,
+                    float((lo >> 16) & 31u));
+
    vec4 worldPosition = model * vec4(aPos, 1.0);
    WorldPos = worldPosition.xyz;
    
    gl_Position = transform * vec4(aPos, 1.0);
-   LocalUV = aLocalUV;
-   TileIndex = aTileIndex;
-   SkyLight = aSkyLight;
-   FaceShade = aFaceShade;
+   LocalUV = vec2(float(hi & 1023u), float((hi >> 10) & 1023u)) / 32.0;
+   TileIndex = float(hi >> 20);
+   SkyLight = float((lo >> 24) & 15u) / 15.0;
+   Face = (lo >> 21) & 7u;
+   FaceShade = FACE_SHADE[Face];
+   LocalPos = aPos;
 }
@@ -3,6 +3,7 @@
 #include "../utils/BlockTypes.h"
 #include "../gameplay/Inventory.h"
 #include "../world/TerrainGenerator.h"
+#include "../rendering/GreedyMesher.h"
 #include "../../libs/imgui/imgui.h"
 #include <cmath>
 
@@ -97,25 +98,85 @@ void drawDebugUI(
             ImGui::Text("Space: Jump");
 
             ImGui::Separator();
-            ImGui::Text("Chunks loaded: %zu", chunkManager->chunks.size());
-            ImGui::Text("Chunks loading: %zu", chunkManager->loadingChunks.size());
-            ImGui::Text("Chunks meshing: %zu", chunkManager->meshingChunks.size());
+            const ChunkManager::SectionTally& tally = chunkManager->sectionTally();
+            ImGui::Text("Chunks loaded: %zu (%zu placeholders)", chunkManager->chunkCount(), tally.placeholders);
+            // Storage sizes change with every edit and light update, so they
+            // are summed over all chunks only a couple of times a second.
+            static double storageSampledAt = -1.0;
+            static size_t blockBytes = 0, uniformChunks = 0, lightBytes = 0, uniformLight = 0;
+            if (storageSampledAt < 0.0 || ImGui::GetTime() - storageSampledAt >= 0.5)
+            {
+                storageSampledAt = ImGui::GetTime();
+                blockBytes = uniformChunks = lightBytes = uniformLight = 0;
+                chunkManager->forEachChunk([&](Chunk* chunk)
+                {
+                    blockBytes += chunk->blocks.memoryUsage();
+                    if (chunk->blocks.isUniform())
+                        uniformChunks++;
+                    lightBytes += chunk->skyLight.memoryUsage();
+                    if (chunk->skyLight.isUniform())
+                        uniformLight++;
+                });
+            }
+            ImGui::Text("Block storage: %.1f KiB (%zu uniform)", blockBytes / 1024.0, uniformChunks);
+            ImGui::Text("Light storage: %.1f KiB (%zu uniform)", lightBytes / 1024.0, uniformLight);
+            ImGui::Text("Chunk pool: %zu / %zu", chunkManager->chunkPool.inUse(), chunkManager->chunkPool.capacity());
+            ImGui::Text("Chunks loading: %zu", chunkManager->loadingCount());
+            ImGui::Text("Chunks meshing: %zu (%zu queued)", chunkManager->meshingCount(),
+                        chunkManager->meshQueueSize());
+            ImGui::Text("Light jobs in flight: %zu", chunkManager->lightJobsInFlight);
+            ImGui::Text("Saved light  reused:%zu  stale:%zu",
+                        chunkManager->lightLoadedFromDisk, chunkManager->storedLightRejected);
+            ImGui::Text("Mesh results  applied:%zu  stale dropped:%zu",
+                        chunkManager->meshResultsApplied, chunkManager->meshResultsDropped);
+            ImGui::Text("Chunks meshed  once:%zu  twice:%zu  3+:%zu", tally.meshedOnce, tally.meshedTwice, tally.meshedMore);
             ImGui::Text("Jobs pending: %zu", jobSystem->pendingJobCount());
             ImGui::Text("Frustum solid  tested:%d  culled:%d  drawn:%d", frustumSolidTested, frustumSolidCulled, frustumSolidDrawn);
             ImGui::Text("Frustum water  tested:%d  culled:%d  drawn:%d", frustumWaterTested, frustumWaterCulled, frustumWaterDrawn);
+            ImGui::Text("Solid quads  drawn:%d  backface culled:%d", solidQuadsDrawn, solidQuadsBackfaceCulled);
+            ImGui::Text("Chunks by LOD  1x:%d  2x:%d  4x:%d  8x:%d",
+                        lodChunksDrawn[0], lodChunksDrawn[1], lodChunksDrawn[2], lodChunksDrawn[3]);
+            ImGui::Text("Horizon tiles drawn: %d", horizonTilesDrawn);
+            ImGui::Text("Light volumes refreshed: %d", lightVolumesRefreshed);
 
             ImGui::EndTabItem();
         }
 
         if (ImGui::BeginTabItem("Settings"))
         {
-            ImGui::SliderInt("Render Distance", &renderDistance, 2, 16);
+            ImGui::SliderInt("Render Distance", &renderDistance, 2, MAX_RENDER_DISTANCE);
+            ImGui::Checkbox("Mesh LOD", &enableMeshLod);
+            if (enableMeshLod)
+            {
+                ImGui::SliderInt("LOD 2x from", &meshLodRings[0], 1, MAX_RENDER_DISTANCE);
+                ImGui::SliderInt("LOD 4x from", &meshLodRings[1], meshLodRings[0], MAX_RENDER_DISTANCE);
+                ImGui::SliderInt("LOD 8x from", &meshLodRings[2], meshLodRings[1], MAX_RENDER_DISTANCE);
+            }
+            ImGui::Checkbox("Horizon", &enableHorizon);
+            if (enableHorizon)
+                ImGui::SliderInt("Horizon Distance", &horizonDistance, 8, MAX_HORIZON_DISTANCE);
 
             ImGui::Separator();
             ImGui::Checkbox("Wireframe mode", &wireframeMode);
             ImGui::Checkbox("Biome Debug Colors", &showBiomeDebugColors);
             ImGui::Checkbox("Noclip mode", &player.noclip);
             ImGui::Checkbox("Async Loading", &useAsyncLoading);
+            bool bitmaskMesher = opaqueMesher() == OpaqueMesher::Binary;
+            if (ImGui::Checkbox("Bitmask Mesher", &bitmaskMesher))
+                setOpaqueMesher(bitmaskMesher ? OpaqueMesher::Binary : OpaqueMesher::Greedy);
+            bool lightVolume = meshLighting() == MeshLighting::Volume;
+            if (ImGui::Checkbox("Light Volume", &lightVolume))
+            {
+                // Quads built for one mode don't carry what the other reads.
+                setMeshLighting(lightVolume ? MeshLighting::Volume : MeshLighting::Baked);
+                chunkManager->forEachChunk([&](Chunk* chunk)
+                {
+                    if (chunk->isPlaceholder())
+                        return;
+                    chunk->markMeshDirty();
+                    chunkManager->queueMesh(chunk);
+                });
+            }
             ImGui::SliderFloat("Move Speed", &cameraSpeed, 0.0f, 60.0f);
 
             ImGui::Separator();
@@ -237,7 +237,7 @@ MenuResult drawSettings(int fbWidth, int fbHeight, GameState returnState)
     ImGui::Separator();
 
     ImGui::Text("GRAPHICS");
-    ImGui::SliderInt("Render Distance", &renderDistance, 2, 16);
+    ImGui::SliderInt("Render Distance", &renderDistance, 2, MAX_RENDER_DISTANCE);
     ImGui::SliderFloat("FOV", &fov, 50.0f, 120.0f, "%.0f");
     ImGui::InputInt("Max FPS", &targetFps);
     if (targetFps < 10) targetFps = 10;
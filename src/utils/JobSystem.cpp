@@ -2,6 +2,7 @@
 #include "../world/ChunkManager.h"
 #include "../world/TerrainGenerator.h"
 #include "../world/CaveGenerator.h"
+#include "../world/SkyLight.h"
 #include <cstring>
 #include <algorithm>
 
@@ -54,9 +55,6 @@ std::unique_ptr<MeshChunkJob> JobSystem::acquireMeshJob()
         auto job = std::move(meshJobPool.back());
         meshJobPool.pop_back();
         job->cx = job->cy = job->cz = 0;
-        job->hasNeighborPosX = job->hasNeighborNegX = false;
-        job->hasNeighborPosY = job->hasNeighborNegY = false;
-        job->hasNeighborPosZ = job->hasNeighborNegZ = false;
         return job;
     }
     return std::make_unique<MeshChunkJob>();
@@ -67,12 +65,82 @@ void JobSystem::releaseMeshJob(std::unique_ptr<MeshChunkJob> job)
     // Clear result vectors but keep their allocated capacity so buildGreedyMesh
     // won't re-reserve on the next use of this job.
     job->vertices.clear();
-    job->indices.clear();
     job->waterVertices.clear();
-    job->waterIndices.clear();
     meshJobPool.push_back(std::move(job));
 }
 
+std::unique_ptr<GenerateChunkJob> JobSystem::acquireGenerateJob()
+{
+    if (!generateJobPool.empty())
+    {
+        auto job = std::move(generateJobPool.back());
+        generateJobPool.pop_back();
+        return job;
+    }
+    return std::make_unique<GenerateChunkJob>();
+}
+
+void JobSystem::releaseGenerateJob(std::unique_ptr<GenerateChunkJob> job)
+{
+    // Returns the chunk to its pool if ChunkManager didn't adopt it.
+    job->chunk.reset();
+    job->cx = job->cy = job->cz = 0;
+    job->loadedFromDisk = false;
+    generateJobPool.push_back(std::move(job));
+}
+
+std::unique_ptr<SaveChunkJob> JobSystem::acquireSaveJob()
+{
+    if (!saveJobPool.empty())
+    {
+        auto job = std::move(saveJobPool.back());
+        saveJobPool.pop_back();
+        return job;
+    }
+    return std::make_unique<SaveChunkJob>();
+}
+
+void JobSystem::releaseSaveJob(std::unique_ptr<SaveChunkJob> job)
+{
+    job->cx = job->cy = job->cz = 0;
+    saveJobPool.push_back(std::move(job));
+}
+
+std::unique_ptr<HorizonTileJob> JobSystem::acquireHorizonJob()
+{
+    if (!horizonJobPool.empty())
+    {
+        auto job = std::move(horizonJobPool.back());
+        horizonJobPool.pop_back();
+        return job;
+    }
+    return std::make_unique<HorizonTileJob>();
+}
+
+void JobSystem::releaseHorizonJob(std::unique_ptr<HorizonTileJob> job)
+{
+    job->cx = job->cy = job->cz = 0;
+    job->vertices.clear();
+    horizonJobPool.push_back(std::move(job));
+}
+
+std::unique_ptr<LightChunkJob> JobSystem::acquireLightJob()
+{
+    if (!lightJobPool.empty())
+    {
+        auto job = std::move(lightJobPool.back());
+        lightJobPool.pop_back();
+        return job;
+    }
+    return std::make_unique<LightChunkJob>();
+}
+
+void JobSystem::releaseLightJob(std::unique_ptr<LightChunkJob> job)
+{
+    job->cx = job->cy = job->cz = 0;
+    lightJobPool.push_back(std::move(job));
+}
+
 void JobSystem::enqueue(std::unique_ptr<Job> job)
 {
     {
@@ -117,6 +185,22 @@ std::vector<std::unique_ptr<SaveChunkJob>> JobSystem::pollCompletedSaves()
     return result;
 }
 
+std::vector<std::unique_ptr<HorizonTileJob>> JobSystem::pollCompletedHorizonTiles()
+{
+    std::lock_guard<std::mutex> lock(horizonMutex);
+    std::vector<std::unique_ptr<HorizonTileJob>> result;
+    result.swap(completedHorizonTiles);
+    return result;
+}
+
+std::vector<std::unique_ptr<LightChunkJob>> JobSystem::pollCompletedLights()
+{
+    std::lock_guard<std::mutex> lock(lightsMutex);
+    std::vector<std::unique_ptr<LightChunkJob>> result;
+    result.swap(completedLights);
+    return result;
+}
+
 bool JobSystem::hasCompletedWork()
 {
     // Use atomic pending count as a cheap proxy: if anything completed,
@@ -132,7 +216,15 @@ bool JobSystem::hasCompletedWork()
     }
     {
         std::lock_guard<std::mutex> lock(savesMutex);
-        return !completedSaves.empty();
+        if (!completedSaves.empty()) return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(horizonMutex);
+        if (!completedHorizonTiles.empty()) return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(lightsMutex);
+        return !completedLights.empty();
     }
 }
 
@@ -212,15 +304,38 @@ void JobSystem::processJob(std::unique_ptr<Job> job)
             }
             --pendingCount;
             break;
+
+        case JobType::Horizon:
+            processHorizonJob(static_cast<HorizonTileJob*>(job.get()));
+            {
+                std::lock_guard<std::mutex> lock(horizonMutex);
+                completedHorizonTiles.push_back(
+                    std::unique_ptr<HorizonTileJob>(static_cast<HorizonTileJob*>(job.release()))
+                );
+            }
+            --pendingCount;
+            break;
+
+        case JobType::Light:
+            processLightJob(static_cast<LightChunkJob*>(job.get()));
+            {
+                std::lock_guard<std::mutex> lock(lightsMutex);
+                completedLights.push_back(
+                    std::unique_ptr<LightChunkJob>(static_cast<LightChunkJob*>(job.release()))
+                );
+            }
+            --pendingCount;
+            break;
     }
 }
 
 void JobSystem::processGenerateJob(GenerateChunkJob* job)
 {
   std::fill(std::begin(job->blocks), std::end(job->blocks), 0);
-  std::fill(std::begin(job->skyLight), std::end(job->skyLight), MAX_SKY_LIGHT);
+  job->lightLoaded = false;
 
-  if (regionManager && regionManager->loadChunkData(job->cx, job->cy, job->cz, job->blocks))
+  if (regionManager && regionManager->loadChunkData(job->cx, job->cy, job->cz, job->blocks,
+                                                    &job->light, &job->lightLoaded))
   {
     job->loadedFromDisk = true;
   }
@@ -235,130 +350,72 @@ void JobSystem::processGenerateJob(GenerateChunkJob* job)
     // Carve caves only on freshly generated chunks (not on loaded/saved ones)
     applyCavesToBlocks(job->blocks, glm::ivec3(job->cx, job->cy, job->cz), DEFAULT_WORLD_SEED, terrainHeights);
   }
+
+  Chunk* c = job->chunk.get();
+  c->kind = classifySection(job->blocks);
+  if (c->isPlaceholder())
+    c->blocks.fill(job->blocks[0]);
+  else
+    c->blocks.assign(job->blocks);
+
+  // Placeholders keep a uniform light: none inside solid rock, so a cell
+  // dug out of one starts dark.
+  if (c->kind == SectionKind::SolidInterior)
+    c->skyLight.fill(0);
+  if (c->isPlaceholder())
+    job->lightLoaded = false;
+  else if (job->lightLoaded)
+    c->skyLight.assign(job->light.light);
 }
 
 void JobSystem::processMeshJob(MeshChunkJob* job)
 {
-    auto getBlock = [job](int x, int y, int z) -> BlockID
-    {
-        if (x >= 0 && x < CHUNK_SIZE &&
-            y >= 0 && y < CHUNK_SIZE &&
-            z >= 0 && z < CHUNK_SIZE)
-        {
-            return job->blocks[blockIndex(x, y, z)];
-        }
-
-        if (x >= CHUNK_SIZE && job->hasNeighborPosX)
-        {
-            int localY = y;
-            int localZ = z;
-            if (localY >= 0 && localY < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE)
-                return job->neighborPosX[localY * CHUNK_SIZE + localZ];
-        }
-        if (x < 0 && job->hasNeighborNegX)
-        {
-            int localY = y;
-            int localZ = z;
-            if (localY >= 0 && localY < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE)
-                return job->neighborNegX[localY * CHUNK_SIZE + localZ];
-        }
-        if (y >= CHUNK_SIZE && job->hasNeighborPosY)
-        {
-            int localX = x;
-            int localZ = z;
-            if (localX >= 0 && localX < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE)
-                return job->neighborPosY[localX * CHUNK_SIZE + localZ];
-        }
-        if (y < 0 && job->hasNeighborNegY)
-        {
-            int localX = x;
-            int localZ = z;
-            if (localX >= 0 && localX < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE)
-                return job->neighborNegY[localX * CHUNK_SIZE + localZ];
-        }
-        if (z >= CHUNK_SIZE && job->hasNeighborPosZ)
-        {
-            int localX = x;
-            int localY = y;
-            if (localX >= 0 && localX < CHUNK_SIZE && localY >= 0 && localY < CHUNK_SIZE)
-                return job->neighborPosZ[localX * CHUNK_SIZE + localY];
-        }
-        if (z < 0 && job->hasNeighborNegZ)
-        {
-            int localX = x;
-            int localY = y;
-            if (localX >= 0 && localX < CHUNK_SIZE && localY >= 0 && localY < CHUNK_SIZE)
-                return job->neighborNegZ[localX * CHUNK_SIZE + localY];
-        }
+    fillMeshInput(job->input, job->sections);
+    job->sections.reset();
 
-        return 0;
-    };
+    glm::ivec3 chunkWorldOrigin(job->cx * CHUNK_SIZE, job->cy * CHUNK_SIZE, job->cz * CHUNK_SIZE);
+    if (job->slices.partial())
+        buildChunkMeshSlices(job->input, job->slices, chunkWorldOrigin,
+                             job->vertices, job->faceRanges, job->waterVertices, job->waterFaceRanges);
+    else
+        buildChunkMeshAtLod(job->input, job->lod, chunkWorldOrigin,
+                            job->vertices, job->faceRanges, job->waterVertices, job->waterFaceRanges);
+}
 
-    auto getSkyLight = [job](int x, int y, int z) -> uint8_t
+void JobSystem::processSaveJob(SaveChunkJob* job)
+{
+    if (regionManager)
     {
-        if (x >= 0 && x < CHUNK_SIZE &&
-            y >= 0 && y < CHUNK_SIZE &&
-            z >= 0 && z < CHUNK_SIZE)
-        {
-            return job->skyLight[blockIndex(x, y, z)];
-        }
-
-        if (x >= CHUNK_SIZE && job->hasNeighborPosX)
-        {
-            int localY = y;
-            int localZ = z;
-            if (localY >= 0 && localY < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE)
-                return job->skyLightPosX[localY * CHUNK_SIZE + localZ];
-        }
-        if (x < 0 && job->hasNeighborNegX)
-        {
-            int localY = y;
-            int localZ = z;
-            if (localY >= 0 && localY < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE)
-                return job->skyLightNegX[localY * CHUNK_SIZE + localZ];
-        }
-        if (y >= CHUNK_SIZE && job->hasNeighborPosY)
+        BlockID blocks[CHUNK_VOLUME];
+        job->section->blocks.copyTo(blocks);
+        if (job->saveLight)
         {
-            int localX = x;
-            int localZ = z;
-            if (localX >= 0 && localX < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE)
-                return job->skyLightPosY[localX * CHUNK_SIZE + localZ];
+            SectionLight light;
+            job->section->skyLight.copyTo(light.light);
+            std::copy(std::begin(job->lightBorders), std::end(job->lightBorders), light.borderHashes);
+            regionManager->saveChunkData(job->cx, job->cy, job->cz, blocks, &light);
         }
-        if (y < 0 && job->hasNeighborNegY)
+        else
         {
-            int localX = x;
-            int localZ = z;
-            if (localX >= 0 && localX < CHUNK_SIZE && localZ >= 0 && localZ < CHUNK_SIZE)
-                return job->skyLightNegY[localX * CHUNK_SIZE + localZ];
+            regionManager->saveChunkData(job->cx, job->cy, job->cz, blocks);
         }
-        if (z >= CHUNK_SIZE && job->hasNeighborPosZ)
-        {
-            int localX = x;
-            int localY = y;
-            if (localX >= 0 && localX < CHUNK_SIZE && localY >= 0 && localY < CHUNK_SIZE)
-                return job->skyLightPosZ[localX * CHUNK_SIZE + localY];
-        }
-        if (z < 0 && job->hasNeighborNegZ)
-        {
-            int localX = x;
-            int localY = y;
-            if (localX >= 0 && localX < CHUNK_SIZE && localY >= 0 && localY < CHUNK_SIZE)
-                return job->skyLightNegZ[localX * CHUNK_SIZE + localY];
-        }
-
-        return MAX_SKY_LIGHT;
-    };
+    }
+    job->section.reset();
+}
 
-    glm::ivec3 chunkWorldOrigin(job->cx * CHUNK_SIZE, job->cy * CHUNK_SIZE, job->cz * CHUNK_SIZE);
-    buildChunkMeshOffThread(job->blocks, job->skyLight, chunkWorldOrigin, getBlock, getSkyLight, 
-                             job->vertices, job->indices,
-                             job->waterVertices, job->waterIndices);
+void JobSystem::processHorizonJob(HorizonTileJob* job)
+{
+    buildHorizonTile(job->cx, job->cz, job->vertices);
 }
 
-void JobSystem::processSaveJob(SaveChunkJob* job)
+void JobSystem::processLightJob(LightChunkJob* job)
 {
-    if (regionManager)
-    {
-        regionManager->saveChunkData(job->cx, job->cy, job->cz, job->blocks);
-    }
+    const SectionSnapshot* neighbors[6];
+    for (int i = 0; i < 6; i++)
+        neighbors[i] = job->neighbors[i].get();
+    computeSkyLight(*job->section, neighbors, job->light, job->hasSkyFloor ? job->skyFloor : nullptr);
+
+    job->section.reset();
+    for (auto& n : job->neighbors)
+        n.reset();
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "../world/Chunk.h"
+#include "../world/ChunkPool.h"
 #include "../rendering/Meshing.h"
+#include "../rendering/Horizon.h"
 #include "../world/RegionManager.h"
 #include <atomic>
 #include <condition_variable>
@@ -15,7 +17,9 @@ enum class JobType
 {
     Generate,
     Mesh,
-    Save
+    Save,
+    Horizon,
+    Light
 };
 
 struct Job
@@ -28,9 +32,14 @@ struct Job
 
 struct GenerateChunkJob : Job
 {
+    // Scratch for the generator; the result is packed straight into chunk,
+    // a pooled body that ChunkManager adopts as-is on completion.
     BlockID blocks[CHUNK_VOLUME];
-    uint8_t skyLight[CHUNK_VOLUME];
+    ChunkPool::Handle chunk;
     bool loadedFromDisk;
+    // Light saved with the section, already in chunk's skyLight when set.
+    SectionLight light;
+    bool lightLoaded = false;
 
     GenerateChunkJob()
     {
@@ -41,42 +50,38 @@ struct GenerateChunkJob : Job
 
 struct MeshChunkJob : Job
 {
-    BlockID blocks[CHUNK_VOLUME];
-    BlockID neighborPosX[CHUNK_SIZE * CHUNK_SIZE];
-    BlockID neighborNegX[CHUNK_SIZE * CHUNK_SIZE];
-    BlockID neighborPosY[CHUNK_SIZE * CHUNK_SIZE];
-    BlockID neighborNegY[CHUNK_SIZE * CHUNK_SIZE];
-    BlockID neighborPosZ[CHUNK_SIZE * CHUNK_SIZE];
-    BlockID neighborNegZ[CHUNK_SIZE * CHUNK_SIZE];
-    bool hasNeighborPosX, hasNeighborNegX;
-    bool hasNeighborPosY, hasNeighborNegY;
-    bool hasNeighborPosZ, hasNeighborNegZ;
-
-    uint8_t skyLight[CHUNK_VOLUME];
-    uint8_t skyLightPosX[CHUNK_SIZE * CHUNK_SIZE];
-    uint8_t skyLightNegX[CHUNK_SIZE * CHUNK_SIZE];
-    uint8_t skyLightPosY[CHUNK_SIZE * CHUNK_SIZE];
-    uint8_t skyLightNegY[CHUNK_SIZE * CHUNK_SIZE];
-    uint8_t skyLightPosZ[CHUNK_SIZE * CHUNK_SIZE];
-    uint8_t skyLightNegZ[CHUNK_SIZE * CHUNK_SIZE];
-
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
-    std::vector<Vertex> waterVertices;
-    std::vector<uint32_t> waterIndices;
+    // Gathered on the main thread; the worker expands them into input and
+    // lets go of them before meshing.
+    MeshSections sections;
+    MeshInput input;
+    uint8_t lod = 0;
+    // Partial: only these slices are meshed, as a patch for the chunk's
+    // current mesh. Otherwise the whole chunk is.
+    DirtySlices slices;
+    // Chunk::meshVersion when the input was captured.
+    uint32_t version = 0;
+    // Chunk::lightVersion likewise; input.lightVolume is set at enqueue too.
+    uint32_t lightVersion = 0;
+
+    // Quads only; drawn through the shared quad index buffer.
+    std::vector<PackedVertex> vertices;
+    FaceRanges faceRanges;
+    std::vector<PackedVertex> waterVertices;
+    FaceRanges waterFaceRanges;
 
     MeshChunkJob()
     {
         type = JobType::Mesh;
-        hasNeighborPosX = hasNeighborNegX = false;
-        hasNeighborPosY = hasNeighborNegY = false;
-        hasNeighborPosZ = hasNeighborNegZ = false;
     }
 };
 
 struct SaveChunkJob : Job
 {
-    BlockID blocks[CHUNK_VOLUME];
+    std::shared_ptr<const SectionSnapshot> section;
+    // Whether the section's light is saved too, and the borders it was
+    // computed against (see ChunkManager::collectLightForSave).
+    bool saveLight = false;
+    uint32_t lightBorders[6];
 
     SaveChunkJob()
     {
@@ -84,6 +89,36 @@ struct SaveChunkJob : Job
     }
 };
 
+struct LightChunkJob : Job
+{
+    // The section and its lit face neighbours (see gatherLightNeighbors);
+    // released by the worker once the light is computed.
+    std::shared_ptr<const SectionSnapshot> section;
+    LightNeighbors neighbors;
+    // The column heightmap for the section (see ChunkColumn::skyFloor).
+    uint8_t skyFloor[CHUNK_SIZE * CHUNK_SIZE];
+    bool hasSkyFloor = false;
+    uint32_t ticket = 0;
+
+    uint8_t light[CHUNK_VOLUME];
+
+    LightChunkJob()
+    {
+        type = JobType::Light;
+    }
+};
+
+// cx and cz are horizon tile coordinates; cy is unused.
+struct HorizonTileJob : Job
+{
+    std::vector<HorizonVertex> vertices;
+
+    HorizonTileJob()
+    {
+        type = JobType::Horizon;
+    }
+};
+
 struct ChunkManager;
 
 class JobSystem
@@ -106,10 +141,20 @@ public:
     // Both methods must be called from the main thread only.
     std::unique_ptr<MeshChunkJob> acquireMeshJob();
     void releaseMeshJob(std::unique_ptr<MeshChunkJob> job);
+    std::unique_ptr<GenerateChunkJob> acquireGenerateJob();
+    void releaseGenerateJob(std::unique_ptr<GenerateChunkJob> job);
+    std::unique_ptr<SaveChunkJob> acquireSaveJob();
+    void releaseSaveJob(std::unique_ptr<SaveChunkJob> job);
+    std::unique_ptr<HorizonTileJob> acquireHorizonJob();
+    void releaseHorizonJob(std::unique_ptr<HorizonTileJob> job);
+    std::unique_ptr<LightChunkJob> acquireLightJob();
+    void releaseLightJob(std::unique_ptr<LightChunkJob> job);
 
     std::vector<std::unique_ptr<GenerateChunkJob>> pollCompletedGenerations();
     std::vector<std::unique_ptr<MeshChunkJob>> pollCompletedMeshes();
     std::vector<std::unique_ptr<SaveChunkJob>> pollCompletedSaves();
+    std::vector<std::unique_ptr<HorizonTileJob>> pollCompletedHorizonTiles();
+    std::vector<std::unique_ptr<LightChunkJob>> pollCompletedLights();
 
     bool hasCompletedWork();
     size_t pendingJobCount() const;  // lock-free via atomic
@@ -125,11 +170,15 @@ private:
     std::vector<std::unique_ptr<GenerateChunkJob>> completedGenerations;
     std::vector<std::unique_ptr<MeshChunkJob>> completedMeshes;
     std::vector<std::unique_ptr<SaveChunkJob>> completedSaves;
+    std::vector<std::unique_ptr<HorizonTileJob>> completedHorizonTiles;
+    std::vector<std::unique_ptr<LightChunkJob>> completedLights;
     // One mutex per result queue so workers finishing different job types
     // never block each other when pushing results.
     std::mutex generationsMutex;
     std::mutex meshesMutex;
     std::mutex savesMutex;
+    std::mutex horizonMutex;
+    std::mutex lightsMutex;
     // Atomically-tracked pending count removes the need to lock queueMutex
     // every frame just to read the queue sizes.
     std::atomic<size_t> pendingCount{0};
@@ -138,11 +187,17 @@ private:
     ChunkManager* chunkManager;
 
     std::vector<std::unique_ptr<MeshChunkJob>> meshJobPool;
+    std::vector<std::unique_ptr<GenerateChunkJob>> generateJobPool;
+    std::vector<std::unique_ptr<SaveChunkJob>> saveJobPool;
+    std::vector<std::unique_ptr<HorizonTileJob>> horizonJobPool;
+    std::vector<std::unique_ptr<LightChunkJob>> lightJobPool;
 
     void workerLoop();
     void processJob(std::unique_ptr<Job> job);
     void processGenerateJob(GenerateChunkJob* job);
     void processMeshJob(MeshChunkJob* job);
     void processSaveJob(SaveChunkJob* job);
+    void processHorizonJob(HorizonTileJob* job);
+    void processLightJob(LightChunkJob* job);
 };
 
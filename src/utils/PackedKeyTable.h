@@ -0,0 +1,205 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Packs a coordinate into a 64-bit Morton key: each axis is biased into 21
+// unsigned bits and the bits are interleaved x/y/z, so neighbouring
+// coordinates produce nearby keys. Valid for components in [-2^20, 2^20).
+namespace packed_key_detail {
+
+constexpr int COORD_BITS = 21;
+constexpr int64_t COORD_BIAS = int64_t(1) << (COORD_BITS - 1);
+
+inline uint64_t spreadBits(uint64_t v)
+{
+    v &= 0x1fffff;
+    v = (v | v << 32) & 0x1f00000000ffffull;
+    v = (v | v << 16) & 0x1f0000ff0000ffull;
+    v = (v | v << 8)  & 0x100f00f00f00f00full;
+    v = (v | v << 4)  & 0x10c30c30c30c30c3ull;
+    v = (v | v << 2)  & 0x1249249249249249ull;
+    return v;
+}
+
+inline uint64_t compactBits(uint64_t v)
+{
+    v &= 0x1249249249249249ull;
+    v = (v ^ (v >> 2))  & 0x10c30c30c30c30c3ull;
+    v = (v ^ (v >> 4))  & 0x100f00f00f00f00full;
+    v = (v ^ (v >> 8))  & 0x1f0000ff0000ffull;
+    v = (v ^ (v >> 16)) & 0x1f00000000ffffull;
+    v = (v ^ (v >> 32)) & 0x1fffffull;
+    return v;
+}
+
+}
+
+inline uint64_t packCoordKey(int x, int y, int z)
+{
+    using namespace packed_key_detail;
+    return spreadBits(static_cast<uint64_t>(x + COORD_BIAS)) |
+           (spreadBits(static_cast<uint64_t>(y + COORD_BIAS)) << 1) |
+           (spreadBits(static_cast<uint64_t>(z + COORD_BIAS)) << 2);
+}
+
+inline glm::ivec3 unpackCoordKey(uint64_t key)
+{
+    using namespace packed_key_detail;
+    return glm::ivec3(
+        static_cast<int>(static_cast<int64_t>(compactBits(key)) - COORD_BIAS),
+        static_cast<int>(static_cast<int64_t>(compactBits(key >> 1)) - COORD_BIAS),
+        static_cast<int>(static_cast<int64_t>(compactBits(key >> 2)) - COORD_BIAS));
+}
+
+// Open-addressing hash table keyed by packCoordKey() values. Linear probing
+// over a power-of-two slot array kept at most half full, with backward-shift
+// deletion so there are no tombstones. Value pointers are invalidated by any
+// insert or erase.
+template <typename Value>
+class PackedKeyTable
+{
+public:
+    // Packed keys only use the low 63 bits, so all-ones never collides.
+    static constexpr uint64_t EMPTY_KEY = ~uint64_t(0);
+
+    struct Slot
+    {
+        uint64_t key = EMPTY_KEY;
+        Value value{};
+    };
+
+    class iterator
+    {
+    public:
+        iterator(Slot* slot, Slot* end) : slot(slot), end(end) { skipEmpty(); }
+        Slot& operator*() const { return *slot; }
+        Slot* operator->() const { return slot; }
+        iterator& operator++() { ++slot; skipEmpty(); return *this; }
+        bool operator!=(const iterator& other) const { return slot != other.slot; }
+
+    private:
+        Slot* slot;
+        Slot* end;
+        void skipEmpty() { while (slot != end && slot->key == EMPTY_KEY) ++slot; }
+    };
+
+    iterator begin() { return iterator(slots.data(), slots.data() + slots.size()); }
+    iterator end() { return iterator(slots.data() + slots.size(), slots.data() + slots.size()); }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Value* find(uint64_t key)
+    {
+        if (slots.empty())
+            return nullptr;
+        for (size_t i = home(key);; i = (i + 1) & mask)
+        {
+            if (slots[i].key == key)
+                return &slots[i].value;
+            if (slots[i].key == EMPTY_KEY)
+                return nullptr;
+        }
+    }
+
+    const Value* find(uint64_t key) const
+    {
+        return const_cast<PackedKeyTable*>(this)->find(key);
+    }
+
+    bool contains(uint64_t key) const { return find(key) != nullptr; }
+
+    // Returns the value for key, default-constructing it if absent; the bool
+    // is true when a new entry was created.
+    std::pair<Value*, bool> emplace(uint64_t key)
+    {
+        if ((count + 1) * 2 > slots.size())
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+
+        for (size_t i = home(key);; i = (i + 1) & mask)
+        {
+            if (slots[i].key == key)
+                return {&slots[i].value, false};
+            if (slots[i].key == EMPTY_KEY)
+            {
+                slots[i].key = key;
+                count++;
+                return {&slots[i].value, true};
+            }
+        }
+    }
+
+    bool erase(uint64_t key)
+    {
+        if (slots.empty())
+            return false;
+
+        size_t i = home(key);
+        while (slots[i].key != key)
+        {
+            if (slots[i].key == EMPTY_KEY)
+                return false;
+            i = (i + 1) & mask;
+        }
+
+        // Shift later members of the probe run back over the hole.
+        size_t hole = i;
+        for (size_t j = (hole + 1) & mask; slots[j].key != EMPTY_KEY; j = (j + 1) & mask)
+        {
+            const size_t want = home(slots[j].key);
+            const bool movable = (hole <= j) ? (want <= hole || want > j)
+                                             : (want <= hole && want > j);
+            if (movable)
+            {
+                slots[hole].key = slots[j].key;
+                slots[hole].value = std::move(slots[j].value);
+                hole = j;
+            }
+        }
+        slots[hole].key = EMPTY_KEY;
+        slots[hole].value = Value{};
+        count--;
+        return true;
+    }
+
+    void clear()
+    {
+        slots.clear();
+        mask = 0;
+        count = 0;
+    }
+
+private:
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    size_t count = 0;
+    int shift = 64;
+
+    size_t home(uint64_t key) const
+    {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    void rehash(size_t capacity)
+    {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.resize(capacity);
+        mask = capacity - 1;
+        shift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1)
+            shift--;
+        count = 0;
+
+        for (Slot& s : old)
+        {
+            if (s.key == EMPTY_KEY)
+                continue;
+            Value* v = emplace(s.key).first;
+            *v = std::move(s.value);
+        }
+    }
+};
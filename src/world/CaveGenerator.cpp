@@ -243,5 +243,8 @@ void applyCavesToBlocks(BlockID* blocks, const glm::ivec3& chunkPos, uint32_t wo
 void applyCavesToChunk(Chunk& c, uint32_t worldSeed, const int* terrainHeights, 
                        const CaveConfig& cfg, bool* outVegetationMask)
 {
-  applyCavesToBlocks(c.blocks, c.position, worldSeed, terrainHeights, cfg, outVegetationMask);
+  BlockID blocks[CHUNK_VOLUME];
+  c.blocks.copyTo(blocks);
+  applyCavesToBlocks(blocks, c.position, worldSeed, terrainHeights, cfg, outVegetationMask);
+  c.blocks.assign(blocks);
 }
@@ -1,5 +1,7 @@
 #include "Chunk.h"
+#include "../utils/BlockTypes.h"
 #include <algorithm>
+#include <iterator>
 
 const glm::ivec3 DIRS[6] = {
     {1, 0, 0},
@@ -10,25 +12,96 @@ const glm::ivec3 DIRS[6] = {
     {0, 0, -1}
 };
 
+SectionKind classifySection(const BlockID* blocks)
+{
+  const BlockID first = blocks[0];
+  for (int i = 1; i < CHUNK_VOLUME; i++)
+  {
+    if (blocks[i] != first)
+      return SectionKind::Mixed;
+  }
+
+  if (first == 0)
+    return SectionKind::Empty;
+  return isBlockTransparent(first) ? SectionKind::Mixed : SectionKind::SolidInterior;
+}
+
 Chunk::Chunk()
-    : position(0)
+    : position(0), skyLight(MAX_SKY_LIGHT)
 {
-  std::fill(std::begin(blocks), std::end(blocks), 0);
-  std::fill(std::begin(skyLight), std::end(skyLight), MAX_SKY_LIGHT);
 }
 
 Chunk::~Chunk()
+{
+  releaseGpuBuffers();
+}
+
+void Chunk::releaseGpuBuffers()
 {
   if (vao)
     glDeleteVertexArrays(1, &vao);
   if (vbo)
     glDeleteBuffers(1, &vbo);
-  if (ebo)
-    glDeleteBuffers(1, &ebo);
   if (waterVao)
     glDeleteVertexArrays(1, &waterVao);
   if (waterVbo)
     glDeleteBuffers(1, &waterVbo);
-  if (waterEbo)
-    glDeleteBuffers(1, &waterEbo);
+  if (lightTex)
+    glDeleteTextures(1, &lightTex);
+
+  vao = vbo = 0;
+  waterVao = waterVbo = 0;
+  indexCount = vertexCount = 0;
+  faceRanges = FaceRanges();
+  meshLod = 0;
+  waterIndexCount = waterVertexCount = 0;
+  waterFaceRanges = FaceRanges();
+  lightTex = 0;
+  meshLightVolume = false;
+  lightVolumeDirty = false;
+}
+
+void Chunk::reset()
+{
+  releaseGpuBuffers();
+  position = glm::ivec3(0);
+  blocks.fill(0);
+  skyLight.fill(MAX_SKY_LIGHT);
+  kind = SectionKind::Mixed;
+  dirtyMesh = true;
+  dirtyLight = true;
+  lightReady = false;
+  lightJobPending = false;
+  std::fill(std::begin(lightBorders), std::end(lightBorders), 0u);
+  lightUnchecked = 0;
+  lightOnDisk = false;
+  diskLightRevision = 0;
+  dirtySlices = DirtySlices();
+  cachedSnapshot.reset();
+  meshVersion = 0;
+  lightVersion = 0;
+  staleMeshDrops = 0;
+  meshWaitFrames = 0;
+  meshBuilds = 0;
+  meshQueueBucket = -1;
+  meshQueueSlot = 0;
+  dirtyData = false;
+  wantedLod = 0;
+}
+
+std::shared_ptr<const SectionSnapshot> Chunk::snapshot()
+{
+  if (cachedSnapshot && snapshotBlocksRevision == blocks.revision() &&
+      snapshotLightRevision == skyLight.revision())
+    return cachedSnapshot;
+
+  // A new allocation rather than an overwrite: a worker may still be
+  // reading the old one.
+  auto copy = std::make_shared<SectionSnapshot>();
+  copy->blocks = blocks;
+  copy->skyLight = skyLight;
+  cachedSnapshot = std::move(copy);
+  snapshotBlocksRevision = blocks.revision();
+  snapshotLightRevision = skyLight.revision();
+  return cachedSnapshot;
 }
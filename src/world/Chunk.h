@@ -1,33 +1,178 @@
 #pragma once
+#include <algorithm>
 #include <cstdint>
 #include <glm/glm.hpp>
 #include <glad/glad.h>
-
-using BlockID = uint8_t;
-constexpr int CHUNK_SIZE = 16;
-constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+#include "ChunkStorage.h"
 
 constexpr uint8_t MAX_SKY_LIGHT = 15;
 
+// Empty (all air) and SolidInterior (a single opaque block) sections are kept
+// as placeholders: uniform storage, no GL objects and no mesh job. They become
+// Mixed once an edit or a neighbor opening up a face means they need a mesh.
+enum class SectionKind : uint8_t
+{
+  Empty,
+  SolidInterior,
+  Mixed
+};
+
+SectionKind classifySection(const BlockID* blocks);
+
+// The opaque mesh is sorted by face direction (FaceDir order); direction d
+// covers quads [start[d], start[d + 1]) so the renderer can skip directions
+// that face away from the camera. Within a direction quads are sorted by
+// slice along its axis, slice s starting at sliceStart[d][s], so single
+// slices can be swapped out after an edit.
+struct FaceRanges
+{
+  uint32_t start[7] = {};
+  uint32_t sliceStart[6][CHUNK_SIZE] = {};
+
+  uint32_t quadCount(int dir) const { return start[dir + 1] - start[dir]; }
+  uint32_t sliceEnd(int dir, int slice) const
+  {
+    return slice + 1 < CHUNK_SIZE ? sliceStart[dir][slice + 1] : start[dir + 1];
+  }
+};
+
+// Slices whose faces need meshing again, per axis: direction d must redo
+// slices lo[d / 2]..hi[d / 2]. A block's faces depend on its six
+// neighbours, so an edit dirties the slice it is in and the ones on either
+// side. `all` stands for anything else that invalidates the whole mesh.
+struct DirtySlices
+{
+  int8_t lo[3] = {CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE};
+  int8_t hi[3] = {-1, -1, -1};
+  bool all = true;
+
+  void markAll() { all = true; }
+  void markBox(const glm::ivec3& min, const glm::ivec3& max)
+  {
+    for (int a = 0; a < 3; a++)
+    {
+      lo[a] = static_cast<int8_t>(std::max(std::min<int>(lo[a], min[a] - 1), 0));
+      hi[a] = static_cast<int8_t>(std::min(std::max<int>(hi[a], max[a] + 1), CHUNK_SIZE - 1));
+    }
+  }
+  void clear() { *this = DirtySlices(); all = false; }
+  void merge(const DirtySlices& other)
+  {
+    all = all || other.all;
+    for (int a = 0; a < 3; a++)
+    {
+      lo[a] = std::min(lo[a], other.lo[a]);
+      hi[a] = std::max(hi[a], other.hi[a]);
+    }
+  }
+
+  bool any() const { return all || lo[0] <= hi[0]; }
+  bool partial() const { return !all && lo[0] <= hi[0]; }
+};
+
 struct Chunk
 {
   Chunk();
   ~Chunk();
 
+  // Returns the chunk to its freshly constructed state (GL objects deleted,
+  // storage uniform) so ChunkPool can hand it out again.
+  void reset();
+  void releaseGpuBuffers();
+
   glm::ivec3 position;
-  BlockID blocks[CHUNK_VOLUME];
-  uint8_t skyLight[CHUNK_VOLUME];
+  BlockStorage blocks;
+  LightStorage skyLight;
+  SectionKind kind = SectionKind::Mixed;
+
+  bool isPlaceholder() const { return kind != SectionKind::Mixed; }
+  // Solid interiors hold no light whatever surrounds them, so they are lit
+  // from the start and never relit.
+  bool hasFixedLight() const { return kind == SectionKind::SolidInterior; }
+
+  BlockID getBlock(int x, int y, int z) const;
+  void setBlock(int x, int y, int z, BlockID id);
+
+  // The section's blocks and light as a shared immutable copy, for jobs.
+  // Calls return the same copy until blocks or light are written; jobs
+  // still holding an older one keep it alive, so the section is only copied
+  // again after it has changed.
+  std::shared_ptr<const SectionSnapshot> snapshot();
+  std::shared_ptr<const SectionSnapshot> cachedSnapshot;
+  uint32_t snapshotBlocksRevision = 0;
+  uint32_t snapshotLightRevision = 0;
 
   bool dirtyMesh = true;
   bool dirtyLight = true;
+  // Set once skyLight has been computed; until then it is a full-light
+  // placeholder that neighbours must not take light from. A Light job for
+  // the chunk is in flight while lightJobPending is set; its result is
+  // only applied if it carries the current lightTicket.
+  bool lightReady = false;
+  bool lightJobPending = false;
+  uint32_t lightTicket = 0;
+  // Light read from disk, or kept after a neighbour unloaded, only holds
+  // while each neighbour shows the border it was computed against. For the
+  // faces in lightUnchecked, lightBorders has that border's lightBorderHash;
+  // it is compared once the neighbour is lit.
+  uint32_t lightBorders[6] = {};
+  uint8_t lightUnchecked = 0;
+  // Whether skyLight is on disk as of diskLightRevision.
+  bool lightOnDisk = false;
+  uint32_t diskLightRevision = 0;
+  DirtySlices dirtySlices;
+  // Bumped on every change that invalidates the mesh; mesh jobs carry the
+  // value they were built from so stale results can be told apart.
+  uint32_t meshVersion = 0;
+  uint8_t staleMeshDrops = 0;
+  // Frames spent dirty waiting on neighbours, and meshes built since load.
+  uint16_t meshWaitFrames = 0;
+  uint16_t meshBuilds = 0;
+  // Where ChunkManager's mesh queue holds this chunk; bucket -1 if it doesn't.
+  int32_t meshQueueBucket = -1;
+  uint32_t meshQueueSlot = 0;
   bool dirtyData = false;
-  GLuint vao = 0, vbo = 0, ebo = 0;
+  GLuint vao = 0, vbo = 0;
   uint32_t indexCount = 0;
   uint32_t vertexCount = 0;
+  FaceRanges faceRanges;
+  // Mesh LOD (see downsampleMeshInput) the renderer wants for this chunk,
+  // and the one its current mesh was built at.
+  uint8_t wantedLod = 0;
+  uint8_t meshLod = 0;
 
-  GLuint waterVao = 0, waterVbo = 0, waterEbo = 0;
+  GLuint waterVao = 0, waterVbo = 0;
   uint32_t waterIndexCount = 0;
   uint32_t waterVertexCount = 0;
+  FaceRanges waterFaceRanges;
+
+  // Set when the current meshes leave light out and the shaders read it from
+  // lightTex, the padded MeshInput::skyLight of the section. Light changes
+  // then only refresh the texture: lightVolumeDirty asks the renderer to,
+  // and lightVersion counts them so a mesh result built on older light can
+  // be told apart.
+  bool meshLightVolume = false;
+  bool lightVolumeDirty = false;
+  uint32_t lightVersion = 0;
+  GLuint lightTex = 0;
+
+  // Every remesh goes through these so the mesher knows how much to redo.
+  void markMeshDirty()
+  {
+    dirtyMesh = true;
+    dirtySlices.markAll();
+    meshVersion++;
+  }
+  void markBlockDirty(int x, int y, int z)
+  {
+    markBoxDirty(glm::ivec3(x, y, z), glm::ivec3(x, y, z));
+  }
+  void markBoxDirty(const glm::ivec3& min, const glm::ivec3& max)
+  {
+    dirtyMesh = true;
+    dirtySlices.markBox(min, max);
+    meshVersion++;
+  }
 };
 
 extern const glm::ivec3 DIRS[6];
@@ -36,3 +181,15 @@ inline int blockIndex(int x, int y, int z)
 {
   return x + CHUNK_SIZE * (y + CHUNK_SIZE * z);
 }
+
+inline BlockID Chunk::getBlock(int x, int y, int z) const
+{
+  return blocks.get(blockIndex(x, y, z));
+}
+
+inline void Chunk::setBlock(int x, int y, int z, BlockID id)
+{
+  blocks.set(blockIndex(x, y, z), id);
+  if (!blocks.isUniform())
+    kind = SectionKind::Mixed;
+}
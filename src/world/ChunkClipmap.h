@@ -0,0 +1,139 @@
+#pragma once
+#include "Chunk.h"
+#include <vector>
+
+// Player-centred window of chunk pointers for O(1) lookups. The window spans
+// [center - radius, center + radius] horizontally and [minY, maxY] vertically;
+// slots are addressed toroidally (coordinate mod width), so moving the centre
+// by one chunk only rewrites the slab of slots that entered the window. The
+// window doesn't own anything: ChunkManager keeps the chunk map as the owner
+// and as the fallback for coordinates outside the window.
+class ChunkClipmap
+{
+public:
+    // Resizes and recentres from scratch; every slot comes from fill(x, y, z).
+    template <typename Fill>
+    void reset(int radius, int minY, int maxY, int centerX, int centerZ, Fill&& fill);
+
+    // Moves the window, refilling only the columns that entered it.
+    template <typename Fill>
+    void recenter(int centerX, int centerZ, Fill&& fill);
+
+    void clear() { slots.assign(slots.size(), nullptr); }
+
+    bool configured() const { return width > 0; }
+    int radius() const { return windowRadius; }
+    int centerX() const { return windowCenterX; }
+    int centerZ() const { return windowCenterZ; }
+
+    bool contains(int cx, int cy, int cz) const
+    {
+        return width > 0 &&
+               cx >= windowCenterX - windowRadius && cx <= windowCenterX + windowRadius &&
+               cz >= windowCenterZ - windowRadius && cz <= windowCenterZ + windowRadius &&
+               cy >= minY && cy < minY + height;
+    }
+
+    // Only meaningful when contains() is true; an empty slot means the chunk
+    // is not resident.
+    Chunk* get(int cx, int cy, int cz) const { return slots[slotIndex(cx, cy, cz)]; }
+
+    void set(int cx, int cy, int cz, Chunk* chunk)
+    {
+        if (contains(cx, cy, cz))
+            slots[slotIndex(cx, cy, cz)] = chunk;
+    }
+
+private:
+    int width = 0;
+    int height = 0;
+    int minY = 0;
+    int windowRadius = 0;
+    int windowCenterX = 0;
+    int windowCenterZ = 0;
+    std::vector<Chunk*> slots;
+
+    static int wrap(int v, int n)
+    {
+        int m = v % n;
+        return m < 0 ? m + n : m;
+    }
+
+    int slotIndex(int cx, int cy, int cz) const
+    {
+        return (wrap(cz, width) * height + (cy - minY)) * width + wrap(cx, width);
+    }
+
+    template <typename Fill>
+    void fillColumn(int cx, int cz, Fill& fill)
+    {
+        for (int cy = minY; cy < minY + height; cy++)
+            slots[slotIndex(cx, cy, cz)] = fill(cx, cy, cz);
+    }
+};
+
+template <typename Fill>
+void ChunkClipmap::reset(int radius, int minYIn, int maxY, int centerX, int centerZ, Fill&& fill)
+{
+    windowRadius = radius;
+    width = 2 * radius + 1;
+    minY = minYIn;
+    height = maxY - minYIn + 1;
+    windowCenterX = centerX;
+    windowCenterZ = centerZ;
+    slots.assign(static_cast<size_t>(width) * width * height, nullptr);
+
+    for (int cz = centerZ - radius; cz <= centerZ + radius; cz++)
+        for (int cx = centerX - radius; cx <= centerX + radius; cx++)
+            fillColumn(cx, cz, fill);
+}
+
+template <typename Fill>
+void ChunkClipmap::recenter(int centerX, int centerZ, Fill&& fill)
+{
+    const int dx = centerX - windowCenterX;
+    const int dz = centerZ - windowCenterZ;
+    if (dx == 0 && dz == 0)
+        return;
+
+    if (dx >= width || -dx >= width || dz >= width || -dz >= width)
+    {
+        reset(windowRadius, minY, minY + height - 1, centerX, centerZ, fill);
+        return;
+    }
+
+    const int oldCenterX = windowCenterX;
+    windowCenterX = centerX;
+    windowCenterZ = centerZ;
+
+    // Columns leaving the window share slots with the ones entering it, so
+    // overwriting the entering columns also evicts the stale ones.
+    int enteredMinX = 0, enteredMaxX = -1;
+    if (dx > 0)
+    {
+        enteredMinX = oldCenterX + windowRadius + 1;
+        enteredMaxX = centerX + windowRadius;
+    }
+    else if (dx < 0)
+    {
+        enteredMinX = centerX - windowRadius;
+        enteredMaxX = oldCenterX - windowRadius - 1;
+    }
+    for (int cx = enteredMinX; cx <= enteredMaxX; cx++)
+        for (int cz = centerZ - windowRadius; cz <= centerZ + windowRadius; cz++)
+            fillColumn(cx, cz, fill);
+
+    if (dz != 0)
+    {
+        const int oldCenterZ = centerZ - dz;
+        const int minZ = dz > 0 ? oldCenterZ + windowRadius + 1 : centerZ - windowRadius;
+        const int maxZ = dz > 0 ? centerZ + windowRadius : oldCenterZ - windowRadius - 1;
+        for (int cz = minZ; cz <= maxZ; cz++)
+            for (int cx = centerX - windowRadius; cx <= centerX + windowRadius; cx++)
+            {
+                if (cx >= enteredMinX && cx <= enteredMaxX)
+                    continue;
+                fillColumn(cx, cz, fill);
+            }
+    }
+}
@@ -0,0 +1,106 @@
+#include "ChunkColumn.h"
+#include "Chunk.h"
+#include "../utils/BlockTypes.h"
+#include <algorithm>
+
+void ChunkColumn::setSection(int cy, const BlockStorage* blocks)
+{
+  if (cy < 0 || cy >= COLUMN_SECTIONS)
+    return;
+  sections[cy] = blocks;
+
+  if (!blocks || blocks->isUniform())
+  {
+    BlockID id = blocks ? blocks->uniformBlock() : 0;
+    std::fill(sectionOpaque[cy], sectionOpaque[cy] + COLUMN_AREA,
+              static_cast<uint8_t>(id != 0 && !isBlockTransparent(id) ? CHUNK_SIZE : 0));
+    std::fill(sectionTop[cy], sectionTop[cy] + COLUMN_AREA, static_cast<uint8_t>(id != 0 ? CHUNK_SIZE : 0));
+  }
+  else
+  {
+    for (int z = 0; z < CHUNK_SIZE; z++)
+      for (int x = 0; x < CHUNK_SIZE; x++)
+        scanCell(cy, x, z, CHUNK_SIZE - 1);
+  }
+  for (int i = 0; i < COLUMN_AREA; i++)
+    refreshHeights(i);
+}
+
+bool ChunkColumn::empty() const
+{
+  return std::none_of(sections, sections + COLUMN_SECTIONS, [](const BlockStorage* s) { return s != nullptr; });
+}
+
+void ChunkColumn::blockChanged(int x, int wy, int z)
+{
+  const int cy = wy / CHUNK_SIZE;
+  if (wy < 0 || cy >= COLUMN_SECTIONS || !sections[cy])
+    return;
+  const int i = columnIndex(x, z);
+  const int ly = wy - cy * CHUNK_SIZE;
+  const BlockID id = sections[cy]->get(blockIndex(x, ly, z));
+  const uint8_t above = static_cast<uint8_t>(ly + 1);
+
+  if (id != 0)
+  {
+    sectionTop[cy][i] = std::max(sectionTop[cy][i], above);
+    topHeights[i] = std::max<uint16_t>(topHeights[i], static_cast<uint16_t>(wy + 1));
+    if (!isBlockTransparent(id))
+    {
+      sectionOpaque[cy][i] = std::max(sectionOpaque[cy][i], above);
+      opaqueHeights[i] = std::max<uint16_t>(opaqueHeights[i], static_cast<uint16_t>(wy + 1));
+      return;
+    }
+  }
+  // Only losing a section's top block moves its heights down.
+  if (sectionTop[cy][i] > above && sectionOpaque[cy][i] > above)
+    return;
+  scanCell(cy, x, z, ly);
+  refreshHeights(i);
+}
+
+void ChunkColumn::skyFloor(int cy, uint8_t* out) const
+{
+  const int base = cy * CHUNK_SIZE;
+  for (int i = 0; i < COLUMN_AREA; i++)
+    out[i] = static_cast<uint8_t>(std::clamp(topHeights[i] - base, 0, CHUNK_SIZE));
+}
+
+// Walks down from fromY to the section's highest opaque and highest block;
+// cached values above fromY are kept.
+void ChunkColumn::scanCell(int cy, int x, int z, int fromY)
+{
+  const int i = columnIndex(x, z);
+  uint8_t& opaque = sectionOpaque[cy][i];
+  uint8_t& top = sectionTop[cy][i];
+  if (opaque <= fromY + 1)
+    opaque = 0;
+  if (top <= fromY + 1)
+    top = 0;
+  for (int y = fromY; y >= 0 && opaque == 0; y--)
+  {
+    BlockID id = sections[cy]->get(blockIndex(x, y, z));
+    if (id == 0)
+      continue;
+    if (top == 0)
+      top = static_cast<uint8_t>(y + 1);
+    if (!isBlockTransparent(id))
+      opaque = static_cast<uint8_t>(y + 1);
+  }
+}
+
+void ChunkColumn::refreshHeights(int i)
+{
+  opaqueHeights[i] = 0;
+  topHeights[i] = 0;
+  for (int cy = COLUMN_SECTIONS - 1; cy >= 0; cy--)
+  {
+    if (topHeights[i] == 0 && sectionTop[cy][i] != 0)
+      topHeights[i] = static_cast<uint16_t>(cy * CHUNK_SIZE + sectionTop[cy][i]);
+    if (sectionOpaque[cy][i] != 0)
+    {
+      opaqueHeights[i] = static_cast<uint16_t>(cy * CHUNK_SIZE + sectionOpaque[cy][i]);
+      break;
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "ChunkStorage.h"
+#include <cstdint>
+
+// Sections in a column, covering world y 0-255.
+constexpr int COLUMN_SECTIONS = 16;
+constexpr int COLUMN_HEIGHT = COLUMN_SECTIONS * CHUNK_SIZE;
+constexpr int COLUMN_AREA = CHUNK_SIZE * CHUNK_SIZE;
+
+inline int columnIndex(int x, int z)
+{
+  return x + CHUNK_SIZE * z;
+}
+
+// The resident sections stacked over one chunk (x, z), with two heightmaps
+// kept up to date as sections come and go and blocks change: the highest
+// opaque block and the highest block of any kind. Heights are world y + 1 of
+// that block, 0 when the column has none, and only count resident sections,
+// so light computed from them must be redone when a section lands higher up.
+class ChunkColumn
+{
+public:
+  // Points section cy at the blocks of a resident chunk; null removes it.
+  // The storage must stay put until it is removed again.
+  void setSection(int cy, const BlockStorage* blocks);
+  const BlockStorage* section(int cy) const { return sections[cy]; }
+  bool empty() const;
+
+  // Call after the block at local (x, z) and world height wy has changed.
+  // Placing raises the heights in O(1); clearing the top block rescans one
+  // section's cells under it and the other sections' cached tops.
+  void blockChanged(int x, int wy, int z);
+
+  int opaqueHeight(int x, int z) const { return opaqueHeights[columnIndex(x, z)]; }
+  int topHeight(int x, int z) const { return topHeights[columnIndex(x, z)]; }
+
+  // For section cy: the local y from which every cell up to the top of the
+  // world is air, CHUNK_SIZE where the section isn't open to the sky at all.
+  void skyFloor(int cy, uint8_t* out) const;
+
+private:
+  const BlockStorage* sections[COLUMN_SECTIONS] = {};
+  // Per section, local y + 1 of its highest opaque and highest block.
+  uint8_t sectionOpaque[COLUMN_SECTIONS][COLUMN_AREA] = {};
+  uint8_t sectionTop[COLUMN_SECTIONS][COLUMN_AREA] = {};
+  uint16_t opaqueHeights[COLUMN_AREA] = {};
+  uint16_t topHeights[COLUMN_AREA] = {};
+
+  void scanCell(int cy, int x, int z, int fromY);
+  void refreshHeights(int i);
+};
@@ -2,78 +2,195 @@
 #include "../utils/JobSystem.h"
 #include "RegionManager.h"
 #include "../rendering/Meshing.h"
+#include "SkyLight.h"
 #include "TerrainGenerator.h"
 #include "CaveGenerator.h"
+#include "../utils/BlockTypes.h"
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 
+// Stale mesh results a chunk may drop in a row before one is taken anyway.
+constexpr uint8_t MAX_STALE_MESH_DROPS = 4;
+
 bool ChunkManager::hasChunk(int cx, int cy, int cz)
 {
-  return chunks.find(ChunkCoord(cx, cy, cz)) != chunks.end();
+  return getChunk(cx, cy, cz) != nullptr;
 }
 
-bool ChunkManager::isLoading(int cx, int cy, int cz) const
+ChunkState ChunkManager::stateOf(int cx, int cy, int cz) const
 {
-  return loadingChunks.find(ChunkCoord(cx, cy, cz)) != loadingChunks.end();
+  const ChunkEntry* entry = entries.find(packCoordKey(cx, cy, cz));
+  return entry ? entry->state : ChunkState::Absent;
 }
 
-bool ChunkManager::isMeshing(int cx, int cy, int cz) const
+void ChunkManager::setEntryState(ChunkEntry* entry, ChunkState state)
 {
-  return meshingChunks.find(ChunkCoord(cx, cy, cz)) != meshingChunks.end();
+  if (entry->state == ChunkState::Loading)
+    loadingChunks--;
+  else if (entry->state == ChunkState::Meshing)
+    meshingChunks--;
+  entry->state = state;
+  if (state == ChunkState::Loading)
+    loadingChunks++;
+  else if (state == ChunkState::Meshing)
+    meshingChunks++;
 }
 
-bool ChunkManager::isSaving(int cx, int cy, int cz) const
+void ChunkManager::eraseEntry(uint64_t key, ChunkEntry* entry)
 {
-  return savingChunks.find(ChunkCoord(cx, cy, cz)) != savingChunks.end();
+  setEntryState(entry, ChunkState::Absent);
+  entries.erase(key);
+}
+
+void ChunkManager::clear()
+{
+  meshBuckets.clear();
+  meshQueued = 0;
+  entries.clear();
+  loadingChunks = 0;
+  meshingChunks = 0;
+  columns.clear();
+  residentChunks = 0;
+  tally = SectionTally();
+  clipmap.clear();
+  meshResultsApplied = 0;
+  meshResultsDropped = 0;
+  lightJobsInFlight = 0;
+  lightLoadedFromDisk = 0;
+  storedLightRejected = 0;
 }
 
 Chunk *ChunkManager::getChunk(int cx, int cy, int cz)
 {
-  auto it = chunks.find(ChunkCoord(cx, cy, cz));
-  if (it == chunks.end())
-    return nullptr;
-  return it->second.get();
+  if (clipmap.contains(cx, cy, cz))
+    return clipmap.get(cx, cy, cz);
+  return findInTable(cx, cy, cz);
+}
+
+ChunkColumn* ChunkManager::getColumn(int cx, int cz)
+{
+  std::unique_ptr<ChunkColumn>* column = columns.find(packCoordKey(cx, 0, cz));
+  return column ? column->get() : nullptr;
+}
+
+int ChunkManager::surfaceHeight(int wx, int wz)
+{
+  glm::ivec3 cp = worldToChunk(wx, 0, wz);
+  glm::ivec3 local = worldToLocal(wx, 0, wz);
+  ChunkColumn* column = getColumn(cp.x, cp.z);
+  return column ? column->topHeight(local.x, local.z) : -1;
+}
+
+void ChunkManager::attachToColumn(Chunk* chunk)
+{
+  std::unique_ptr<ChunkColumn>& column = *columns.emplace(packCoordKey(chunk->position.x, 0, chunk->position.z)).first;
+  if (!column)
+    column = std::make_unique<ChunkColumn>();
+  uint16_t before[COLUMN_AREA];
+  for (int z = 0; z < CHUNK_SIZE; z++)
+    for (int x = 0; x < CHUNK_SIZE; x++)
+      before[columnIndex(x, z)] = static_cast<uint16_t>(column->topHeight(x, z));
+  column->setSection(chunk->position.y, &chunk->blocks);
+
+  // Sections below that were lit before this one arrived took the columns
+  // it now covers for open sky. Light straight from disk was computed with
+  // the whole column there and is checked across borders instead.
+  int lowest = chunk->position.y;
+  for (int z = 0; z < CHUNK_SIZE; z++)
+    for (int x = 0; x < CHUNK_SIZE; x++)
+      if (column->topHeight(x, z) > before[columnIndex(x, z)])
+        lowest = std::min(lowest, before[columnIndex(x, z)] / CHUNK_SIZE);
+  for (int cy = lowest; cy < chunk->position.y; cy++)
+  {
+    Chunk* below = getChunk(chunk->position.x, cy, chunk->position.z);
+    // A first light still running read the old heights too.
+    if (!below || (!below->lightReady && !below->lightJobPending) || below->hasFixedLight())
+      continue;
+    if (below->lightOnDisk && below->skyLight.revision() == below->diskLightRevision)
+      continue;
+    below->dirtyLight = true;
+    queueMesh(below);
+  }
+}
+
+void ChunkManager::detachFromColumn(int cx, int cy, int cz)
+{
+  const uint64_t key = packCoordKey(cx, 0, cz);
+  std::unique_ptr<ChunkColumn>* column = columns.find(key);
+  if (!column)
+    return;
+  (*column)->setSection(cy, nullptr);
+  if ((*column)->empty())
+    columns.erase(key);
+}
+
+Chunk *ChunkManager::findInTable(int cx, int cy, int cz)
+{
+  ChunkEntry* entry = entries.find(packCoordKey(cx, cy, cz));
+  return entry ? entry->chunk.get() : nullptr;
+}
+
+void ChunkManager::setViewCenter(int cx, int cz, int radius, int minY, int maxY)
+{
+  auto fill = [this](int x, int y, int z) { return findInTable(x, y, z); };
+  if (!clipmap.configured() || clipmap.radius() != radius)
+    clipmap.reset(radius, minY, maxY, cx, cz, fill);
+  else
+    clipmap.recenter(cx, cz, fill);
 }
 
 Chunk *ChunkManager::loadChunk(int cx, int cy, int cz)
 {
-  ChunkCoord key(cx, cy, cz);
-  if (savingChunks.count(key) > 0)
+  ChunkEntry* entry = entries.emplace(packCoordKey(cx, cy, cz)).first;
+  if (entry->state == ChunkState::Saving)
     return nullptr;
 
-  if (hasChunk(cx, cy, cz))
-    return getChunk(cx, cy, cz);
+  if (entry->chunk)
+    return entry->chunk.get();
 
-  auto [it, inserted] = chunks.emplace(key, std::make_unique<Chunk>());
-  (void)inserted;
-  Chunk *c = it->second.get();
+  setEntryState(entry, ChunkState::Resident);
+  entry->chunk = chunkPool.acquire();
+  residentChunks++;
+  Chunk *c = entry->chunk.get();
   c->position = {cx, cy, cz};
+  clipmap.set(cx, cy, cz, c);
 
-  glGenVertexArrays(1, &c->vao);
-  glGenBuffers(1, &c->vbo);
-  glGenBuffers(1, &c->ebo);
-
+  BlockID blocks[CHUNK_VOLUME];
+  SectionLight light;
   bool loadedFromDisk = false;
+  bool lightLoaded = false;
   if (regionManager)
   {
-    loadedFromDisk = regionManager->loadChunkData(cx, cy, cz, c->blocks);
+    loadedFromDisk = regionManager->loadChunkData(cx, cy, cz, blocks, &light, &lightLoaded);
   }
 
   if (!loadedFromDisk)
   {
-    generateTerrain(c->blocks, cx, cy, cz);
-    
     int terrainHeights[CHUNK_SIZE * CHUNK_SIZE];
-    getTerrainHeightsForChunk(cx, cz, terrainHeights);
-    applyCavesToChunk(*c, DEFAULT_WORLD_SEED, terrainHeights);
+    generateTerrain(blocks, cx, cy, cz, terrainHeights);
+    applyCavesToBlocks(blocks, c->position, DEFAULT_WORLD_SEED, terrainHeights);
   }
-
-  for (int i = 0; i < 6; i++)
+  c->kind = classifySection(blocks);
+  if (c->isPlaceholder())
+    c->blocks.fill(blocks[0]);
+  else
+    c->blocks.assign(blocks);
+  if (c->kind == SectionKind::SolidInterior)
+    c->skyLight.fill(0);
+  tallySection(c, 1);
+  attachToColumn(c);
+  c->dirtyMesh = c->kind != SectionKind::Empty;
+  c->lightReady = c->hasFixedLight();
+  c->dirtyLight = !c->lightReady;
+  if (c->dirtyMesh || c->dirtyLight)
+    queueMesh(c);
+  markNeighborsDirty(cx, cy, cz);
+  relightBelow(c);
+  if (lightLoaded && !c->isPlaceholder())
   {
-    Chunk* neighbor = getChunk(cx + DIRS[i].x, cy + DIRS[i].y, cz + DIRS[i].z);
-    if (neighbor != nullptr)
-    {
-      neighbor->dirtyMesh = true;
-    }
+    c->skyLight.assign(light.light);
+    adoptStoredLight(c, light);
   }
 
   return c;
@@ -81,16 +198,27 @@ Chunk *ChunkManager::loadChunk(int cx, int cy, int cz)
 
 void ChunkManager::unloadChunk(int cx, int cy, int cz)
 {
-  ChunkCoord key(cx, cy, cz);
-  auto it = chunks.find(key);
+  const uint64_t key = packCoordKey(cx, cy, cz);
+  ChunkEntry* entry = entries.find(key);
 
-  if (it != chunks.end())
+  if (entry && entry->chunk)
   {
-    if (regionManager && it->second->dirtyData)
+    Chunk* chunk = entry->chunk.get();
+    dequeueMesh(chunk);
+    if (regionManager && needsSave(chunk))
     {
-      regionManager->saveChunkData(cx, cy, cz, it->second->blocks);
+      BlockID blocks[CHUNK_VOLUME];
+      chunk->blocks.copyTo(blocks);
+      SectionLight light;
+      bool withLight = collectLightForSave(chunk, light);
+      regionManager->saveChunkData(cx, cy, cz, blocks, withLight ? &light : nullptr);
     }
-    chunks.erase(it);
+    rememberLightBorders(chunk);
+    clipmap.set(cx, cy, cz, nullptr);
+    detachFromColumn(cx, cy, cz);
+    tallySection(chunk, -1);
+    eraseEntry(key, entry);
+    residentChunks--;
   }
 }
 
@@ -102,48 +230,58 @@ void ChunkManager::enqueueLoadChunk(int cx, int cy, int cz)
     return;
   }
 
-  ChunkCoord key(cx, cy, cz);
-  if (hasChunk(cx, cy, cz) || loadingChunks.count(key) > 0 || savingChunks.count(key) > 0)
+  auto [entry, inserted] = entries.emplace(packCoordKey(cx, cy, cz));
+  if (!inserted)
     return;
 
-  loadingChunks.insert(key);
+  setEntryState(entry, ChunkState::Loading);
 
-  auto job = std::make_unique<GenerateChunkJob>();
+  auto job = jobSystem->acquireGenerateJob();
   job->cx = cx;
   job->cy = cy;
   job->cz = cz;
+  job->chunk = chunkPool.acquire();
+  job->chunk->position = {cx, cy, cz};
 
   jobSystem->enqueue(std::move(job));
 }
 
 void ChunkManager::enqueueSaveAndUnload(int cx, int cy, int cz)
 {
-  ChunkCoord key(cx, cy, cz);
-  
-  if (!hasChunk(cx, cy, cz))
+  const uint64_t key = packCoordKey(cx, cy, cz);
+  ChunkEntry* entry = entries.find(key);
+  if (!entry || !entry->chunk)
     return;
 
-  if (savingChunks.count(key) > 0)
-    return;
+  Chunk* chunk = entry->chunk.get();
+  dequeueMesh(chunk);
+  rememberLightBorders(chunk);
+  clipmap.set(cx, cy, cz, nullptr);
+  detachFromColumn(cx, cy, cz);
+  tallySection(chunk, -1);
+  residentChunks--;
 
-  Chunk* chunk = getChunk(cx, cy, cz);
-  if (!chunk)
-    return;
-
-  if (jobSystem && regionManager && chunk->dirtyData)
+  if (jobSystem && regionManager && needsSave(chunk))
   {
-    savingChunks.insert(key);
+    // The entry stays behind in Saving so the coordinate can't be reloaded
+    // from disk before the save lands; any in-flight mesh result is dropped.
+    setEntryState(entry, ChunkState::Saving);
 
-    auto job = std::make_unique<SaveChunkJob>();
+    auto job = jobSystem->acquireSaveJob();
     job->cx = cx;
     job->cy = cy;
     job->cz = cz;
-    std::memcpy(job->blocks, chunk->blocks, CHUNK_VOLUME * sizeof(BlockID));
+    job->section = chunk->snapshot();
+    SectionLight light;
+    job->saveLight = collectLightForSave(chunk, light);
+    std::copy(std::begin(light.borderHashes), std::end(light.borderHashes), job->lightBorders);
 
     jobSystem->enqueueHighPriority(std::move(job));
+    entry->chunk.reset();
+    return;
   }
 
-  chunks.erase(key);
+  eraseEntry(key, entry);
 }
 
 void ChunkManager::enqueueMeshChunk(int cx, int cy, int cz)
@@ -151,150 +289,153 @@ void ChunkManager::enqueueMeshChunk(int cx, int cy, int cz)
   if (!jobSystem)
     return;
 
-  ChunkCoord key(cx, cy, cz);
-  if (meshingChunks.count(key) > 0)
-    return;
-
-  Chunk* chunk = getChunk(cx, cy, cz);
-  if (!chunk)
+  ChunkEntry* entry = entries.find(packCoordKey(cx, cy, cz));
+  if (!entry || entry->state != ChunkState::Resident)
     return;
 
-  meshingChunks.insert(key);
+  setEntryState(entry, ChunkState::Meshing);
+  Chunk* chunk = entry->chunk.get();
 
   auto job = jobSystem->acquireMeshJob();
   job->cx = cx;
   job->cy = cy;
   job->cz = cz;
-  std::memcpy(job->blocks, chunk->blocks, CHUNK_VOLUME * sizeof(BlockID));
-
-  Chunk* neighborPosX = getChunk(cx + 1, cy, cz);
-  Chunk* neighborNegX = getChunk(cx - 1, cy, cz);
-  Chunk* neighborPosY = getChunk(cx, cy + 1, cz);
-  Chunk* neighborNegY = getChunk(cx, cy - 1, cz);
-  Chunk* neighborPosZ = getChunk(cx, cy, cz + 1);
-  Chunk* neighborNegZ = getChunk(cx, cy, cz - 1);
-
-  if (neighborPosX)
-  {
-    job->hasNeighborPosX = true;
-    copyNeighborFace(job->neighborPosX, neighborPosX, 0);
-  }
-  if (neighborNegX)
-  {
-    job->hasNeighborNegX = true;
-    copyNeighborFace(job->neighborNegX, neighborNegX, 1);
-  }
-  if (neighborPosY)
-  {
-    job->hasNeighborPosY = true;
-    copyNeighborFace(job->neighborPosY, neighborPosY, 2);
-  }
-  if (neighborNegY)
-  {
-    job->hasNeighborNegY = true;
-    copyNeighborFace(job->neighborNegY, neighborNegY, 3);
-  }
-  if (neighborPosZ)
-  {
-    job->hasNeighborPosZ = true;
-    copyNeighborFace(job->neighborPosZ, neighborPosZ, 4);
-  }
-  if (neighborNegZ)
-  {
-    job->hasNeighborNegZ = true;
-    copyNeighborFace(job->neighborNegZ, neighborNegZ, 5);
-  }
-
-  std::memcpy(job->skyLight, chunk->skyLight, CHUNK_VOLUME * sizeof(uint8_t));
-
-  if (neighborPosX)
-    copyNeighborSkyLightFace(job->skyLightPosX, neighborPosX, 0);
-  if (neighborNegX)
-    copyNeighborSkyLightFace(job->skyLightNegX, neighborNegX, 1);
-  if (neighborPosY)
-    copyNeighborSkyLightFace(job->skyLightPosY, neighborPosY, 2);
-  if (neighborNegY)
-    copyNeighborSkyLightFace(job->skyLightNegY, neighborNegY, 3);
-  if (neighborPosZ)
-    copyNeighborSkyLightFace(job->skyLightPosZ, neighborPosZ, 4);
-  if (neighborNegZ)
-    copyNeighborSkyLightFace(job->skyLightNegZ, neighborNegZ, 5);
+  gatherMeshSections(job->sections, *chunk, *this);
+  job->lod = chunk->wantedLod;
+  job->version = chunk->meshVersion;
+  job->lightVersion = chunk->lightVersion;
+  job->input.lightVolume = meshLighting() == MeshLighting::Volume && job->lod == 0;
+  job->slices = chunk->dirtySlices;
+  if (!canRemeshSlices(*chunk))
+    job->slices.markAll();
+  chunk->dirtySlices.clear();
 
   jobSystem->enqueue(std::move(job));
 }
 
 void ChunkManager::copyNeighborFace(BlockID* dest, Chunk* neighbor, int face)
 {
+  if (neighbor->blocks.isUniform())
+  {
+    std::memset(dest, neighbor->blocks.uniformBlock(), CHUNK_SIZE * CHUNK_SIZE * sizeof(BlockID));
+    return;
+  }
+
   switch (face)
   {
     case 0:
       for (int y = 0; y < CHUNK_SIZE; y++)
         for (int z = 0; z < CHUNK_SIZE; z++)
-          dest[y * CHUNK_SIZE + z] = neighbor->blocks[blockIndex(0, y, z)];
+          dest[y * CHUNK_SIZE + z] = neighbor->blocks.get(blockIndex(0, y, z));
       break;
     case 1:
       for (int y = 0; y < CHUNK_SIZE; y++)
         for (int z = 0; z < CHUNK_SIZE; z++)
-          dest[y * CHUNK_SIZE + z] = neighbor->blocks[blockIndex(CHUNK_SIZE - 1, y, z)];
+          dest[y * CHUNK_SIZE + z] = neighbor->blocks.get(blockIndex(CHUNK_SIZE - 1, y, z));
       break;
     case 2:
       for (int x = 0; x < CHUNK_SIZE; x++)
         for (int z = 0; z < CHUNK_SIZE; z++)
-          dest[x * CHUNK_SIZE + z] = neighbor->blocks[blockIndex(x, 0, z)];
+          dest[x * CHUNK_SIZE + z] = neighbor->blocks.get(blockIndex(x, 0, z));
       break;
     case 3:
       for (int x = 0; x < CHUNK_SIZE; x++)
         for (int z = 0; z < CHUNK_SIZE; z++)
-          dest[x * CHUNK_SIZE + z] = neighbor->blocks[blockIndex(x, CHUNK_SIZE - 1, z)];
+          dest[x * CHUNK_SIZE + z] = neighbor->blocks.get(blockIndex(x, CHUNK_SIZE - 1, z));
       break;
     case 4:
       for (int x = 0; x < CHUNK_SIZE; x++)
         for (int y = 0; y < CHUNK_SIZE; y++)
-          dest[x * CHUNK_SIZE + y] = neighbor->blocks[blockIndex(x, y, 0)];
+          dest[x * CHUNK_SIZE + y] = neighbor->blocks.get(blockIndex(x, y, 0));
       break;
     case 5:
       for (int x = 0; x < CHUNK_SIZE; x++)
         for (int y = 0; y < CHUNK_SIZE; y++)
-          dest[x * CHUNK_SIZE + y] = neighbor->blocks[blockIndex(x, y, CHUNK_SIZE - 1)];
+          dest[x * CHUNK_SIZE + y] = neighbor->blocks.get(blockIndex(x, y, CHUNK_SIZE - 1));
       break;
   }
 }
 
-void ChunkManager::copyNeighborSkyLightFace(uint8_t* dest, Chunk* neighbor, int face)
+bool ChunkManager::isNeighborFaceOpaque(Chunk* neighbor, int face)
 {
-  switch (face)
+  if (neighbor->kind == SectionKind::SolidInterior)
+    return true;
+  if (neighbor->kind == SectionKind::Empty)
+    return false;
+
+  BlockID faceBlocks[CHUNK_SIZE * CHUNK_SIZE];
+  copyNeighborFace(faceBlocks, neighbor, face);
+  for (BlockID id : faceBlocks)
   {
-    case 0:
-      for (int y = 0; y < CHUNK_SIZE; y++)
-        for (int z = 0; z < CHUNK_SIZE; z++)
-          dest[y * CHUNK_SIZE + z] = neighbor->skyLight[blockIndex(0, y, z)];
-      break;
-    case 1:
-      for (int y = 0; y < CHUNK_SIZE; y++)
-        for (int z = 0; z < CHUNK_SIZE; z++)
-          dest[y * CHUNK_SIZE + z] = neighbor->skyLight[blockIndex(CHUNK_SIZE - 1, y, z)];
-      break;
-    case 2:
-      for (int x = 0; x < CHUNK_SIZE; x++)
-        for (int z = 0; z < CHUNK_SIZE; z++)
-          dest[x * CHUNK_SIZE + z] = neighbor->skyLight[blockIndex(x, 0, z)];
-      break;
-    case 3:
-      for (int x = 0; x < CHUNK_SIZE; x++)
-        for (int z = 0; z < CHUNK_SIZE; z++)
-          dest[x * CHUNK_SIZE + z] = neighbor->skyLight[blockIndex(x, CHUNK_SIZE - 1, z)];
-      break;
-    case 4:
-      for (int x = 0; x < CHUNK_SIZE; x++)
-        for (int y = 0; y < CHUNK_SIZE; y++)
-          dest[x * CHUNK_SIZE + y] = neighbor->skyLight[blockIndex(x, y, 0)];
-      break;
-    case 5:
-      for (int x = 0; x < CHUNK_SIZE; x++)
-        for (int y = 0; y < CHUNK_SIZE; y++)
-          dest[x * CHUNK_SIZE + y] = neighbor->skyLight[blockIndex(x, y, CHUNK_SIZE - 1)];
-      break;
+    if (isBlockTransparent(id))
+      return false;
   }
+  return true;
+}
+
+bool ChunkManager::needsMesh(Chunk* chunk)
+{
+  if (!chunk->isPlaceholder())
+    return true;
+
+  if (chunk->kind == SectionKind::SolidInterior)
+  {
+    // A missing neighbor counts as closed: when it arrives it marks this
+    // section dirty again and the check reruns.
+    for (int i = 0; i < 6; i++)
+    {
+      Chunk* neighbor = getChunk(chunk->position.x + DIRS[i].x,
+                                 chunk->position.y + DIRS[i].y,
+                                 chunk->position.z + DIRS[i].z);
+      if (neighbor && !isNeighborFaceOpaque(neighbor, i))
+      {
+        // Its light is already right: solid placeholders hold none.
+        tallySection(chunk, -1);
+        chunk->kind = SectionKind::Mixed;
+        tallySection(chunk, 1);
+        return true;
+      }
+    }
+  }
+
+  chunk->dirtyMesh = false;
+  return false;
+}
+
+bool ChunkManager::neighborsSettled(const Chunk* chunk, int centerCX, int centerCZ, int loadRadius, int minY, int maxY) const
+{
+  for (int i = 0; i < 6; i++)
+  {
+    glm::ivec3 n = chunk->position + DIRS[i];
+    if (n.y < minY || n.y > maxY ||
+        std::abs(n.x - centerCX) > loadRadius || std::abs(n.z - centerCZ) > loadRadius)
+      continue;
+
+    ChunkState state = stateOf(n.x, n.y, n.z);
+    if (state == ChunkState::Absent || state == ChunkState::Loading)
+      return false;
+  }
+  return true;
+}
+
+void ChunkManager::tallySection(const Chunk* chunk, int sign)
+{
+  auto add = [sign](size_t& count) { count = sign > 0 ? count + 1 : count - 1; };
+  if (chunk->isPlaceholder())
+    add(tally.placeholders);
+  if (chunk->meshBuilds == 1)
+    add(tally.meshedOnce);
+  else if (chunk->meshBuilds == 2)
+    add(tally.meshedTwice);
+  else if (chunk->meshBuilds > 2)
+    add(tally.meshedMore);
+}
+
+void ChunkManager::countMeshBuild(Chunk* chunk)
+{
+  tallySection(chunk, -1);
+  chunk->meshBuilds++;
+  tallySection(chunk, 1);
 }
 
 void ChunkManager::update()
@@ -306,6 +447,7 @@ void ChunkManager::update()
   for (auto& job : completedGenerations)
   {
     onGenerateComplete(job.get());
+    jobSystem->releaseGenerateJob(std::move(job));
   }
 
   auto completedMeshes = jobSystem->pollCompletedMeshes();
@@ -315,53 +457,557 @@ void ChunkManager::update()
     jobSystem->releaseMeshJob(std::move(job));
   }
 
+  auto completedLights = jobSystem->pollCompletedLights();
+  for (auto& job : completedLights)
+  {
+    onLightComplete(job.get());
+    jobSystem->releaseLightJob(std::move(job));
+  }
+
   auto completedSaves = jobSystem->pollCompletedSaves();
   for (auto& job : completedSaves)
   {
-    savingChunks.erase(ChunkCoord(job->cx, job->cy, job->cz));
+    const uint64_t key = packCoordKey(job->cx, job->cy, job->cz);
+    ChunkEntry* entry = entries.find(key);
+    if (entry && entry->state == ChunkState::Saving)
+      eraseEntry(key, entry);
+    jobSystem->releaseSaveJob(std::move(job));
   }
 }
 
 void ChunkManager::onGenerateComplete(GenerateChunkJob* job)
 {
-  ChunkCoord key(job->cx, job->cy, job->cz);
-  loadingChunks.erase(key);
+  const uint64_t key = packCoordKey(job->cx, job->cy, job->cz);
+  ChunkEntry* entry = entries.find(key);
+  if (!entry || entry->state != ChunkState::Loading)
+    return;
 
-  if (hasChunk(job->cx, job->cy, job->cz))
+  // The player moved on while it generated. Unloading is only checked when
+  // the centre moves, so a chunk landing outside the window would stay.
+  if (clipmap.configured() && !clipmap.contains(job->cx, job->cy, job->cz))
+  {
+    eraseEntry(key, entry);
     return;
+  }
 
-  auto [it, inserted] = chunks.emplace(key, std::make_unique<Chunk>());
-  Chunk* c = it->second.get();
-  c->position = {job->cx, job->cy, job->cz};
+  // The worker already filled the pooled chunk body; just take ownership.
+  // GL objects are created on first upload, so placeholders never get any.
+  setEntryState(entry, ChunkState::Resident);
+  entry->chunk = std::move(job->chunk);
+  residentChunks++;
+  Chunk* c = entry->chunk.get();
+  clipmap.set(job->cx, job->cy, job->cz, c);
+  tallySection(c, 1);
+  attachToColumn(c);
+  c->dirtyMesh = c->kind != SectionKind::Empty;
+  c->lightReady = c->hasFixedLight();
+  c->dirtyLight = !c->lightReady;
+  if (c->dirtyMesh || c->dirtyLight)
+    queueMesh(c);
+  markNeighborsDirty(job->cx, job->cy, job->cz);
+  relightBelow(c);
+  if (job->lightLoaded)
+    adoptStoredLight(c, job->light);
+}
 
-  std::memcpy(c->blocks, job->blocks, CHUNK_VOLUME * sizeof(BlockID));
-  std::memcpy(c->skyLight, job->skyLight, CHUNK_VOLUME * sizeof(uint8_t));
+void ChunkManager::markNeighborsDirty(int cx, int cy, int cz)
+{
+  for (int i = 0; i < 6; i++)
+  {
+    Chunk* neighbor = getChunk(cx + DIRS[i].x, cy + DIRS[i].y, cz + DIRS[i].z);
+    if (neighbor != nullptr)
+    {
+      neighbor->markMeshDirty();
+      queueMesh(neighbor);
+    }
+  }
+}
 
-  glGenVertexArrays(1, &c->vao);
-  glGenBuffers(1, &c->vbo);
-  glGenBuffers(1, &c->ebo);
+void ChunkManager::queueMesh(Chunk* chunk)
+{
+  if (chunk->meshQueueBucket >= 0)
+    return;
 
-  c->dirtyMesh = true;
+  int ring = std::max(std::abs(chunk->position.x - meshCenter.x), std::abs(chunk->position.z - meshCenter.y));
+  if (ring >= static_cast<int>(meshBuckets.size()))
+    meshBuckets.resize(ring + 1);
+  std::vector<Chunk*>& bucket = meshBuckets[ring];
+  chunk->meshQueueBucket = ring;
+  chunk->meshQueueSlot = static_cast<uint32_t>(bucket.size());
+  bucket.push_back(chunk);
+  meshQueued++;
+}
 
-  for (int i = 0; i < 6; i++)
+void ChunkManager::dequeueMesh(Chunk* chunk)
+{
+  if (chunk->meshQueueBucket < 0)
+    return;
+
+  std::vector<Chunk*>& bucket = meshBuckets[chunk->meshQueueBucket];
+  Chunk* last = bucket.back();
+  bucket[chunk->meshQueueSlot] = last;
+  last->meshQueueSlot = chunk->meshQueueSlot;
+  bucket.pop_back();
+  chunk->meshQueueBucket = -1;
+  meshQueued--;
+}
+
+void ChunkManager::setMeshCenter(int cx, int cz)
+{
+  if (meshCenter == glm::ivec2(cx, cz))
+    return;
+
+  meshCenter = glm::ivec2(cx, cz);
+  std::vector<Chunk*> queued;
+  queued.reserve(meshQueued);
+  for (std::vector<Chunk*>& bucket : meshBuckets)
   {
-    Chunk* neighbor = getChunk(job->cx + DIRS[i].x, job->cy + DIRS[i].y, job->cz + DIRS[i].z);
-    if (neighbor != nullptr)
+    for (Chunk* chunk : bucket)
     {
-      neighbor->dirtyMesh = true;
+      chunk->meshQueueBucket = -1;
+      queued.push_back(chunk);
     }
+    bucket.clear();
   }
+  meshQueued = 0;
+  for (Chunk* chunk : queued)
+    queueMesh(chunk);
 }
 
 void ChunkManager::onMeshComplete(MeshChunkJob* job)
 {
-  meshingChunks.erase(ChunkCoord(job->cx, job->cy, job->cz));
+  ChunkEntry* entry = entries.find(packCoordKey(job->cx, job->cy, job->cz));
+  if (!entry || entry->state != ChunkState::Meshing)
+    return;
+
+  setEntryState(entry, ChunkState::Resident);
+  Chunk* chunk = entry->chunk.get();
 
-  Chunk* chunk = getChunk(job->cx, job->cy, job->cz);
-  if (!chunk)
+  // The chunk changed while the job ran. Drop the result and leave the chunk
+  // dirty with the job's slices folded back in, so every edit made during
+  // the run is covered by one remesh. A chunk with nothing on screen yet, or
+  // one that keeps changing faster than it can be meshed, takes the stale
+  // result anyway rather than waiting indefinitely.
+  bool hasMesh = chunk->vao != 0 || chunk->waterVao != 0;
+  if (job->version != chunk->meshVersion && hasMesh && chunk->staleMeshDrops < MAX_STALE_MESH_DROPS)
+  {
+    chunk->dirtySlices.merge(job->slices);
+    chunk->dirtyMesh = true;
+    queueMesh(chunk);
+    chunk->staleMeshDrops++;
+    meshResultsDropped++;
     return;
+  }
+  chunk->staleMeshDrops = 0;
+  countMeshBuild(chunk);
+  meshResultsApplied++;
 
-  uploadToGPU(*chunk, job->vertices, job->indices);
-  uploadWaterToGPU(*chunk, job->waterVertices, job->waterIndices);
-  chunk->dirtyMesh = false;
+  const bool volume = job->input.lightVolume;
+  if (!job->slices.partial())
+  {
+    uploadToGPU(*chunk, job->vertices, job->faceRanges);
+    uploadWaterToGPU(*chunk, job->waterVertices, job->waterFaceRanges);
+    chunk->meshLod = job->lod;
+    chunk->meshLightVolume = volume;
+  }
+  else if (chunk->vao != 0 && chunk->meshLod == 0 && chunk->meshLightVolume == volume)
+  {
+    uploadSlicesToGPU(*chunk, job->slices, job->vertices, job->faceRanges,
+                      job->waterVertices, job->waterFaceRanges);
+  }
+  else
+  {
+    chunk->markMeshDirty();
+  }
+  if (volume && chunk->meshLightVolume)
+  {
+    // Light that changed during the run is fetched again before drawing.
+    uploadLightVolume(*chunk, job->input.skyLight);
+    chunk->lightVolumeDirty = job->lightVersion != chunk->lightVersion;
+  }
+  else if (!chunk->meshLightVolume && job->lightVersion != chunk->lightVersion)
+  {
+    // Baked from light that changed during the run without a remesh, as
+    // the mesh it replaced read a light volume.
+    chunk->markMeshDirty();
+  }
+  // Edits made while the job ran were not in its input.
+  chunk->dirtyMesh = chunk->dirtySlices.any();
+  if (chunk->dirtyMesh || chunk->dirtyLight)
+    queueMesh(chunk);
+}
+
+bool ChunkManager::enqueueLightChunk(Chunk* chunk)
+{
+  // An empty section under full light is full light throughout.
+  Chunk* above = getChunk(chunk->position.x, chunk->position.y + 1, chunk->position.z);
+  if (chunk->kind == SectionKind::Empty &&
+      (!above || (above->lightReady && above->skyLight.isUniform() && above->skyLight.uniformLight() == MAX_SKY_LIGHT)))
+  {
+    uint8_t full[CHUNK_VOLUME];
+    std::fill(std::begin(full), std::end(full), MAX_SKY_LIGHT);
+    chunk->dirtyLight = false;
+    chunk->lightUnchecked = 0;
+    applyLight(chunk, full);
+    return false;
+  }
+
+  auto job = jobSystem->acquireLightJob();
+  job->cx = chunk->position.x;
+  job->cy = chunk->position.y;
+  job->cz = chunk->position.z;
+  job->section = chunk->snapshot();
+  gatherLightNeighbors(job->neighbors, *chunk, *this);
+  ChunkColumn* column = getColumn(chunk->position.x, chunk->position.z);
+  job->hasSkyFloor = column != nullptr;
+  if (column)
+    column->skyFloor(chunk->position.y, job->skyFloor);
+  job->ticket = ++nextLightTicket;
+
+  chunk->lightTicket = job->ticket;
+  chunk->lightJobPending = true;
+  chunk->dirtyLight = false;
+  chunk->lightUnchecked = 0;
+  lightJobsInFlight++;
+  jobSystem->enqueue(std::move(job));
+  return true;
+}
+
+bool ChunkManager::aboveLit(const Chunk* chunk, int centerCX, int centerCZ, int loadRadius, int minY, int maxY)
+{
+  const glm::ivec3& p = chunk->position;
+  ChunkState state = stateOf(p.x, p.y + 1, p.z);
+  if (state == ChunkState::Loading)
+    return false;
+  // A section still to stream in would be taken for open sky.
+  const bool inRange = p.y + 1 >= minY && p.y + 1 <= maxY &&
+                       std::abs(p.x - centerCX) <= loadRadius && std::abs(p.z - centerCZ) <= loadRadius;
+  if (state == ChunkState::Absent && inRange)
+    return false;
+  Chunk* above = getChunk(p.x, p.y + 1, p.z);
+  return !above || above->lightReady;
+}
+
+// The section below was lit as if the new one weren't there; with nothing
+// in the way that meant open sky. A stored border for the face is checked
+// against the new section once it's lit instead.
+void ChunkManager::relightBelow(const Chunk* arrived)
+{
+  Chunk* below = getChunk(arrived->position.x, arrived->position.y - 1, arrived->position.z);
+  if (!below || !below->lightReady || below->hasFixedLight() || (below->lightUnchecked & (1 << 2)))
+    return;
+  below->dirtyLight = true;
+  queueMesh(below);
+}
+
+bool ChunkManager::neighborsLit(const Chunk* chunk)
+{
+  for (int i = 0; i < 6; i++)
+  {
+    Chunk* n = getChunk(chunk->position.x + DIRS[i].x, chunk->position.y + DIRS[i].y, chunk->position.z + DIRS[i].z);
+    if (n && !n->lightReady)
+      return false;
+  }
+  return true;
+}
+
+namespace {
+
+// Sky light over the resident sections, for updateSkyLight. Sections that
+// aren't lit yet read as missing, as they do for the Light jobs.
+class ChunkLightWorld : public SkyLightWorld
+{
+public:
+  struct Touched
+  {
+    Chunk* chunk;
+    glm::ivec3 min;
+    glm::ivec3 max;
+  };
+
+  explicit ChunkLightWorld(ChunkManager& cm) : chunkManager(cm) {}
+
+  bool cell(const glm::ivec3& pos, BlockID& block, uint8_t& light) override
+  {
+    Chunk* c = chunkAt(pos);
+    if (!c || !c->lightReady)
+      return false;
+    int idx = blockIndex(pos.x - c->position.x * CHUNK_SIZE, pos.y - c->position.y * CHUNK_SIZE,
+                         pos.z - c->position.z * CHUNK_SIZE);
+    block = c->blocks.get(idx);
+    light = c->skyLight.get(idx);
+    return true;
+  }
+
+  void setLight(const glm::ivec3& pos, uint8_t light) override
+  {
+    Chunk* c = chunkAt(pos);
+    glm::ivec3 local = pos - c->position * CHUNK_SIZE;
+    c->skyLight.set(blockIndex(local.x, local.y, local.z), light);
+    // A job already running has read the old light; run another after it.
+    if (c->lightJobPending)
+      c->dirtyLight = true;
+
+    for (Touched& t : touched)
+    {
+      if (t.chunk == c)
+      {
+        t.min = glm::min(t.min, local);
+        t.max = glm::max(t.max, local);
+        return;
+      }
+    }
+    touched.push_back({c, local, local});
+  }
+
+  std::vector<Touched> touched;
+
+private:
+  ChunkManager& chunkManager;
+  Chunk* last = nullptr;
+
+  Chunk* chunkAt(const glm::ivec3& pos)
+  {
+    glm::ivec3 cp = worldToChunk(pos.x, pos.y, pos.z);
+    if (!last || last->position != cp)
+      last = chunkManager.getChunk(cp.x, cp.y, cp.z);
+    return last;
+  }
+};
+
+}
+
+bool ChunkManager::updateLightAt(int wx, int wy, int wz)
+{
+  glm::ivec3 cp = worldToChunk(wx, wy, wz);
+  Chunk* chunk = getChunk(cp.x, cp.y, cp.z);
+  if (!chunk || !chunk->lightReady)
+    return false;
+
+  // A running Light job read the old blocks.
+  if (chunk->lightJobPending)
+    chunk->dirtyLight = true;
+
+  ChunkLightWorld world(*this);
+  updateSkyLight(world, glm::ivec3(wx, wy, wz));
+
+  // Faces read the light of the cell in front of them, so each changed box
+  // grows by one and may spill into the sections around it.
+  for (const ChunkLightWorld::Touched& t : world.touched)
+  {
+    const glm::ivec3 lo = t.min - 1, hi = t.max + 1;
+    for (int dz = -1; dz <= 1; dz++)
+      for (int dy = -1; dy <= 1; dy++)
+        for (int dx = -1; dx <= 1; dx++)
+        {
+          const glm::ivec3 d(dx, dy, dz);
+          const glm::ivec3 boxMin = glm::max(lo - d * CHUNK_SIZE, glm::ivec3(0));
+          const glm::ivec3 boxMax = glm::min(hi - d * CHUNK_SIZE, glm::ivec3(CHUNK_SIZE - 1));
+          if (glm::any(glm::greaterThan(boxMin, boxMax)))
+            continue;
+          glm::ivec3 np = t.chunk->position + d;
+          Chunk* n = getChunk(np.x, np.y, np.z);
+          if (n)
+            markLightChanged(n, boxMin, boxMax);
+        }
+  }
+  return true;
+}
+
+// Light worth saving: computed, current, and not a placeholder's.
+static bool lightSettled(const Chunk* chunk)
+{
+  return chunk->lightReady && !chunk->dirtyLight && !chunk->lightJobPending && !chunk->isPlaceholder();
+}
+
+bool ChunkManager::needsSave(const Chunk* chunk)
+{
+  const bool lightStored = chunk->lightOnDisk && chunk->skyLight.revision() == chunk->diskLightRevision;
+  return chunk->dirtyData || (lightSettled(chunk) && !lightStored);
+}
+
+bool ChunkManager::collectLightForSave(const Chunk* chunk, SectionLight& out)
+{
+  std::fill(std::begin(out.borderHashes), std::end(out.borderHashes), 0u);
+  if (!lightSettled(chunk))
+    return false;
+
+  chunk->skyLight.copyTo(out.light);
+  for (int i = 0; i < 6; i++)
+  {
+    if (chunk->lightUnchecked & (1 << i))
+    {
+      out.borderHashes[i] = chunk->lightBorders[i];
+      continue;
+    }
+    Chunk* n = getChunk(chunk->position.x + DIRS[i].x, chunk->position.y + DIRS[i].y, chunk->position.z + DIRS[i].z);
+    if (n && n->lightReady)
+      out.borderHashes[i] = lightBorderHash(n->skyLight, i);
+  }
+  return true;
+}
+
+void ChunkManager::adoptStoredLight(Chunk* chunk, const SectionLight& light)
+{
+  std::copy(std::begin(light.borderHashes), std::end(light.borderHashes), chunk->lightBorders);
+  chunk->lightUnchecked = 0x3F;
+  chunk->lightReady = true;
+  chunk->dirtyLight = false;
+  chunk->lightOnDisk = true;
+  chunk->diskLightRevision = chunk->skyLight.revision();
+  lightLoadedFromDisk++;
+  checkStoredLight(chunk);
+}
+
+// Checks stored light both ways against the lit neighbours already here.
+// A neighbour with no stored border for this chunk was lit without it.
+void ChunkManager::checkStoredLight(Chunk* chunk)
+{
+  uint8_t light[CHUNK_VOLUME];
+  const uint8_t dark[CHUNK_VOLUME] = {};
+  chunk->skyLight.copyTo(light);
+
+  for (int i = 0; i < 6; i++)
+  {
+    Chunk* n = getChunk(chunk->position.x + DIRS[i].x, chunk->position.y + DIRS[i].y, chunk->position.z + DIRS[i].z);
+    if (!n || !n->lightReady)
+      continue;
+
+    const uint8_t face = static_cast<uint8_t>(1 << i);
+    if (chunk->lightUnchecked & face)
+    {
+      chunk->lightUnchecked &= static_cast<uint8_t>(~face);
+      if (chunk->lightBorders[i] != lightBorderHash(n->skyLight, i))
+      {
+        chunk->dirtyLight = true;
+        storedLightRejected++;
+      }
+    }
+
+    if (n->hasFixedLight())
+      continue;
+    const uint8_t back = static_cast<uint8_t>(1 << (i ^ 1));
+    bool relight;
+    if (n->lightUnchecked & back)
+    {
+      n->lightUnchecked &= static_cast<uint8_t>(~back);
+      relight = n->lightBorders[i ^ 1] != lightBorderHash(chunk->skyLight, i ^ 1);
+      if (relight)
+        storedLightRejected++;
+    }
+    else
+    {
+      relight = lightBorderChanged(dark, light, i);
+    }
+    if (relight)
+    {
+      n->dirtyLight = true;
+      queueMesh(n);
+    }
+  }
+}
+
+// Lit neighbours keep the light this chunk gave them; they remember its
+// border so they can tell if it's the same when the chunk comes back.
+void ChunkManager::rememberLightBorders(Chunk* leaving)
+{
+  if (!leaving->lightReady)
+    return;
+  for (int i = 0; i < 6; i++)
+  {
+    Chunk* n = getChunk(leaving->position.x + DIRS[i].x, leaving->position.y + DIRS[i].y, leaving->position.z + DIRS[i].z);
+    if (!n || !n->lightReady || n->hasFixedLight())
+      continue;
+    const int back = i ^ 1;
+    n->lightBorders[back] = lightBorderHash(leaving->skyLight, back);
+    n->lightUnchecked |= static_cast<uint8_t>(1 << back);
+  }
+}
+
+void ChunkManager::onLightComplete(LightChunkJob* job)
+{
+  // Jobs from before a clear() still come back.
+  if (lightJobsInFlight > 0)
+    lightJobsInFlight--;
+  ChunkEntry* entry = entries.find(packCoordKey(job->cx, job->cy, job->cz));
+  Chunk* chunk = entry ? entry->chunk.get() : nullptr;
+  if (!chunk || !chunk->lightJobPending || chunk->lightTicket != job->ticket)
+    return;
+  chunk->lightJobPending = false;
+  applyLight(chunk, job->light);
+}
+
+void ChunkManager::applyLight(Chunk* chunk, const uint8_t* light)
+{
+  // Neighbours skipped this chunk while it was unlit, which is the same as
+  // it having been dark.
+  uint8_t before[CHUNK_VOLUME] = {};
+  const bool wasLit = chunk->lightReady;
+  if (wasLit)
+    chunk->skyLight.copyTo(before);
+  chunk->skyLight.assign(light);
+  chunk->lightReady = true;
+
+  glm::ivec3 min, max;
+  if (!lightChangeBounds(before, light, min, max) && wasLit)
+  {
+    if (chunk->dirtyMesh || chunk->dirtyLight)
+      queueMesh(chunk);
+    return;
+  }
+
+  // Own faces read the new light; a first light needs a full mesh anyway.
+  if (wasLit)
+  {
+    markLightChanged(chunk, min, max);
+  }
+  else
+  {
+    chunk->markMeshDirty();
+    queueMesh(chunk);
+  }
+
+  // Light crossing a border changes what lit neighbours compute, and what
+  // their border faces read.
+  for (int i = 0; i < 6; i++)
+  {
+    Chunk* n = getChunk(chunk->position.x + DIRS[i].x, chunk->position.y + DIRS[i].y, chunk->position.z + DIRS[i].z);
+    if (!n || !n->lightReady || n->hasFixedLight())
+      continue;
+    const bool borderChanged = lightBorderChanged(before, light, i);
+    bool relight = borderChanged;
+    // A neighbour with stored light knows which border it was lit against.
+    const uint8_t back = static_cast<uint8_t>(1 << (i ^ 1));
+    if (n->lightUnchecked & back)
+    {
+      n->lightUnchecked &= static_cast<uint8_t>(~back);
+      relight = n->lightBorders[i ^ 1] != lightBorderHash(chunk->skyLight, i ^ 1);
+      if (relight)
+        storedLightRejected++;
+    }
+    if (!relight && !borderChanged)
+      continue;
+    if (relight)
+      n->dirtyLight = true;
+    glm::ivec3 lo(0), hi(CHUNK_SIZE - 1);
+    const int axis = i / 2;
+    lo[axis] = hi[axis] = (i & 1) == 0 ? 0 : CHUNK_SIZE - 1;
+    markLightChanged(n, lo, hi);
+  }
+}
+
+void ChunkManager::markLightChanged(Chunk* chunk, const glm::ivec3& min, const glm::ivec3& max)
+{
+  chunk->lightVersion++;
+  // A mesh reading a light volume keeps its quads; only the texture is
+  // stale. The chunk may still be due a relight.
+  if (chunk->meshLightVolume)
+  {
+    chunk->lightVolumeDirty = true;
+    if (chunk->dirtyLight)
+      queueMesh(chunk);
+    return;
+  }
+  chunk->markBoxDirty(min, max);
+  queueMesh(chunk);
 }
@@ -1,28 +1,56 @@
 #pragma once
 #include "Chunk.h"
+#include "ChunkPool.h"
+#include "ChunkClipmap.h"
+#include "ChunkColumn.h"
 #include "../utils/CoordUtils.h"
+#include "../utils/PackedKeyTable.h"
 #include <cstddef>
 #include <cstdint>
 #include <memory>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 class JobSystem;
 class RegionManager;
 struct GenerateChunkJob;
 struct MeshChunkJob;
+struct LightChunkJob;
+struct SectionLight;
+
+// Where a chunk coordinate is in its streaming lifecycle. Resident and
+// Meshing entries own a chunk; Loading and Saving entries only block
+// duplicate work. Absent coordinates have no entry at all.
+enum class ChunkState : uint8_t
+{
+  Absent,
+  Loading,
+  Resident,
+  Meshing,
+  Saving
+};
+
+// What a visit to the mesh queue does with the chunk it was handed.
+enum class MeshQueueStep : uint8_t
+{
+  Keep,
+  Remove,
+  Stop
+};
+
+struct ChunkEntry
+{
+  ChunkState state = ChunkState::Absent;
+  ChunkPool::Handle chunk;
+};
 
 struct ChunkManager
 {
   using ChunkCoord = glm::ivec3;
-  using ChunkCoordHash = IVec3Hash;
-  using ChunkMap = std::unordered_map<ChunkCoord, std::unique_ptr<Chunk>, ChunkCoordHash>;
-  using ChunkSet = std::unordered_set<ChunkCoord, ChunkCoordHash>;
 
-  ChunkMap chunks;
-  ChunkSet loadingChunks;
-  ChunkSet meshingChunks;
-  ChunkSet savingChunks;
+  // Declared before every container holding handles so it outlives them.
+  ChunkPool chunkPool;
+  PackedKeyTable<ChunkEntry> entries;
+  ChunkClipmap clipmap;
 
   JobSystem* jobSystem = nullptr;
   RegionManager* regionManager = nullptr;
@@ -32,6 +60,31 @@ struct ChunkManager
 
   Chunk *getChunk(int cx, int cy, int cz);
   bool hasChunk(int cx, int cy, int cz);
+  // The column over chunk (cx, cz); null once none of its sections is resident.
+  ChunkColumn* getColumn(int cx, int cz);
+  // World y + 1 of the highest block at (wx, wz), or -1 if its column isn't loaded.
+  int surfaceHeight(int wx, int wz);
+  ChunkState stateOf(int cx, int cy, int cz) const;
+
+  // Visits every chunk that is Resident or Meshing.
+  template <typename Fn>
+  void forEachChunk(Fn&& fn)
+  {
+    for (auto& slot : entries)
+    {
+      if (Chunk* c = slot.value.chunk.get())
+        fn(c);
+    }
+  }
+
+  size_t chunkCount() const { return residentChunks; }
+  size_t loadingCount() const { return loadingChunks; }
+  size_t meshingCount() const { return meshingChunks; }
+  void clear();
+
+  // Keeps the lookup window centred on the player's column; radius should
+  // cover every chunk that can be resident (the unload radius).
+  void setViewCenter(int cx, int cz, int radius, int minY, int maxY);
 
   Chunk *loadChunk(int cx, int cy, int cz);
   void unloadChunk(int cx, int cy, int cz);
@@ -39,17 +92,131 @@ struct ChunkManager
   void enqueueLoadChunk(int cx, int cy, int cz);
   void enqueueSaveAndUnload(int cx, int cy, int cz);
   void enqueueMeshChunk(int cx, int cy, int cz);
+  // Relights chunk on a worker. Clears dirtyLight; the result is applied by
+  // onLightComplete, which queues the chunk for meshing. An empty section
+  // under full light is lit on the spot instead, and false is returned.
+  bool enqueueLightChunk(Chunk* chunk);
+
+  // Clears dirtyMesh on placeholders that still can't produce faces, and
+  // promotes solid sections whose neighbors have exposed one of their sides.
+  bool needsMesh(Chunk* chunk);
+
+  // True once none of chunk's face neighbours is still to arrive: each is
+  // resident, or outside the streamed square (centred on centerCX/CZ with
+  // half-size loadRadius) and height range, so it never will be.
+  bool neighborsSettled(const Chunk* chunk, int centerCX, int centerCZ, int loadRadius, int minY, int maxY) const;
+  // True when the section above is lit, or absent and outside the streamed
+  // area (as for neighborsSettled) so it won't arrive, letting the chunk's
+  // columns be lit top-down.
+  bool aboveLit(const Chunk* chunk, int centerCX, int centerCZ, int loadRadius, int minY, int maxY);
+  // True when every resident face neighbour is lit, so a mesh won't pick
+  // up their placeholder light along the borders.
+  bool neighborsLit(const Chunk* chunk);
+  // Brings sky light up to date after the block at a world position changed,
+  // touching only the cells that change and remeshing around them. Returns
+  // false when the edited chunk isn't lit yet; it then needs a full relight.
+  bool updateLightAt(int wx, int wy, int wz);
+
+  // True when the region file lacks something chunk has: edited blocks, or
+  // settled light that isn't stored yet.
+  bool needsSave(const Chunk* chunk);
+  // Fills out with chunk's light and the neighbour borders it was computed
+  // against. False while the light isn't settled, and none should be saved.
+  bool collectLightForSave(const Chunk* chunk, SectionLight& out);
+
+  // Chunks waiting to be meshed, bucketed by ring distance from the view
+  // centre. Whoever marks a chunk's mesh dirty queues it; chunks remember
+  // their own slot, so queueing and removal are O(1) and the scheduler only
+  // ever looks at chunks that changed. Queueing a queued chunk is a no-op.
+  void queueMesh(Chunk* chunk);
+  void dequeueMesh(Chunk* chunk);
+  // Rebuckets the queue around a new centre; cheap when it hasn't moved.
+  void setMeshCenter(int cx, int cz);
+  size_t meshQueueSize() const { return meshQueued; }
 
-  bool isLoading(int cx, int cy, int cz) const;
-  bool isMeshing(int cx, int cy, int cz) const;
-  bool isSaving(int cx, int cy, int cz) const;
+  // Hands queued chunks to fn nearest ring first. fn decides whether each
+  // stays queued, leaves, or ends the visit; it must not queue or dequeue
+  // anything itself.
+  template <typename Fn>
+  void visitMeshQueue(Fn&& fn)
+  {
+    for (int32_t bucket = 0; bucket < static_cast<int32_t>(meshBuckets.size()); bucket++)
+    {
+      std::vector<Chunk*>& chunks = meshBuckets[bucket];
+      for (size_t i = 0; i < chunks.size();)
+      {
+        Chunk* chunk = chunks[i];
+        MeshQueueStep step = fn(chunk);
+        if (step == MeshQueueStep::Remove)
+          dequeueMesh(chunk);
+        else
+          i++;
+        if (step == MeshQueueStep::Stop)
+          return;
+      }
+    }
+  }
+  // Running totals over resident sections for the debug overlay. Whoever
+  // changes a resident chunk's kind or meshBuilds calls tallySection with
+  // -1 before and +1 after.
+  struct SectionTally
+  {
+    size_t placeholders = 0;
+    size_t meshedOnce = 0;
+    size_t meshedTwice = 0;
+    size_t meshedMore = 0;
+  };
+  const SectionTally& sectionTally() const { return tally; }
+  void tallySection(const Chunk* chunk, int sign);
+  // Counts a finished mesh build for chunk.
+  void countMeshBuild(Chunk* chunk);
+
+  // Mesh results uploaded, and ones dropped because the chunk changed
+  // after their input was captured.
+  size_t meshResultsApplied = 0;
+  size_t meshResultsDropped = 0;
 
   void update();
 
   void onGenerateComplete(GenerateChunkJob* job);
   void onMeshComplete(MeshChunkJob* job);
+  void onLightComplete(LightChunkJob* job);
+  // Stores freshly computed light for chunk and tells its neighbours.
+  void applyLight(Chunk* chunk, const uint8_t* light);
+  // Light in [min, max] of chunk changed under its current mesh.
+  void markLightChanged(Chunk* chunk, const glm::ivec3& min, const glm::ivec3& max);
+
+  size_t lightJobsInFlight = 0;
+  // Sections that took their saved light on load, and ones whose saved
+  // light didn't match a neighbour and had to be relit.
+  size_t lightLoadedFromDisk = 0;
+  size_t storedLightRejected = 0;
 
 private:
+  size_t residentChunks = 0;
+  // Entries in Loading and Meshing; every state change goes through
+  // setEntryState so these stay exact.
+  size_t loadingChunks = 0;
+  size_t meshingChunks = 0;
+  SectionTally tally;
+  std::vector<std::vector<Chunk*>> meshBuckets;
+  glm::ivec2 meshCenter{0};
+  size_t meshQueued = 0;
+  uint32_t nextLightTicket = 0;
+  PackedKeyTable<std::unique_ptr<ChunkColumn>> columns;
+
+  void markNeighborsDirty(int cx, int cy, int cz);
+  void attachToColumn(Chunk* chunk);
+  void detachFromColumn(int cx, int cy, int cz);
+  void adoptStoredLight(Chunk* chunk, const SectionLight& light);
+  void checkStoredLight(Chunk* chunk);
+  void relightBelow(const Chunk* arrived);
+  void rememberLightBorders(Chunk* leaving);
+
+  void setEntryState(ChunkEntry* entry, ChunkState state);
+  void eraseEntry(uint64_t key, ChunkEntry* entry);
+
+  Chunk *findInTable(int cx, int cy, int cz);
   void copyNeighborFace(BlockID* dest, Chunk* neighbor, int face);
-  void copyNeighborSkyLightFace(uint8_t* dest, Chunk* neighbor, int face);
+  bool isNeighborFaceOpaque(Chunk* neighbor, int face);
 };
@@ -0,0 +1,29 @@
+#include "ChunkPool.h"
+
+void ChunkPool::Deleter::operator()(Chunk* chunk) const
+{
+    if (pool)
+        pool->release(chunk);
+}
+
+ChunkPool::Handle ChunkPool::acquire()
+{
+    if (freeList.empty())
+    {
+        slabs.push_back(std::make_unique<Chunk[]>(SLAB_SIZE));
+        Chunk* slab = slabs.back().get();
+        freeList.reserve(capacity());
+        for (size_t i = SLAB_SIZE; i > 0; i--)
+            freeList.push_back(&slab[i - 1]);
+    }
+
+    Chunk* chunk = freeList.back();
+    freeList.pop_back();
+    return Handle(chunk, Deleter{this});
+}
+
+void ChunkPool::release(Chunk* chunk)
+{
+    chunk->reset();
+    freeList.push_back(chunk);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Chunk.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Slab allocator for Chunk bodies. Chunks are constructed SLAB_SIZE at a time
+// and recycled through a free list, so streaming a section in or out never
+// touches the heap for the Chunk itself. Handles return their chunk to the
+// pool when destroyed. Acquire and release on the main thread only; a worker
+// may fill a chunk it was handed through a job, but never frees it.
+class ChunkPool
+{
+public:
+    static constexpr size_t SLAB_SIZE = 64;
+
+    struct Deleter
+    {
+        ChunkPool* pool = nullptr;
+        void operator()(Chunk* chunk) const;
+    };
+    using Handle = std::unique_ptr<Chunk, Deleter>;
+
+    ChunkPool() = default;
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    Handle acquire();
+
+    size_t capacity() const { return slabs.size() * SLAB_SIZE; }
+    size_t inUse() const { return capacity() - freeList.size(); }
+
+private:
+    std::vector<std::unique_ptr<Chunk[]>> slabs;
+    std::vector<Chunk*> freeList;
+
+    void release(Chunk* chunk);
+};
@@ -0,0 +1,390 @@
+#include "ChunkStorage.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Palette indices as their own ids, for repacking an index array.
+struct IdentityLookup
+{
+    uint8_t table[256];
+    IdentityLookup()
+    {
+        for (int i = 0; i < 256; i++)
+            table[i] = static_cast<uint8_t>(i);
+    }
+};
+
+const uint8_t* identityLookup()
+{
+    static const IdentityLookup lookup;
+    return lookup.table;
+}
+
+}
+
+int buildBlockPalette(const BlockID* blocks, BlockID* palette, uint8_t* lookup, uint16_t* counts)
+{
+    uint16_t perId[256] = {};
+    for (int i = 0; i < CHUNK_VOLUME; i++)
+        perId[blocks[i]]++;
+
+    int size = 0;
+    for (int id = 0; id < 256; id++)
+    {
+        if (perId[id] == 0)
+            continue;
+        lookup[id] = static_cast<uint8_t>(size);
+        palette[size] = static_cast<BlockID>(id);
+        if (counts)
+            counts[size] = perId[id];
+        size++;
+    }
+    return size;
+}
+
+void packPaletteIndices(const BlockID* blocks, const uint8_t* lookup, int bits, const uint16_t* order, uint8_t* out)
+{
+    const int perByte = 8 / bits;
+    int cell = 0;
+    for (int b = 0; b < packedPaletteBytes(bits); b++)
+    {
+        uint8_t byte = 0;
+        for (int e = 0; e < perByte; e++, cell++)
+            byte |= static_cast<uint8_t>(lookup[blocks[order ? order[cell] : cell]] << (e * bits));
+        out[b] = byte;
+    }
+}
+
+bool unpackPaletteIndices(const uint8_t* packed, int bits, const BlockID* palette, int paletteSize,
+                          const uint16_t* order, BlockID* out)
+{
+    const int perByte = 8 / bits;
+    const uint8_t mask = static_cast<uint8_t>((1u << bits) - 1u);
+    int cell = 0;
+    for (int b = 0; b < packedPaletteBytes(bits); b++)
+    {
+        uint8_t byte = packed[b];
+        for (int e = 0; e < perByte; e++, cell++)
+        {
+            const uint8_t idx = byte & mask;
+            byte = static_cast<uint8_t>(byte >> bits);
+            if (idx >= paletteSize)
+                return false;
+            out[order ? order[cell] : cell] = palette[idx];
+        }
+    }
+    return true;
+}
+
+int BlockStorage::bitsForPaletteSize(int size)
+{
+    if (size <= 1)  return 0;
+    if (size <= 2)  return 1;
+    if (size <= 4)  return 2;
+    if (size <= 16) return 4;
+    return 8;
+}
+
+BlockStorage::BlockStorage(const BlockStorage& other)
+{
+    *this = other;
+}
+
+BlockStorage& BlockStorage::operator=(const BlockStorage& other)
+{
+    if (this == &other)
+        return *this;
+
+    bitsPerEntry = other.bitsPerEntry;
+    entriesPerByteShift = other.entriesPerByteShift;
+    entryMaskInByte = other.entryMaskInByte;
+    indexMask = other.indexMask;
+    uniformValue = other.uniformValue;
+    liveEntries = other.liveEntries;
+    rev++;
+    palette = other.palette;
+    paletteCounts = other.paletteCounts;
+
+    if (other.data)
+    {
+        const int bytes = packedPaletteBytes(bitsPerEntry);
+        data = std::make_unique<uint8_t[]>(bytes);
+        std::memcpy(data.get(), other.data.get(), bytes);
+    }
+    else
+    {
+        data.reset();
+    }
+    return *this;
+}
+
+void BlockStorage::setLayout(int bits)
+{
+    bitsPerEntry = static_cast<uint8_t>(bits);
+    if (bits == 0)
+    {
+        entriesPerByteShift = 0;
+        entryMaskInByte = 0;
+        indexMask = 0;
+        return;
+    }
+
+    const int entriesPerByte = 8 / bits;
+    int shift = 0;
+    while ((1 << shift) < entriesPerByte)
+        shift++;
+    entriesPerByteShift = static_cast<uint8_t>(shift);
+    entryMaskInByte = static_cast<uint8_t>(entriesPerByte - 1);
+    indexMask = static_cast<uint8_t>((1u << bits) - 1u);
+}
+
+uint32_t BlockStorage::readIndex(int index) const
+{
+    const int shift = (index & entryMaskInByte) * bitsPerEntry;
+    return (data[index >> entriesPerByteShift] >> shift) & indexMask;
+}
+
+void BlockStorage::writeIndex(int index, uint32_t paletteIndex)
+{
+    const int shift = (index & entryMaskInByte) * bitsPerEntry;
+    uint8_t& byte = data[index >> entriesPerByteShift];
+    byte = static_cast<uint8_t>((byte & ~(indexMask << shift)) | (paletteIndex << shift));
+}
+
+void BlockStorage::fill(BlockID id)
+{
+    rev++;
+    setLayout(0);
+    uniformValue = id;
+    liveEntries = 1;
+    palette = std::vector<BlockID>();
+    paletteCounts = std::vector<uint16_t>();
+    data.reset();
+}
+
+void BlockStorage::assign(const BlockID* src)
+{
+    rev++;
+    BlockID localPalette[256];
+    uint16_t localCounts[256];
+    uint8_t lookup[256];
+    const int size = buildBlockPalette(src, localPalette, lookup, localCounts);
+    if (size == 1)
+    {
+        fill(localPalette[0]);
+        return;
+    }
+
+    const int bits = bitsForPaletteSize(size);
+    setLayout(bits);
+    liveEntries = static_cast<uint16_t>(size);
+    palette = std::vector<BlockID>(localPalette, localPalette + size);
+    paletteCounts = std::vector<uint16_t>(localCounts, localCounts + size);
+    data = std::make_unique<uint8_t[]>(packedPaletteBytes(bits));
+    packPaletteIndices(src, lookup, bits, nullptr, data.get());
+}
+
+void BlockStorage::copyTo(BlockID* dest) const
+{
+    if (bitsPerEntry == 0)
+    {
+        std::memset(dest, uniformValue, CHUNK_VOLUME * sizeof(BlockID));
+        return;
+    }
+    unpackPaletteIndices(data.get(), bitsPerEntry, palette.data(), static_cast<int>(palette.size()), nullptr, dest);
+}
+
+int BlockStorage::findOrAddPaletteEntry(BlockID id)
+{
+    int freeSlot = -1;
+    for (size_t i = 0; i < palette.size(); i++)
+    {
+        if (paletteCounts[i] == 0)
+        {
+            if (freeSlot < 0)
+                freeSlot = static_cast<int>(i);
+        }
+        else if (palette[i] == id)
+        {
+            return static_cast<int>(i);
+        }
+    }
+
+    liveEntries++;
+    if (freeSlot >= 0)
+    {
+        palette[freeSlot] = id;
+        return freeSlot;
+    }
+
+    palette.push_back(id);
+    paletteCounts.push_back(0);
+
+    if (palette.size() > (1u << bitsPerEntry))
+    {
+        // Widen the index array in place; palette indices stay valid.
+        uint8_t indices[CHUNK_VOLUME];
+        for (int i = 0; i < CHUNK_VOLUME; i++)
+            indices[i] = static_cast<uint8_t>(readIndex(i));
+
+        const int bits = bitsForPaletteSize(static_cast<int>(palette.size()));
+        setLayout(bits);
+        data = std::make_unique<uint8_t[]>(packedPaletteBytes(bits));
+        packPaletteIndices(indices, identityLookup(), bits, nullptr, data.get());
+    }
+
+    return static_cast<int>(palette.size()) - 1;
+}
+
+void BlockStorage::repack()
+{
+    BlockID flat[CHUNK_VOLUME];
+    copyTo(flat);
+    assign(flat);
+}
+
+void BlockStorage::set(int index, BlockID id)
+{
+    if (bitsPerEntry == 0)
+    {
+        if (id == uniformValue)
+            return;
+
+        rev++;
+        setLayout(1);
+        data = std::make_unique<uint8_t[]>(packedPaletteBytes(1));
+        palette = {uniformValue, id};
+        paletteCounts = {static_cast<uint16_t>(CHUNK_VOLUME - 1), 1};
+        liveEntries = 2;
+        writeIndex(index, 1);
+        return;
+    }
+
+    const uint32_t oldIndex = readIndex(index);
+    if (palette[oldIndex] == id)
+        return;
+
+    rev++;
+    const int newIndex = findOrAddPaletteEntry(id);
+    writeIndex(index, static_cast<uint32_t>(newIndex));
+    paletteCounts[newIndex]++;
+
+    // Shrinking waits until the palette would fit twice over in a narrower
+    // width, so toggling one block across a width boundary doesn't repack
+    // the section on every edit. Uniform sections still collapse at once.
+    if (--paletteCounts[oldIndex] == 0)
+    {
+        liveEntries--;
+        if (liveEntries == 1 || bitsForPaletteSize(liveEntries * 2) < bitsPerEntry)
+            repack();
+    }
+}
+
+size_t BlockStorage::memoryUsage() const
+{
+    size_t bytes = sizeof(BlockStorage);
+    bytes += palette.capacity() * sizeof(BlockID);
+    bytes += paletteCounts.capacity() * sizeof(uint16_t);
+    if (data)
+        bytes += packedPaletteBytes(bitsPerEntry);
+    return bytes;
+}
+
+LightStorage::LightStorage(const LightStorage& other)
+{
+    *this = other;
+}
+
+LightStorage& LightStorage::operator=(const LightStorage& other)
+{
+    if (this == &other)
+        return *this;
+
+    uniformValue = other.uniformValue;
+    rev++;
+    if (other.nibbles)
+    {
+        if (!nibbles)
+            nibbles = std::make_unique<uint8_t[]>(PACKED_BYTES);
+        std::memcpy(nibbles.get(), other.nibbles.get(), PACKED_BYTES);
+    }
+    else
+    {
+        nibbles.reset();
+    }
+    return *this;
+}
+
+void LightStorage::set(int index, uint8_t value)
+{
+    value &= 0x0F;
+    if (get(index) == value)
+        return;
+
+    rev++;
+    if (!nibbles)
+    {
+        nibbles = std::make_unique<uint8_t[]>(PACKED_BYTES);
+        std::memset(nibbles.get(), uniformValue | (uniformValue << 4), PACKED_BYTES);
+    }
+
+    uint8_t& byte = nibbles[index >> 1];
+    if (index & 1)
+        byte = static_cast<uint8_t>((byte & 0x0F) | (value << 4));
+    else
+        byte = static_cast<uint8_t>((byte & 0xF0) | value);
+}
+
+void LightStorage::fill(uint8_t value)
+{
+    rev++;
+    uniformValue = value & 0x0F;
+    nibbles.reset();
+}
+
+void LightStorage::assign(const uint8_t* src)
+{
+    rev++;
+    const uint8_t first = src[0] & 0x0F;
+    bool uniform = true;
+    for (int i = 1; i < CHUNK_VOLUME; i++)
+    {
+        if ((src[i] & 0x0F) != first)
+        {
+            uniform = false;
+            break;
+        }
+    }
+
+    if (uniform)
+    {
+        fill(first);
+        return;
+    }
+
+    if (!nibbles)
+        nibbles = std::make_unique<uint8_t[]>(PACKED_BYTES);
+    for (int i = 0; i < PACKED_BYTES; i++)
+        nibbles[i] = static_cast<uint8_t>((src[2 * i] & 0x0F) | ((src[2 * i + 1] & 0x0F) << 4));
+}
+
+void LightStorage::copyTo(uint8_t* dest) const
+{
+    if (!nibbles)
+    {
+        std::memset(dest, uniformValue, CHUNK_VOLUME);
+        return;
+    }
+
+    for (int i = 0; i < PACKED_BYTES; i++)
+    {
+        dest[2 * i] = nibbles[i] & 0x0F;
+        dest[2 * i + 1] = nibbles[i] >> 4;
+    }
+}
+
+size_t LightStorage::memoryUsage() const
+{
+    return sizeof(LightStorage) + (nibbles ? PACKED_BYTES : 0);
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using BlockID = uint8_t;
+constexpr int CHUNK_SIZE = 16;
+constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+// Palette packing shared by BlockStorage and the region codec
+// (compressPalette in RegionManager.cpp): a section's distinct ids in
+// ascending order, and one index per cell of `bits` bits (1, 2, 4 or 8)
+// packed low bits first into bytes.
+constexpr int packedPaletteBytes(int bits) { return CHUNK_VOLUME * bits / 8; }
+
+// Fills palette with the ids in blocks and returns how many there are;
+// lookup maps each id to its entry and counts, if given, gets its cells.
+int buildBlockPalette(const BlockID* blocks, BlockID* palette, uint8_t* lookup, uint16_t* counts = nullptr);
+
+// Cells are visited in blockIndex() order, or in order[] when given.
+void packPaletteIndices(const BlockID* blocks, const uint8_t* lookup, int bits, const uint16_t* order, uint8_t* out);
+// False if an index is past paletteSize.
+bool unpackPaletteIndices(const uint8_t* packed, int bits, const BlockID* palette, int paletteSize,
+                          const uint16_t* order, BlockID* out);
+
+// Paletted, bit-packed block storage for one 16³ section. A section holding a
+// single block type (all air, all stone) keeps no index array at all; mixed
+// sections store 1/2/4/8-bit palette indices packed as above. The
+// index width grows when the palette fills up and shrinks again once enough
+// palette entries fall out of use, so edits keep the representation tight.
+class BlockStorage
+{
+public:
+    BlockStorage() = default;
+    BlockStorage(const BlockStorage& other);
+    BlockStorage& operator=(const BlockStorage& other);
+    BlockStorage(BlockStorage&&) noexcept = default;
+    BlockStorage& operator=(BlockStorage&&) noexcept = default;
+
+    BlockID get(int index) const
+    {
+        if (bitsPerEntry == 0)
+            return uniformValue;
+        const int shift = (index & entryMaskInByte) * bitsPerEntry;
+        return palette[(data[index >> entriesPerByteShift] >> shift) & indexMask];
+    }
+
+    void set(int index, BlockID id);
+    void fill(BlockID id);
+
+    // Bulk conversion to and from the flat blockIndex() layout used by jobs,
+    // the generator and the region codec.
+    void assign(const BlockID* src);
+    void copyTo(BlockID* dest) const;
+
+    bool isUniform() const { return bitsPerEntry == 0; }
+    BlockID uniformBlock() const { return uniformValue; }
+    // Changes on every write, so copies can tell whether they are current.
+    uint32_t revision() const { return rev; }
+    int bits() const { return bitsPerEntry; }
+    int paletteSize() const { return bitsPerEntry == 0 ? 1 : liveEntries; }
+    size_t memoryUsage() const;
+
+    static int bitsForPaletteSize(int size);
+
+private:
+    uint8_t bitsPerEntry = 0;
+    uint8_t entriesPerByteShift = 0;
+    uint8_t entryMaskInByte = 0;
+    uint8_t indexMask = 0;
+    BlockID uniformValue = 0;
+    uint16_t liveEntries = 1;
+    uint32_t rev = 0;
+
+    std::vector<BlockID> palette;
+    std::vector<uint16_t> paletteCounts;
+    std::unique_ptr<uint8_t[]> data;
+
+    void setLayout(int bits);
+    uint32_t readIndex(int index) const;
+    void writeIndex(int index, uint32_t paletteIndex);
+    int findOrAddPaletteEntry(BlockID id);
+    void repack();
+};
+
+// 4-bit skylight storage for one section. Fully lit sky sections and fully
+// dark buried sections are common enough that they keep a single uniform
+// value instead of the 2 KiB nibble array.
+class LightStorage
+{
+public:
+    static constexpr int PACKED_BYTES = CHUNK_VOLUME / 2;
+
+    explicit LightStorage(uint8_t value = 0) : uniformValue(value) {}
+    LightStorage(const LightStorage& other);
+    LightStorage& operator=(const LightStorage& other);
+    LightStorage(LightStorage&&) noexcept = default;
+    LightStorage& operator=(LightStorage&&) noexcept = default;
+
+    uint8_t get(int index) const
+    {
+        if (!nibbles)
+            return uniformValue;
+        return (nibbles[index >> 1] >> ((index & 1) << 2)) & 0x0F;
+    }
+
+    void set(int index, uint8_t value);
+    void fill(uint8_t value);
+
+    void assign(const uint8_t* src);
+    void copyTo(uint8_t* dest) const;
+
+    bool isUniform() const { return !nibbles; }
+    uint8_t uniformLight() const { return uniformValue; }
+    uint32_t revision() const { return rev; }
+    size_t memoryUsage() const;
+
+private:
+    uint8_t uniformValue = 0;
+    uint32_t rev = 0;
+    std::unique_ptr<uint8_t[]> nibbles;
+};
+
+// Immutable copy of one section's blocks and light. Jobs hold these by
+// shared_ptr instead of copying the section into their own arrays; see
+// Chunk::snapshot().
+struct SectionSnapshot
+{
+    BlockStorage blocks;
+    LightStorage skyLight;
+};
@@ -1,4 +1,5 @@
 #include "RegionManager.h"
+#include "SkyLight.h"
 #include <filesystem>
 #include <cstring>
 #include <algorithm>
@@ -9,6 +10,10 @@ namespace fs = std::filesystem;
 
 namespace {
 
+// Leads a column record whose sections each carry a light layer after their
+// blocks. Older records start with the section count instead.
+constexpr uint8_t COLUMN_WITH_LIGHT = 0xFE;
+
 constexpr uint16_t MORTON_SPREAD[16] = {
     0x000, 0x001, 0x008, 0x009,
     0x040, 0x041, 0x048, 0x049,
@@ -102,47 +107,18 @@ bool zlibCompressRLE(const std::vector<uint8_t>& rle,
     return true;
 }
 
+// Palette and index packing are BlockStorage's (see ChunkStorage.h), in
+// y-major order and at no less than one bit per index.
 bool compressPalette(const BlockID* blocks, std::vector<uint8_t>& out)
 {
-    bool seen[256] = {};
     uint8_t palette[256];
-    int palSize = 0;
+    uint8_t lookup[256];
+    const int palSize = buildBlockPalette(blocks, palette, lookup);
+    if (palSize > 16) return false;
 
-    for (int i = 0; i < CHUNK_VOLUME; i++)
-    {
-        if (!seen[blocks[i]])
-        {
-            seen[blocks[i]] = true;
-            palette[palSize++] = blocks[i];
-            if (palSize > 16) return false;
-        }
-    }
-    std::sort(palette, palette + palSize);
-
-    uint8_t lookup[256] = {};
-    for (int i = 0; i < palSize; i++)
-        lookup[palette[i]] = static_cast<uint8_t>(i);
-
-    int bpe;
-    if      (palSize <= 2)  bpe = 1;
-    else if (palSize <= 4)  bpe = 2;
-    else                    bpe = 4;
-
-    const uint16_t* order = traversalOrders().yMajor;
-    int totalBytes = (CHUNK_VOLUME * bpe + 7) / 8;
-    std::vector<uint8_t> packed(totalBytes, 0);
-
-    int bitPos = 0;
-    for (int i = 0; i < CHUNK_VOLUME; i++)
-    {
-        uint8_t idx   = lookup[blocks[order[i]]];
-        int bytePos   = bitPos >> 3;
-        int bitOffset = bitPos & 7;
-        packed[bytePos] |= static_cast<uint8_t>(idx << bitOffset);
-        if (bitOffset + bpe > 8)
-            packed[bytePos + 1] |= static_cast<uint8_t>(idx >> (8 - bitOffset));
-        bitPos += bpe;
-    }
+    const int bpe = std::max(1, BlockStorage::bitsForPaletteSize(palSize));
+    std::vector<uint8_t> packed(packedPaletteBytes(bpe));
+    packPaletteIndices(blocks, lookup, bpe, traversalOrders().yMajor, packed.data());
 
     uLongf bound = compressBound(static_cast<uLong>(packed.size()));
     out.resize(2 + palSize + 4 + bound);
@@ -172,13 +148,10 @@ bool decompressPalette(const std::vector<uint8_t>& compressed, BlockID* outBlock
     uint8_t palette[16];
     std::memcpy(palette, &compressed[2], palSize);
 
-    int bpe;
-    if      (palSize <= 2)  bpe = 1;
-    else if (palSize <= 4)  bpe = 2;
-    else                    bpe = 4;
-
+    const int bpe = std::max(1, BlockStorage::bitsForPaletteSize(palSize));
     uint32_t packedLen;
     std::memcpy(&packedLen, &compressed[2 + palSize], 4);
+    if (packedLen != static_cast<uint32_t>(packedPaletteBytes(bpe))) return false;
 
     std::vector<uint8_t> packed(packedLen);
     uLongf destLen = packedLen;
@@ -187,21 +160,7 @@ bool decompressPalette(const std::vector<uint8_t>& compressed, BlockID* outBlock
                         static_cast<uLong>(compressed.size() - 2 - palSize - 4));
     if (rc != Z_OK || destLen != packedLen) return false;
 
-    const uint16_t* order = traversalOrders().yMajor;
-    uint8_t mask = static_cast<uint8_t>((1 << bpe) - 1);
-    int bitPos = 0;
-    for (int i = 0; i < CHUNK_VOLUME; i++)
-    {
-        int bytePos   = bitPos >> 3;
-        int bitOffset = bitPos & 7;
-        uint8_t idx   = (packed[bytePos] >> bitOffset) & mask;
-        if (bitOffset + bpe > 8 && bytePos + 1 < static_cast<int>(packed.size()))
-            idx |= static_cast<uint8_t>((packed[bytePos + 1] << (8 - bitOffset)) & mask);
-        if (idx >= palSize) return false;
-        outBlocks[order[i]] = palette[idx];
-        bitPos += bpe;
-    }
-    return true;
+    return unpackPaletteIndices(packed.data(), bpe, palette, palSize, traversalOrders().yMajor, outBlocks);
 }
 
 }
@@ -291,6 +250,9 @@ bool RegionFile::loadColumn(int localX, int localZ, ColumnData& outData)
 
     uint8_t numSections = 0;
     file.read(reinterpret_cast<char*>(&numSections), 1);
+    const bool withLight = numSections == COLUMN_WITH_LIGHT;
+    if (withLight)
+        file.read(reinterpret_cast<char*>(&numSections), 1);
 
     outData.sections.clear();
     outData.sections.reserve(numSections);
@@ -306,6 +268,14 @@ bool RegionFile::loadColumn(int localX, int localZ, ColumnData& outData)
         section.compressedBlocks.resize(compressedSize);
         file.read(reinterpret_cast<char*>(section.compressedBlocks.data()), compressedSize);
 
+        if (withLight)
+        {
+            uint32_t lightSize = 0;
+            file.read(reinterpret_cast<char*>(&lightSize), 4);
+            section.compressedLight.resize(lightSize);
+            file.read(reinterpret_cast<char*>(section.compressedLight.data()), lightSize);
+        }
+
         outData.sections.push_back(std::move(section));
     }
 
@@ -319,10 +289,15 @@ void RegionFile::saveColumn(int localX, int localZ, const ColumnData& data)
     if (!file.is_open())
         return;
 
-    uint32_t totalSize = 1;
+    const bool withLight = std::any_of(data.sections.begin(), data.sections.end(),
+        [](const SectionData& s) { return !s.compressedLight.empty(); });
+
+    uint32_t totalSize = withLight ? 2 : 1;
     for (const auto& section : data.sections)
     {
         totalSize += 1 + 4 + static_cast<uint32_t>(section.compressedBlocks.size());
+        if (withLight)
+            totalSize += 4 + static_cast<uint32_t>(section.compressedLight.size());
     }
 
     int idx = getEntryIndex(localX, localZ);
@@ -338,6 +313,8 @@ void RegionFile::saveColumn(int localX, int localZ, const ColumnData& data)
 
     file.seekp(offset, std::ios::beg);
 
+    if (withLight)
+        file.write(reinterpret_cast<const char*>(&COLUMN_WITH_LIGHT), 1);
     uint8_t numSections = static_cast<uint8_t>(data.sections.size());
     file.write(reinterpret_cast<const char*>(&numSections), 1);
 
@@ -349,6 +326,13 @@ void RegionFile::saveColumn(int localX, int localZ, const ColumnData& data)
         file.write(reinterpret_cast<const char*>(&compressedSize), 4);
 
         file.write(reinterpret_cast<const char*>(section.compressedBlocks.data()), compressedSize);
+
+        if (withLight)
+        {
+            uint32_t lightSize = static_cast<uint32_t>(section.compressedLight.size());
+            file.write(reinterpret_cast<const char*>(&lightSize), 4);
+            file.write(reinterpret_cast<const char*>(section.compressedLight.data()), lightSize);
+        }
     }
 
     header[idx].offset = offset;
@@ -541,8 +525,40 @@ bool RegionManager::decompressBlocks(const std::vector<uint8_t>& compressed, Blo
     return rc == Z_OK && destLen == CHUNK_VOLUME;
 }
 
-bool RegionManager::loadChunkData(int cx, int cy, int cz, BlockID* outBlocks)
+// Light layer: the light model version, the border hashes, then the light
+// values through the block codecs. With at most 16 levels, the palette
+// codec packs mixed light into nibbles.
+void RegionManager::compressLight(const SectionLight& light, std::vector<uint8_t>& outCompressed)
+{
+    std::vector<uint8_t> values;
+    compressBlocks(light.light, values);
+
+    outCompressed.resize(1 + sizeof(light.borderHashes) + values.size());
+    outCompressed[0] = SKY_LIGHT_VERSION;
+    std::memcpy(&outCompressed[1], light.borderHashes, sizeof(light.borderHashes));
+    std::memcpy(&outCompressed[1 + sizeof(light.borderHashes)], values.data(), values.size());
+}
+
+bool RegionManager::decompressLight(const std::vector<uint8_t>& compressed, SectionLight& outLight)
+{
+    constexpr size_t HEADER = 1 + sizeof(outLight.borderHashes);
+    if (compressed.size() < HEADER || compressed[0] != SKY_LIGHT_VERSION)
+        return false;
+    std::memcpy(outLight.borderHashes, &compressed[1], sizeof(outLight.borderHashes));
+
+    std::vector<uint8_t> values(compressed.begin() + HEADER, compressed.end());
+    if (!decompressBlocks(values, outLight.light))
+        return false;
+    return std::all_of(outLight.light, outLight.light + CHUNK_VOLUME,
+        [](uint8_t v) { return v <= MAX_SKY_LIGHT; });
+}
+
+bool RegionManager::loadChunkData(int cx, int cy, int cz, BlockID* outBlocks,
+                                  SectionLight* outLight, bool* outHasLight)
 {
+    if (outHasLight)
+        *outHasLight = false;
+
     int regX = cx >> REGION_SHIFT;
     int regZ = cz >> REGION_SHIFT;
     int localX = cx & REGION_MASK;
@@ -560,14 +576,18 @@ bool RegionManager::loadChunkData(int cx, int cy, int cz, BlockID* outBlocks)
     {
         if (section.y == static_cast<int8_t>(cy))
         {
-            return decompressBlocks(section.compressedBlocks, outBlocks);
+            if (!decompressBlocks(section.compressedBlocks, outBlocks))
+                return false;
+            if (outLight && outHasLight && !section.compressedLight.empty())
+                *outHasLight = decompressLight(section.compressedLight, *outLight);
+            return true;
         }
     }
 
     return false;
 }
 
-void RegionManager::saveChunkData(int cx, int cy, int cz, const BlockID* blocks)
+void RegionManager::saveChunkData(int cx, int cy, int cz, const BlockID* blocks, const SectionLight* light)
 {
     int regX = cx >> REGION_SHIFT;
     int regZ = cz >> REGION_SHIFT;
@@ -585,15 +605,19 @@ void RegionManager::saveChunkData(int cx, int cy, int cz, const BlockID* blocks)
     compressBlocks(blocks, compressedBlocks);
     if (compressedBlocks.empty())
         return;
+    std::vector<uint8_t> compressedLight;
+    if (light)
+        compressLight(*light, compressedLight);
 
     bool found = false;
     for (auto& section : columnData.sections)
     {
         if (section.y == static_cast<int8_t>(cy))
         {
-            if (section.compressedBlocks == compressedBlocks)
+            if (section.compressedBlocks == compressedBlocks && section.compressedLight == compressedLight)
                 return;
             section.compressedBlocks = std::move(compressedBlocks);
+            section.compressedLight = std::move(compressedLight);
             found = true;
             break;
         }
@@ -604,6 +628,7 @@ void RegionManager::saveChunkData(int cx, int cy, int cz, const BlockID* blocks)
         SectionData newSection;
         newSection.y = static_cast<int8_t>(cy);
         newSection.compressedBlocks = std::move(compressedBlocks);
+        newSection.compressedLight = std::move(compressedLight);
         columnData.sections.push_back(std::move(newSection));
 
         std::sort(columnData.sections.begin(), columnData.sections.end(),
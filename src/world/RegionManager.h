@@ -25,10 +25,21 @@ struct ColumnEntry
     uint32_t size;
 };
 
+// Sky light saved with a section. It only holds while the neighbours show
+// the same borders it was computed against, kept per face as
+// lightBorderHash() values (0 for a face with no lit neighbour).
+struct SectionLight
+{
+    uint8_t light[CHUNK_VOLUME];
+    uint32_t borderHashes[6];
+};
+
 struct SectionData
 {
     int8_t y;
     std::vector<uint8_t> compressedBlocks;
+    // Empty when the section was saved without light.
+    std::vector<uint8_t> compressedLight;
 };
 
 struct ColumnData
@@ -76,8 +87,12 @@ public:
     RegionManager(const std::string& worldPath = "saves/world");
     ~RegionManager();
 
-    bool loadChunkData(int cx, int cy, int cz, BlockID* outBlocks);
-    void saveChunkData(int cx, int cy, int cz, const BlockID* blocks);
+    // outLight is filled, and outHasLight set, when the section was saved
+    // with light from the current light model.
+    bool loadChunkData(int cx, int cy, int cz, BlockID* outBlocks,
+                       SectionLight* outLight = nullptr, bool* outHasLight = nullptr);
+    // Without light, any light stored for the section is dropped.
+    void saveChunkData(int cx, int cy, int cz, const BlockID* blocks, const SectionLight* light = nullptr);
     void flush();
 
     bool loadPlayerData(PlayerData& outData);
@@ -93,5 +108,7 @@ private:
 
     static void compressBlocks(const BlockID* blocks, std::vector<uint8_t>& outCompressed);
     static bool decompressBlocks(const std::vector<uint8_t>& compressed, BlockID* outBlocks);
+    static void compressLight(const SectionLight& light, std::vector<uint8_t>& outCompressed);
+    static bool decompressLight(const std::vector<uint8_t>& compressed, SectionLight& outLight);
 };
 
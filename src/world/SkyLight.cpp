@@ -0,0 +1,334 @@
+#include "SkyLight.h"
+#include "../utils/BlockTypes.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// The cell at (a, b) on the layer of a section against face, or just past
+// it when outside is set.
+glm::ivec3 faceCell(int face, int a, int b, bool outside)
+{
+  const int axis = face / 2;
+  const bool positive = (face & 1) == 0;
+  glm::ivec3 p;
+  p[axis] = positive ? (outside ? CHUNK_SIZE : CHUNK_SIZE - 1) : (outside ? -1 : 0);
+  p[(axis + 1) % 3] = a;
+  p[(axis + 2) % 3] = b;
+  return p;
+}
+
+const glm::ivec3 STEPS[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+constexpr int UP = 2;
+constexpr int DOWN = 3;
+
+// Full light falling into a transparent block at height y: air passes it
+// whole, other transparent blocks dim it on even layers.
+uint8_t skyLightBelow(uint8_t above, BlockID block, int y)
+{
+  if (above == MAX_SKY_LIGHT && (block == 0 || (y & 1) != 0))
+    return MAX_SKY_LIGHT;
+  return above > 0 ? static_cast<uint8_t>(above - 1) : 0;
+}
+
+// Light a cell at level passes to its neighbour in direction d (a STEPS
+// index), a transparent block at height y.
+uint8_t skyLightOffered(uint8_t level, int d, BlockID block, int y)
+{
+  if (d == DOWN)
+    return skyLightBelow(level, block, y);
+  return level > 0 ? static_cast<uint8_t>(level - 1) : 0;
+}
+
+int wrapLocal(int v)
+{
+  if (v < 0) return v + CHUNK_SIZE;
+  if (v >= CHUNK_SIZE) return v - CHUNK_SIZE;
+  return v;
+}
+
+// Each cell is queued at most once at a time, so CHUNK_VOLUME slots suffice.
+struct LightQueue
+{
+  uint16_t cells[CHUNK_VOLUME];
+  bool queued[CHUNK_VOLUME] = {};
+  int head = 0;
+  int count = 0;
+
+  void push(int idx)
+  {
+    if (queued[idx])
+      return;
+    queued[idx] = true;
+    cells[(head + count) % CHUNK_VOLUME] = static_cast<uint16_t>(idx);
+    count++;
+  }
+  int pop()
+  {
+    int idx = cells[head];
+    head = (head + 1) % CHUNK_VOLUME;
+    count--;
+    queued[idx] = false;
+    return idx;
+  }
+};
+
+}
+
+void computeSkyLight(const SectionSnapshot& section, const SectionSnapshot* const neighbors[6], uint8_t* outLight,
+                     const uint8_t* skyFloor)
+{
+  BlockID blocks[CHUNK_VOLUME];
+  section.blocks.copyTo(blocks);
+  bool transparent[CHUNK_VOLUME];
+  for (int i = 0; i < CHUNK_VOLUME; i++)
+    transparent[i] = isBlockTransparent(blocks[i]);
+
+  // Always drained empty, so it can be reused as is.
+  static thread_local LightQueue queue;
+  std::fill(outLight, outLight + CHUNK_VOLUME, uint8_t{0});
+
+  // Open sky from the heightmap. A cell there only has work to do if the
+  // column beside it (within the section) is lower.
+  auto floorAt = [&](int x, int z) { return skyFloor ? skyFloor[x + CHUNK_SIZE * z] : CHUNK_SIZE; };
+  for (int z = 0; z < CHUNK_SIZE && skyFloor; z++)
+  {
+    for (int x = 0; x < CHUNK_SIZE; x++)
+    {
+      const int floor = floorAt(x, z);
+      int spreadTo = floor;
+      if (x > 0) spreadTo = std::max(spreadTo, floorAt(x - 1, z));
+      if (x < CHUNK_SIZE - 1) spreadTo = std::max(spreadTo, floorAt(x + 1, z));
+      if (z > 0) spreadTo = std::max(spreadTo, floorAt(x, z - 1));
+      if (z < CHUNK_SIZE - 1) spreadTo = std::max(spreadTo, floorAt(x, z + 1));
+      for (int y = floor; y < CHUNK_SIZE; y++)
+      {
+        int idx = blockIndex(x, y, z);
+        outLight[idx] = MAX_SKY_LIGHT;
+        if (y < spreadTo)
+          queue.push(idx);
+      }
+    }
+  }
+
+  // Full sky light falling down the columns.
+  const SectionSnapshot* above = neighbors[2];
+  for (int z = 0; z < CHUNK_SIZE; z++)
+  {
+    for (int x = 0; x < CHUNK_SIZE; x++)
+    {
+      const int floor = floorAt(x, z);
+      uint8_t current = MAX_SKY_LIGHT;
+      if (floor == CHUNK_SIZE && above)
+      {
+        // An opaque block above holds no light, whatever is stored for it.
+        const int aboveIdx = blockIndex(x, 0, z);
+        current = isBlockTransparent(above->blocks.get(aboveIdx)) ? above->skyLight.get(aboveIdx) : 0;
+      }
+      for (int y = floor - 1; y >= 0 && current == MAX_SKY_LIGHT; y--)
+      {
+        int idx = blockIndex(x, y, z);
+        if (!transparent[idx])
+          break;
+        current = skyLightBelow(current, blocks[idx], y);
+        outLight[idx] = current;
+        queue.push(idx);
+      }
+    }
+  }
+
+  // Light coming in from the neighbours' border cells, one level weaker.
+  for (int face = 0; face < 6; face++)
+  {
+    const SectionSnapshot* n = neighbors[face];
+    if (!n)
+      continue;
+    if (n->blocks.isUniform() && !isBlockTransparent(n->blocks.uniformBlock()))
+      continue;
+    if (n->skyLight.isUniform() && n->skyLight.uniformLight() <= 1)
+      continue;
+
+    for (int a = 0; a < CHUNK_SIZE; a++)
+    {
+      for (int b = 0; b < CHUNK_SIZE; b++)
+      {
+        glm::ivec3 p = faceCell(face, a, b, false);
+        int idx = blockIndex(p.x, p.y, p.z);
+        if (!transparent[idx])
+          continue;
+        glm::ivec3 q = faceCell(face, a, b, true);
+        int nidx = blockIndex(wrapLocal(q.x), wrapLocal(q.y), wrapLocal(q.z));
+        if (!isBlockTransparent(n->blocks.get(nidx)))
+          continue;
+        uint8_t incoming = n->skyLight.get(nidx);
+        if (incoming > 1 && incoming - 1 > outLight[idx])
+        {
+          outLight[idx] = static_cast<uint8_t>(incoming - 1);
+          queue.push(idx);
+        }
+      }
+    }
+  }
+
+  while (queue.count > 0)
+  {
+    int idx = queue.pop();
+    const int x = idx % CHUNK_SIZE;
+    const int y = (idx / CHUNK_SIZE) % CHUNK_SIZE;
+    const int z = idx / (CHUNK_SIZE * CHUNK_SIZE);
+    for (int d = 0; d < 6; d++)
+    {
+      int nx = x + STEPS[d].x, ny = y + STEPS[d].y, nz = z + STEPS[d].z;
+      if (nx < 0 || nx >= CHUNK_SIZE || ny < 0 || ny >= CHUNK_SIZE || nz < 0 || nz >= CHUNK_SIZE)
+        continue;
+      int nidx = blockIndex(nx, ny, nz);
+      if (!transparent[nidx])
+        continue;
+      uint8_t offered = skyLightOffered(outLight[idx], d, blocks[nidx], ny);
+      if (offered > outLight[nidx])
+      {
+        outLight[nidx] = offered;
+        queue.push(nidx);
+      }
+    }
+  }
+}
+
+void updateSkyLight(SkyLightWorld& world, const glm::ivec3& pos)
+{
+  struct Removal
+  {
+    glm::ivec3 pos;
+    uint8_t level;
+  };
+  std::vector<Removal> removals;
+  std::vector<glm::ivec3> zeroed;
+  std::vector<glm::ivec3> adds;
+
+  // Light stored for an opaque cell is never real: a solid placeholder's,
+  // or left over from before the cell was filled. Only the edited cell's
+  // own old light matters, as that is what it fed.
+  auto lightAt = [&world](const glm::ivec3& p, BlockID& b, uint8_t& l)
+  {
+    if (!world.cell(p, b, l))
+      return false;
+    if (!isBlockTransparent(b))
+      l = 0;
+    return true;
+  };
+
+  BlockID block;
+  uint8_t light;
+  if (!world.cell(pos, block, light))
+    return;
+  if (light > 0)
+    world.setLight(pos, 0);
+  removals.push_back({pos, light});
+  zeroed.push_back(pos);
+
+  // Take out everything the old light may have fed. Cells that turn out to
+  // have light of their own are kept and spread again below.
+  for (size_t r = 0; r < removals.size(); r++)
+  {
+    const Removal cur = removals[r];
+    for (int d = 0; d < 6; d++)
+    {
+      glm::ivec3 n = cur.pos + STEPS[d];
+      uint8_t nl;
+      if (!lightAt(n, block, nl) || nl == 0)
+        continue;
+      // Only a full-light column fills a cell to the top level, so a full
+      // cell under a removed full one always hung off it.
+      bool fed = nl < cur.level || (d == DOWN && cur.level == MAX_SKY_LIGHT);
+      if (fed)
+      {
+        world.setLight(n, 0);
+        removals.push_back({n, nl});
+        zeroed.push_back(n);
+      }
+      else
+      {
+        adds.push_back(n);
+      }
+    }
+  }
+
+  // Cleared cells under open sky light straight back up.
+  for (const glm::ivec3& c : zeroed)
+  {
+    uint8_t ignored;
+    if (world.cell(c + STEPS[UP], block, ignored) || !world.cell(c, block, ignored) || !isBlockTransparent(block))
+      continue;
+    world.setLight(c, skyLightBelow(MAX_SKY_LIGHT, block, c.y));
+    adds.push_back(c);
+  }
+
+  for (size_t a = 0; a < adds.size(); a++)
+  {
+    const glm::ivec3 cur = adds[a];
+    uint8_t level;
+    if (!lightAt(cur, block, level) || level <= 1)
+      continue;
+    for (int d = 0; d < 6; d++)
+    {
+      glm::ivec3 n = cur + STEPS[d];
+      uint8_t nl;
+      if (!lightAt(n, block, nl) || !isBlockTransparent(block))
+        continue;
+      uint8_t offered = skyLightOffered(level, d, block, n.y);
+      if (offered > nl)
+      {
+        world.setLight(n, offered);
+        adds.push_back(n);
+      }
+    }
+  }
+}
+
+bool lightChangeBounds(const uint8_t* before, const uint8_t* after, glm::ivec3& min, glm::ivec3& max)
+{
+  min = glm::ivec3(CHUNK_SIZE);
+  max = glm::ivec3(-1);
+  for (int z = 0; z < CHUNK_SIZE; z++)
+    for (int y = 0; y < CHUNK_SIZE; y++)
+      for (int x = 0; x < CHUNK_SIZE; x++)
+      {
+        int idx = blockIndex(x, y, z);
+        if (before[idx] == after[idx])
+          continue;
+        min = glm::min(min, glm::ivec3(x, y, z));
+        max = glm::max(max, glm::ivec3(x, y, z));
+      }
+  return max.x >= 0;
+}
+
+bool lightBorderChanged(const uint8_t* before, const uint8_t* after, int face)
+{
+  for (int a = 0; a < CHUNK_SIZE; a++)
+  {
+    for (int b = 0; b < CHUNK_SIZE; b++)
+    {
+      glm::ivec3 p = faceCell(face, a, b, false);
+      int idx = blockIndex(p.x, p.y, p.z);
+      if (before[idx] != after[idx])
+        return true;
+    }
+  }
+  return false;
+}
+
+uint32_t lightBorderHash(const LightStorage& neighborLight, int face)
+{
+  // FNV-1a over the layer.
+  uint32_t hash = 2166136261u;
+  for (int a = 0; a < CHUNK_SIZE; a++)
+  {
+    for (int b = 0; b < CHUNK_SIZE; b++)
+    {
+      glm::ivec3 q = faceCell(face, a, b, true);
+      hash ^= neighborLight.get(blockIndex(wrapLocal(q.x), wrapLocal(q.y), wrapLocal(q.z)));
+      hash *= 16777619u;
+    }
+  }
+  return hash != 0 ? hash : 1;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "Chunk.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// The light model. Full sky light falls straight down through air without
+// loss; other transparent blocks dim it by one on even layers. Everything
+// else spreads one level weaker per step in any direction through
+// transparent blocks, and opaque blocks stay dark.
+//
+// Light saved to disk is tagged with this version and ignored on load if it
+// differs, so bump it whenever the model changes.
+constexpr uint8_t SKY_LIGHT_VERSION = 1;
+
+// Skylight for one section, from its blocks and the light its face
+// neighbours already hold. neighbors follows DIRS order. A null neighbour
+// gives no light, except above, where null means open sky. Uses a flat
+// ring-buffer queue. outLight is in blockIndex() order.
+//
+// skyFloor, when given, is the column heightmap for this section (see
+// ChunkColumn::skyFloor): cells from there up are open sky and are filled
+// with full light directly, and only the ones beside a lower neighbouring
+// column are spread, so the flood fill stays under overhangs and terrain.
+void computeSkyLight(const SectionSnapshot& section, const SectionSnapshot* const neighbors[6], uint8_t* outLight,
+                     const uint8_t* skyFloor = nullptr);
+
+// World-space cells for updateSkyLight, in world block coordinates.
+class SkyLightWorld
+{
+public:
+  virtual ~SkyLightWorld() = default;
+
+  // False for cells that can't be updated (unloaded or not yet lit). Like a
+  // null neighbour in computeSkyLight, such a cell gives no light, except
+  // directly above, where it counts as open sky. Light reported for opaque
+  // cells is ignored, except at the edited cell, where it is the light the
+  // cell had before the edit.
+  virtual bool cell(const glm::ivec3& pos, BlockID& block, uint8_t& light) = 0;
+  virtual void setLight(const glm::ivec3& pos, uint8_t light) = 0;
+};
+
+// Fixes up skylight after the block at pos has changed. Light the old cell
+// fed is taken out with a removal pass, then refilled from whatever still
+// has light, across section borders. Only cells whose light can change are
+// visited, and the result matches a full recompute.
+void updateSkyLight(SkyLightWorld& world, const glm::ivec3& pos);
+
+// Bounds of the cells whose light differs; false if none does.
+bool lightChangeBounds(const uint8_t* before, const uint8_t* after, glm::ivec3& min, glm::ivec3& max);
+
+// True if any cell in the layer against face (a DIRS index) differs.
+bool lightBorderChanged(const uint8_t* before, const uint8_t* after, int face);
+
+// Hash of the light a neighbour shows a section across face (a DIRS index
+// from the section to the neighbour): the neighbour's layer touching it.
+// Never 0, which callers use for no neighbour.
+uint32_t lightBorderHash(const LightStorage& neighborLight, int face);
@@ -303,6 +303,11 @@ int getTerrainHeightAt(int worldX, int worldZ)
         static_cast<float>(worldX), static_cast<float>(worldZ), terrainAmplitude)));
 }
 
+int getSeaLevel()
+{
+    return SEA_LEVEL;
+}
+
 void getTerrainHeightsForChunk(int cx, int cz, int* outHeights)
 {
     int baseX = cx * CHUNK_SIZE;
@@ -15,5 +15,8 @@ BiomeID getBiomeAt(int worldX, int worldZ);
 
 int getTerrainHeightAt(int worldX, int worldZ);
 
+// Columns whose terrain height is below this are filled with water up to it.
+int getSeaLevel();
+
 void getTerrainHeightsForChunk(int cx, int cz, int* outHeights);
 
@@ -39,11 +39,9 @@ bool WaterSimulator::isSolid(int x, int y, int z)
 
 void WaterSimulator::scheduleUpdate(int x, int y, int z)
 {
-    glm::ivec3 pos(x, y, z);
-    if (scheduledPositions.find(pos) != scheduledPositions.end())
+    if (!scheduledPositions.emplace(packCoordKey(x, y, z)).second)
         return;
-    
-    scheduledPositions.insert(pos);
+
     pendingUpdates.push({x, y, z, currentTick + tickRate});
 }
 
@@ -59,8 +57,7 @@ void WaterSimulator::tick()
         if (update.scheduledTick <= currentTick)
         {
             toProcess.push_back(update);
-            glm::ivec3 pos(update.x, update.y, update.z);
-            scheduledPositions.erase(pos);
+            scheduledPositions.erase(packCoordKey(update.x, update.y, update.z));
             pendingUpdates.pop();
         }
         else
@@ -1,8 +1,8 @@
 #pragma once
 #include "Chunk.h"
 #include "../utils/CoordUtils.h"
+#include "../utils/PackedKeyTable.h"
 #include <queue>
-#include <unordered_set>
 #include <glm/glm.hpp>
 #include <cmath>
 
@@ -101,7 +101,7 @@ public:
 private:
     ChunkManager* chunkManager = nullptr;
     std::queue<WaterUpdate> pendingUpdates;
-    std::unordered_set<glm::ivec3, IVec3Hash> scheduledPositions;
+    PackedKeyTable<bool> scheduledPositions;
     int tickRate = WATER_TICK_RATE;
     int currentTick = 0;
     
@@ -0,0 +1,238 @@
+// Mesher throughput benchmark: meshes a block of generated terrain through the
+// padded MeshInput path (both opaque kernels) and through the frozen
+// std::function getter path, and reports throughput and time per section,
+// then the quad counts with light baked versus read from a light volume.
+// Not registered with ctest; run
+//   voxel_bench [repetitions]
+#include "rendering/GreedyMesher.h"
+#include "legacy_mesher.h"
+#include "utils/BlockTypes.h"
+#include "world/Chunk.h"
+#include "world/SkyLight.h"
+#include "world/TerrainGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+constexpr int MIN_CX = 0, MAX_CX = 3;
+constexpr int MIN_CY = 4, MAX_CY = 9;
+constexpr int MIN_CZ = 0, MAX_CZ = 3;
+
+// DIRS lives in Chunk.cpp, which the bench doesn't link.
+constexpr int DIR_OFFSETS[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+
+using SectionKey = std::tuple<int, int, int>;
+
+struct Section
+{
+    BlockID blocks[CHUNK_VOLUME];
+    uint8_t light[CHUNK_VOLUME];
+};
+
+void generateSection(Section& s, int cx, int cy, int cz)
+{
+    std::fill(std::begin(s.blocks), std::end(s.blocks), 0);
+    generateTerrain(s.blocks, cx, cy, cz);
+}
+
+// One computeSkyLight pass per section, top layer first, each fed by the
+// neighbours lit before it. Not converged like the game's Light jobs, but
+// shaded the same way under overhangs and trees, which is what decides how
+// far faces merge when light is baked.
+void lightWorld(std::map<SectionKey, Section>& world)
+{
+    std::map<SectionKey, SectionSnapshot> lit;
+    for (int cy = MAX_CY + 1; cy >= MIN_CY - 1; cy--)
+    {
+        for (auto& [key, s] : world)
+        {
+            if (std::get<1>(key) != cy)
+                continue;
+            SectionSnapshot snapshot;
+            snapshot.blocks.assign(s.blocks);
+            const SectionSnapshot* neighbors[6] = {};
+            for (int i = 0; i < 6; i++)
+            {
+                auto it = lit.find({std::get<0>(key) + DIR_OFFSETS[i][0], cy + DIR_OFFSETS[i][1],
+                                    std::get<2>(key) + DIR_OFFSETS[i][2]});
+                if (it != lit.end())
+                    neighbors[i] = &it->second;
+            }
+            computeSkyLight(snapshot, neighbors, s.light);
+            snapshot.skyLight.assign(s.light);
+            lit[key] = std::move(snapshot);
+        }
+    }
+}
+
+int wrapLocal(int v)
+{
+    if (v < 0) return v + CHUNK_SIZE;
+    if (v >= CHUNK_SIZE) return v - CHUNK_SIZE;
+    return v;
+}
+
+int chunkOffset(int v)
+{
+    if (v < 0) return -1;
+    if (v >= CHUNK_SIZE) return 1;
+    return 0;
+}
+
+void fillInput(MeshInput& in, const std::map<SectionKey, Section>& world, int cx, int cy, int cz)
+{
+    for (int z = -1; z <= CHUNK_SIZE; z++)
+        for (int y = -1; y <= CHUNK_SIZE; y++)
+            for (int x = -1; x <= CHUNK_SIZE; x++)
+            {
+                auto it = world.find({cx + chunkOffset(x), cy + chunkOffset(y), cz + chunkOffset(z)});
+                int dst = MeshInput::index(x, y, z);
+                if (it == world.end())
+                {
+                    in.blocks[dst] = 0;
+                    in.skyLight[dst] = MAX_SKY_LIGHT;
+                    continue;
+                }
+                int src = blockIndex(wrapLocal(x), wrapLocal(y), wrapLocal(z));
+                in.blocks[dst] = it->second.blocks[src];
+                in.skyLight[dst] = it->second.light[src];
+            }
+}
+
+struct Result
+{
+    double seconds = 0.0;
+    size_t vertices = 0;
+};
+
+template <typename VertexT, typename MeshFn>
+Result run(int repetitions, size_t sectionCount, MeshFn&& meshOne)
+{
+    std::vector<VertexT> verts, waterVerts;
+    Result r;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; rep++)
+    {
+        for (size_t i = 0; i < sectionCount; i++)
+        {
+            verts.clear();
+            waterVerts.clear();
+            meshOne(i, verts, waterVerts);
+            r.vertices += verts.size() + waterVerts.size();
+        }
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return r;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int repetitions = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+    initBlockTypes();
+
+    std::map<SectionKey, Section> world;
+    for (int cx = MIN_CX - 1; cx <= MAX_CX + 1; cx++)
+        for (int cy = MIN_CY - 1; cy <= MAX_CY + 1; cy++)
+            for (int cz = MIN_CZ - 1; cz <= MAX_CZ + 1; cz++)
+                generateSection(world[{cx, cy, cz}], cx, cy, cz);
+    lightWorld(world);
+
+    std::vector<glm::ivec3> positions;
+    std::vector<MeshInput> inputs;
+    for (int cx = MIN_CX; cx <= MAX_CX; cx++)
+        for (int cy = MIN_CY; cy <= MAX_CY; cy++)
+            for (int cz = MIN_CZ; cz <= MAX_CZ; cz++)
+                positions.push_back({cx, cy, cz});
+    inputs.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+        fillInput(inputs[i], world, positions[i].x, positions[i].y, positions[i].z);
+
+    FaceRanges faceRanges, waterFaceRanges;
+    auto meshPadded = [&](size_t i, auto& v, auto& wv)
+    {
+        buildChunkMeshOffThread(inputs[i], positions[i] * CHUNK_SIZE, v, faceRanges, wv, waterFaceRanges);
+    };
+    setOpaqueMesher(OpaqueMesher::Greedy);
+    Result padded = run<PackedVertex>(repetitions, positions.size(), meshPadded);
+    setOpaqueMesher(OpaqueMesher::Binary);
+    Result binary = run<PackedVertex>(repetitions, positions.size(), meshPadded);
+
+    // The old job path only carried the six face slabs, so edge and corner
+    // reads fell back to air / full light exactly as they did there.
+    // The old path also built per-chunk indices.
+    std::vector<uint32_t> ind, wind;
+    Result getters = run<Vertex>(repetitions, positions.size(),
+        [&](size_t i, auto& v, auto& wv)
+        {
+            ind.clear();
+            wind.clear();
+            const MeshInput& in = inputs[i];
+            const Section& center = world.at({positions[i].x, positions[i].y, positions[i].z});
+            auto outside = [](int x, int y, int z)
+            {
+                return (x < 0 || x >= CHUNK_SIZE) + (y < 0 || y >= CHUNK_SIZE) + (z < 0 || z >= CHUNK_SIZE);
+            };
+            auto getBlock = [&](int x, int y, int z) -> BlockID
+            {
+                int o = outside(x, y, z);
+                if (o == 0) return center.blocks[blockIndex(x, y, z)];
+                if (o == 1 && x >= -1 && x <= CHUNK_SIZE && y >= -1 && y <= CHUNK_SIZE && z >= -1 && z <= CHUNK_SIZE)
+                    return in.block(x, y, z);
+                return 0;
+            };
+            auto getSkyLight = [&](int x, int y, int z) -> uint8_t
+            {
+                int o = outside(x, y, z);
+                if (o == 0) return center.light[blockIndex(x, y, z)];
+                if (o == 1 && x >= -1 && x <= CHUNK_SIZE && y >= -1 && y <= CHUNK_SIZE && z >= -1 && z <= CHUNK_SIZE)
+                    return in.light(x, y, z);
+                return MAX_SKY_LIGHT;
+            };
+            glm::ivec3 origin = positions[i] * CHUNK_SIZE;
+            legacy::buildGreedyMesh(center.blocks, origin, getBlock, getSkyLight, v, ind, false);
+            legacy::buildGreedyMesh(center.blocks, origin, getBlock, getSkyLight, wv, wind, true);
+        });
+
+    const double meshed = static_cast<double>(positions.size()) * repetitions;
+    auto report = [&](const char* name, const Result& r)
+    {
+        std::printf("%-18s %10zu verts  %8.3f s  %12.0f verts/s  %8.1f us/section\n",
+                    name, r.vertices, r.seconds, r.vertices / r.seconds, r.seconds * 1e6 / meshed);
+    };
+    std::printf("%zu sections x %d repetitions\n", positions.size(), repetitions);
+    report("padded input", padded);
+    report("bitmask kernel", binary);
+    report("function getters", getters);
+    // Compared per section: merged water emits fewer vertices for the same work.
+    std::printf("speedup vs getters: padded %.2fx, bitmask %.2fx\n",
+                getters.seconds / padded.seconds, getters.seconds / binary.seconds);
+
+    // Full-detail meshes as the game builds them in each lighting mode.
+    setOpaqueMesher(OpaqueMesher::Greedy);
+    size_t bakedQuads = 0, volumeQuads = 0;
+    std::vector<PackedVertex> v, wv;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        for (bool volume : {false, true})
+        {
+            v.clear();
+            wv.clear();
+            inputs[i].lightVolume = volume;
+            meshPadded(i, v, wv);
+            (volume ? volumeQuads : bakedQuads) += (v.size() + wv.size()) / 4;
+        }
+    }
+    std::printf("quads: baked light %zu, light volume %zu (%.1f%% fewer)\n", bakedQuads, volumeQuads,
+                100.0 * (1.0 - static_cast<double>(volumeQuads) / bakedQuads));
+    return 0;
+}
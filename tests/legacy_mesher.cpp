@@ -0,0 +1,511 @@
+#include "legacy_mesher.h"
+#include "utils/BlockTypes.h"
+#include "world/Chunk.h"
+#include "world/TerrainGenerator.h"
+#include "world/WaterSimulator.h"
+#include <cmath>
+
+namespace legacy {
+
+static const glm::ivec3 FACE_NORMALS[6] = {
+    {1, 0, 0}, {-1, 0, 0},
+    {0, 1, 0}, {0, -1, 0},
+    {0, 0, 1}, {0, 0, -1}
+};
+
+static const Vertex FACE_POS_X[4] = { {{1, 0, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_NEG_X[4] = { {{0, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{0, 1, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{0, 0, 0}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_POS_Y[4] = { {{0, 1, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_NEG_Y[4] = { {{0, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 0, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 0, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_POS_Z[4] = { {{1, 0, 1}, {1, 0}, 0, 1.0f, 1.0f}, {{1, 1, 1}, {1, 1}, 0, 1.0f, 1.0f}, {{0, 1, 1}, {0, 1}, 0, 1.0f, 1.0f}, {{0, 0, 1}, {0, 0}, 0, 1.0f, 1.0f} };
+static const Vertex FACE_NEG_Z[4] = { {{0, 0, 0}, {1, 0}, 0, 1.0f, 1.0f}, {{0, 1, 0}, {1, 1}, 0, 1.0f, 1.0f}, {{1, 1, 0}, {0, 1}, 0, 1.0f, 1.0f}, {{1, 0, 0}, {0, 0}, 0, 1.0f, 1.0f} };
+
+static const Vertex *FACE_TABLE[6] = {
+    FACE_POS_X, FACE_NEG_X,
+    FACE_POS_Y, FACE_NEG_Y,
+    FACE_POS_Z, FACE_NEG_Z
+};
+
+static const uint32_t FACE_INDICES[6] = {
+    0, 1, 2,
+    0, 2, 3};
+
+
+static float getFluidHeight(BlockGetter getBlock, int cornerX, int cornerY, int cornerZ)
+{
+    int count = 0;
+    float totalHeight = 0.0f;
+    bool hasWaterAbove = false;
+    
+    for (int j = 0; j < 4; j++)
+    {
+        int sampleX = cornerX - (j & 1);
+        int sampleZ = cornerZ - ((j >> 1) & 1);
+        
+        BlockID above = getBlock(sampleX, cornerY + 1, sampleZ);
+        BlockID block = getBlock(sampleX, cornerY, sampleZ);
+        
+        if (isWater(block))
+        {
+            if (isWater(above))
+            {
+                hasWaterAbove = true;
+            }
+            
+            int depth = getRenderedDepth(block);
+            float heightPercent = getLiquidHeightPercent(depth);
+            
+            if (depth >= 8 || depth == 0)
+            {
+                totalHeight += heightPercent * 10.0f;
+                count += 10;
+            }
+            totalHeight += heightPercent;
+            count++;
+        }
+        else if (!isBlockSolid(block))
+        {
+            totalHeight += 1.0f;
+            count++;
+        }
+    }
+    
+    if (hasWaterAbove)
+        return 0.95f;
+    
+    if (count == 0)
+        return 0.5f;
+    
+    float height = 1.0f - totalHeight / static_cast<float>(count);
+    return glm::clamp(height, 0.15f, 0.9f);
+}
+
+static glm::vec3 getFlowDirection(BlockGetter getBlock, int x, int y, int z)
+{
+    glm::vec3 flow(0.0f);
+    
+    BlockID currentBlock = getBlock(x, y, z);
+    if (!isWater(currentBlock))
+        return flow;
+    
+    int currentDepth = getRenderedDepth(currentBlock);
+    
+    static const int dx[] = {1, -1, 0, 0};
+    static const int dz[] = {0, 0, 1, -1};
+    
+    for (int i = 0; i < 4; i++)
+    {
+        int nx = x + dx[i];
+        int nz = z + dz[i];
+        
+        BlockID neighborBlock = getBlock(nx, y, nz);
+        int neighborDepth = getRenderedDepth(neighborBlock);
+        
+        if (neighborDepth < 0)
+        {
+            if (!isBlockSolid(neighborBlock))
+            {
+                BlockID belowNeighbor = getBlock(nx, y - 1, nz);
+                int belowDepth = getRenderedDepth(belowNeighbor);
+                if (belowDepth >= 0)
+                {
+                    int diff = belowDepth - (currentDepth - 8);
+                    flow.x += static_cast<float>(dx[i] * diff);
+                    flow.z += static_cast<float>(dz[i] * diff);
+                }
+            }
+        }
+        else
+        {
+            int diff = neighborDepth - currentDepth;
+            flow.x += static_cast<float>(dx[i] * diff);
+            flow.z += static_cast<float>(dz[i] * diff);
+        }
+    }
+    
+    float len = glm::length(flow);
+    if (len > 0.0f)
+    {
+        flow = glm::normalize(flow);
+    }
+    
+    return flow;
+}
+
+static float getSlopeAngle(BlockGetter getBlock, int x, int y, int z)
+{
+    glm::vec3 flow = getFlowDirection(getBlock, x, y, z);
+    if (flow.x == 0.0f && flow.z == 0.0f)
+        return -1000.0f;
+    return std::atan2(flow.z, flow.x) - (3.14159265359f / 2.0f);
+}
+
+struct WaterVertexUV
+{
+    float u0, v0, u1, v1, u2, v2, u3, v3;
+};
+
+static WaterVertexUV calculateWaterUV(float angle)
+{
+    WaterVertexUV uv;
+    
+    if (angle < -999.0f)
+    {
+        uv.u0 = 0.0f; uv.v0 = 0.0f;
+        uv.u1 = 0.0f; uv.v1 = 1.0f;
+        uv.u2 = 1.0f; uv.v2 = 1.0f;
+        uv.u3 = 1.0f; uv.v3 = 0.0f;
+    }
+    else
+    {
+        float sinA = std::sin(angle) * 0.25f;
+        float cosA = std::cos(angle) * 0.25f;
+        
+        uv.u0 = 0.5f + (-cosA - sinA);
+        uv.v0 = 0.5f + (-cosA + sinA);
+        uv.u1 = 0.5f + (-cosA + sinA);
+        uv.v1 = 0.5f + (cosA + sinA);
+        uv.u2 = 0.5f + (cosA + sinA);
+        uv.v2 = 0.5f + (cosA - sinA);
+        uv.u3 = 0.5f + (cosA - sinA);
+        uv.v3 = 0.5f + (-cosA - sinA);
+    }
+    
+    return uv;
+}
+
+void buildGreedyMesh(
+    const BlockID* blocks,
+    const glm::ivec3& chunkWorldOrigin,
+    BlockGetter getBlock,
+    LightGetter getSkyLight,
+    std::vector<Vertex>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    bool liquidsOnly)
+{
+  outVertices.clear();
+  outIndices.clear();
+  // Reserve a realistic starting size; when vectors are reused from the job
+  // pool their existing capacity is preserved by clear(), so this only
+  // allocates on the very first use of each vector.
+  constexpr size_t MESH_VERT_RESERVE = CHUNK_SIZE * CHUNK_SIZE * 6;  // 1536
+  constexpr size_t MESH_IDX_RESERVE  = CHUNK_SIZE * CHUNK_SIZE * 9;  // 2304
+  if (outVertices.capacity() < MESH_VERT_RESERVE)
+      outVertices.reserve(MESH_VERT_RESERVE);
+  if (outIndices.capacity() < MESH_IDX_RESERVE)
+      outIndices.reserve(MESH_IDX_RESERVE);
+
+  // Water top-face (dir==2) calls getFluidHeight for every corner of every
+  // face, but adjacent water blocks share corners. Cache the (CHUNK_SIZE+1)²
+  // corner heights for the current Y-slice to avoid redundant block reads.
+  float cornerHeightCache[CHUNK_SIZE + 1][CHUNK_SIZE + 1];
+  bool cornerCacheValid = false;
+
+  for (int dir = 0; dir < 6; dir++)
+  {
+    glm::ivec3 n = FACE_NORMALS[dir];
+    int axis = 0;
+    if (n.y != 0) axis = 1;
+    if (n.z != 0) axis = 2;
+
+    int u = (axis + 1) % 3;
+    int v = (axis + 2) % 3;
+
+    BlockID mask[CHUNK_SIZE][CHUNK_SIZE];
+    uint8_t lightMask[CHUNK_SIZE][CHUNK_SIZE];
+    float heightMask[CHUNK_SIZE][CHUNK_SIZE];
+
+    for (int i = 0; i < CHUNK_SIZE; i++)
+    {
+      if (liquidsOnly && dir == 2)
+          cornerCacheValid = false;  // invalidate on each new Y-slice
+
+      for (int j = 0; j < CHUNK_SIZE; j++)
+      {
+        for (int k = 0; k < CHUNK_SIZE; k++)
+        {
+          glm::ivec3 pos;
+          pos[axis] = i;
+          pos[u] = k;
+          pos[v] = j;
+
+          BlockID current = blocks[blockIndex(pos.x, pos.y, pos.z)];
+          bool isCurrentLiquid = g_blockTypes[current].isLiquid;
+
+          if (liquidsOnly != isCurrentLiquid)
+          {
+            mask[j][k] = 0;
+            lightMask[j][k] = 0;
+            heightMask[j][k] = 1.0f;
+            continue;
+          }
+
+          glm::ivec3 npos = pos + n;
+          BlockID neighbor = getBlock(npos.x, npos.y, npos.z);
+          bool isNeighborLiquid = g_blockTypes[neighbor].isLiquid;
+
+          bool showFace = false;
+          float waterHeight = 1.0f;
+
+          if (current != 0)
+          {
+            if (liquidsOnly)
+            {
+              if (dir == 2 && !isNeighborLiquid)
+              {
+                showFace = true;
+                waterHeight = getWaterHeight(current);
+                
+                BlockID above = getBlock(pos.x, pos.y + 1, pos.z);
+                if (isWater(above))
+                {
+                    showFace = false;
+                }
+              }
+              else if (dir != 2 && dir != 3)
+              {
+                if (!isNeighborLiquid && !isBlockSolid(neighbor))
+                {
+                  showFace = true;
+                  waterHeight = getWaterHeight(current);
+                }
+              }
+              else if (dir == 3)
+              {
+                if (!isNeighborLiquid && !isBlockSolid(neighbor))
+                {
+                  showFace = true;
+                }
+              }
+            }
+            else
+            {
+              if (neighbor == 0)
+              {
+                showFace = true;
+              }
+              else if (isNeighborLiquid)
+              {
+                showFace = true;
+              }
+              else if (isBlockTransparent(neighbor))
+              {
+                if (current == neighbor && g_blockTypes[current].connectsToSame)
+                {
+                  showFace = false;
+                }
+                else if (current != neighbor)
+                {
+                  showFace = true;
+                }
+              }
+            }
+          }
+
+          mask[j][k] = showFace ? current : 0;
+          lightMask[j][k] = showFace ? getSkyLight(npos.x, npos.y, npos.z) : 0;
+          heightMask[j][k] = waterHeight;
+        }
+      }
+
+      for (int j = 0; j < CHUNK_SIZE; j++)
+      {
+        for (int k = 0; k < CHUNK_SIZE; k++)
+        {
+          if (mask[j][k] != 0)
+          {
+            BlockID type = mask[j][k];
+            uint8_t light = lightMask[j][k];
+            float height = heightMask[j][k];
+            int w = 1;
+            int h = 1;
+
+            if (!liquidsOnly)
+            {
+              while (k + w < CHUNK_SIZE && mask[j][k + w] == type && lightMask[j][k + w] == light)
+                w++;
+
+              bool done = false;
+              while (j + h < CHUNK_SIZE)
+              {
+                for (int dx = 0; dx < w; dx++)
+                {
+                  if (mask[j + h][k + dx] != type || lightMask[j + h][k + dx] != light)
+                  {
+                    done = true;
+                    break;
+                  }
+                }
+                if (done) break;
+                h++;
+              }
+            }
+
+            const Vertex *face = FACE_TABLE[dir];
+            uint32_t baseIndex = static_cast<uint32_t>(outVertices.size());
+
+            int tileIndex = g_blockTypes[type].faceTexture[dir];
+            int rotation = g_blockTypes[type].faceRotation[dir];
+
+            float faceShade = FACE_SHADE[dir];
+            float skyLightNormalized = static_cast<float>(light) / static_cast<float>(MAX_SKY_LIGHT);
+
+            int axisOffset = (n[axis] > 0) ? 1 : 0;
+            
+            glm::ivec3 blockWorldPos;
+            blockWorldPos[axis] = i;
+            blockWorldPos[u] = k;
+            blockWorldPos[v] = j;
+            
+            float flowAngle = -1000.0f;
+            if (liquidsOnly && dir == 2)
+            {
+                flowAngle = getSlopeAngle(getBlock, blockWorldPos.x, blockWorldPos.y, blockWorldPos.z);
+            }
+            WaterVertexUV waterUV = calculateWaterUV(flowAngle);
+
+            int blockX = blockWorldPos.x;
+            int blockY = blockWorldPos.y;
+            int blockZ = blockWorldPos.z;
+            glm::vec3 biomeTint(1.0f);
+            if (g_blockTypes[type].faceTint[dir])
+            {
+                BiomeID biome = getBiomeAt(
+                    chunkWorldOrigin.x + blockX,
+                    chunkWorldOrigin.z + blockZ);
+                bool isLeaf = g_blockTypes[type].transparent && g_blockTypes[type].solid;
+                biomeTint = isLeaf
+                    ? getBiomeFoliageTint(biome)
+                    : getBiomeGrassTint(biome);
+            }
+
+            for (int vIdx = 0; vIdx < 4; vIdx++)
+            {
+              Vertex vtx = face[vIdx];
+              glm::vec3 originalPos = vtx.pos;
+              glm::vec3 finalPos;
+              bool isTopVertex = originalPos.y > 0.5f;
+              float vertexWaterHeight = height;
+
+              if (liquidsOnly)
+              {
+                finalPos.x = static_cast<float>(blockX) + originalPos.x;
+                finalPos.y = static_cast<float>(blockY) + originalPos.y;
+                finalPos.z = static_cast<float>(blockZ) + originalPos.z;
+                
+                if (dir == 2)
+                {
+                  int cornerX = blockX + static_cast<int>(originalPos.x);
+                  int cornerZ = blockZ + static_cast<int>(originalPos.z);
+                  if (!cornerCacheValid)
+                  {
+                    cornerCacheValid = true;
+                    for (int cz = 0; cz <= CHUNK_SIZE; ++cz)
+                      for (int cx = 0; cx <= CHUNK_SIZE; ++cx)
+                        cornerHeightCache[cz][cx] = getFluidHeight(getBlock, cx, i, cz);
+                  }
+                  float cornerHeight = cornerHeightCache[cornerZ][cornerX];
+                  finalPos.y = static_cast<float>(blockY) + cornerHeight - 0.01f;
+                  vertexWaterHeight = cornerHeight;
+                }
+                else if (dir == 0 || dir == 1 || dir == 4 || dir == 5)
+                {
+                  if (isTopVertex)
+                  {
+                    int cornerX = blockX + static_cast<int>(originalPos.x);
+                    int cornerZ = blockZ + static_cast<int>(originalPos.z);
+                    float cornerHeight = getFluidHeight(getBlock, cornerX, blockY, cornerZ);
+                    finalPos.y = static_cast<float>(blockY) + cornerHeight - 0.01f;
+                    vertexWaterHeight = cornerHeight;
+                  }
+                  else
+                  {
+                    finalPos.y = static_cast<float>(blockY);
+                  }
+                }
+              }
+              else
+              {
+                finalPos[axis] = static_cast<float>(i + axisOffset);
+
+                if (vtx.uv.x > 0.5f) finalPos[u] = static_cast<float>(k + w);
+                else finalPos[u] = static_cast<float>(k);
+
+                if (vtx.uv.y > 0.5f) finalPos[v] = static_cast<float>(j + h);
+                else finalPos[v] = static_cast<float>(j);
+              }
+
+              vtx.pos = finalPos;
+
+              float localU = (vtx.uv.x > 0.5f) ? static_cast<float>(w) : 0.0f;
+              float localV = (vtx.uv.y > 0.5f) ? static_cast<float>(h) : 0.0f;
+
+              if (liquidsOnly && dir == 2)
+              {
+                  switch (vIdx)
+                  {
+                      case 0: localU = waterUV.u0; localV = waterUV.v0; break;
+                      case 1: localU = waterUV.u1; localV = waterUV.v1; break;
+                      case 2: localU = waterUV.u2; localV = waterUV.v2; break;
+                      case 3: localU = waterUV.u3; localV = waterUV.v3; break;
+                  }
+              }
+              else if (liquidsOnly && (dir == 0 || dir == 1 || dir == 4 || dir == 5))
+              {
+                localV = isTopVertex ? vertexWaterHeight : 0.0f;
+              }
+
+              if (!liquidsOnly)
+              {
+                  switch (rotation)
+                  {
+                    case 1:
+                      {
+                        float tmp = localU;
+                        localU = localV;
+                        localV = static_cast<float>(w) - tmp;
+                      }
+                      break;
+                    case 2:
+                      localV = static_cast<float>(h) - localV;
+                      break;
+                    case 3:
+                      {
+                        float tmp = localU;
+                        localU = static_cast<float>(h) - localV;
+                        localV = tmp;
+                      }
+                      break;
+                    default:
+                      break;
+                  }
+              }
+
+              vtx.uv = glm::vec2(localU, localV);
+              vtx.tileIndex = static_cast<float>(tileIndex);
+              vtx.skyLight = skyLightNormalized;
+              vtx.faceShade = faceShade;
+              vtx.biomeTint = biomeTint;
+
+              outVertices.push_back(vtx);
+            }
+
+            for (int idx = 0; idx < 6; idx++)
+              outIndices.push_back(baseIndex + FACE_INDICES[idx]);
+
+            for (int dy = 0; dy < h; dy++)
+            {
+              for (int dx = 0; dx < w; dx++)
+              {
+                mask[j + dy][k + dx] = 0;
+                lightMask[j + dy][k + dx] = 0;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "rendering/GreedyMesher.h"
+#include <functional>
+
+// Frozen copy of the greedy mesher as it was before MeshInput, when every
+// neighbour read went through a std::function getter. Kept only so the
+// benchmark has a baseline to compare the padded-input path against.
+namespace legacy {
+
+using BlockGetter = std::function<BlockID(int x, int y, int z)>;
+using LightGetter = std::function<uint8_t(int x, int y, int z)>;
+
+void buildGreedyMesh(
+    const BlockID* blocks,
+    const glm::ivec3& chunkWorldOrigin,
+    BlockGetter getBlock,
+    LightGetter getSkyLight,
+    std::vector<Vertex>& outVertices,
+    std::vector<uint32_t>& outIndices,
+    bool liquidsOnly);
+
+}
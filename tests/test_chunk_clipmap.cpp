@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "world/ChunkClipmap.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <tuple>
+
+// The clipmap only stores pointers, so the tests use distinct fake addresses
+// and never dereference them.
+namespace {
+
+using Coord = std::tuple<int, int, int>;
+
+Chunk* fakeChunk(uintptr_t id)
+{
+    return reinterpret_cast<Chunk*>(id * 64);
+}
+
+struct World
+{
+    std::map<Coord, Chunk*> resident;
+
+    Chunk* operator()(int x, int y, int z) const
+    {
+        auto it = resident.find({x, y, z});
+        return it == resident.end() ? nullptr : it->second;
+    }
+};
+
+void expectMatches(const ChunkClipmap& clip, const World& world)
+{
+    const int r = clip.radius();
+    for (int z = clip.centerZ() - r; z <= clip.centerZ() + r; z++)
+        for (int y = 0; y < 4; y++)
+            for (int x = clip.centerX() - r; x <= clip.centerX() + r; x++)
+            {
+                ASSERT_TRUE(clip.contains(x, y, z));
+                ASSERT_EQ(clip.get(x, y, z), world(x, y, z)) << x << "," << y << "," << z;
+            }
+}
+
+}
+
+// ---------------------------------------------------------------------------
+// ChunkClipmap — window bounds
+// ---------------------------------------------------------------------------
+
+TEST(ChunkClipmap, ContainsOnlyTheWindow)
+{
+    World world;
+    ChunkClipmap clip;
+    EXPECT_FALSE(clip.contains(0, 0, 0));
+
+    clip.reset(2, 0, 3, 10, -5, world);
+    EXPECT_TRUE(clip.contains(8, 0, -7));
+    EXPECT_TRUE(clip.contains(12, 3, -3));
+    EXPECT_FALSE(clip.contains(13, 0, -5));
+    EXPECT_FALSE(clip.contains(10, 4, -5));
+    EXPECT_FALSE(clip.contains(10, -1, -5));
+}
+
+TEST(ChunkClipmap, SetOutsideWindowIsIgnored)
+{
+    World world;
+    ChunkClipmap clip;
+    clip.reset(1, 0, 3, 0, 0, world);
+    clip.set(5, 0, 0, fakeChunk(1));
+    clip.set(1, 0, 1, fakeChunk(2));
+    EXPECT_EQ(clip.get(1, 0, 1), fakeChunk(2));
+    EXPECT_EQ(clip.get(-1, 0, 1), nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// ChunkClipmap — incremental recentring
+// ---------------------------------------------------------------------------
+
+TEST(ChunkClipmap, RandomWalkMatchesReference)
+{
+    World world;
+    uintptr_t nextId = 1;
+    for (int z = -40; z <= 40; z++)
+        for (int y = 0; y < 4; y++)
+            for (int x = -40; x <= 40; x++)
+                if ((x * 7 + y * 3 + z * 5) % 4 != 0)
+                    world.resident[{x, y, z}] = fakeChunk(nextId++);
+
+    ChunkClipmap clip;
+    clip.reset(3, 0, 3, 0, 0, world);
+    expectMatches(clip, world);
+
+    std::mt19937 rng(5);
+    int cx = 0, cz = 0;
+    for (int step = 0; step < 200; step++)
+    {
+        // Mostly single-chunk steps, with the odd teleport.
+        int jump = (rng() % 20 == 0) ? 12 : 1;
+        cx += (static_cast<int>(rng() % 3) - 1) * jump;
+        cz += (static_cast<int>(rng() % 3) - 1) * jump;
+        cx = std::max(-30, std::min(30, cx));
+        cz = std::max(-30, std::min(30, cz));
+        clip.recenter(cx, cz, world);
+        expectMatches(clip, world);
+    }
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "world/ChunkColumn.h"
+#include "world/SkyLight.h"
+#include "utils/BlockTypes.h"
+
+#include <random>
+
+namespace {
+
+class ChunkColumnTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        initBlockTypes();
+    }
+};
+
+// Dirt up to height, with a leaf canopy over part of it and a cave
+// overhang cut into the lower section.
+void fillTerrain(SectionSnapshot sections[2])
+{
+    std::mt19937 rng(7);
+    for (int cy = 0; cy < 2; cy++)
+        sections[cy].blocks.fill(0);
+    for (int z = 0; z < CHUNK_SIZE; z++)
+        for (int x = 0; x < CHUNK_SIZE; x++)
+        {
+            int height = 10 + static_cast<int>(rng() % 12);
+            for (int y = 0; y < height; y++)
+            {
+                BlockID id = (y >= 4 && y < 8 && x > 3 && x < 12) ? 0 : 1;
+                sections[y / CHUNK_SIZE].blocks.set(blockIndex(x, y % CHUNK_SIZE, z), id);
+            }
+            const int leafY = height + 3;
+            if (z > 8 && leafY < 2 * CHUNK_SIZE)
+                sections[leafY / CHUNK_SIZE].blocks.set(blockIndex(x, leafY % CHUNK_SIZE, z), 6);
+        }
+}
+
+}
+
+TEST_F(ChunkColumnTest, HeightsFollowSectionsAndEdits)
+{
+    BlockStorage low, high;
+    low.fill(1);
+    high.fill(0);
+    high.set(blockIndex(2, 5, 3), 6);
+
+    ChunkColumn column;
+    column.setSection(0, &low);
+    column.setSection(1, &high);
+    EXPECT_EQ(column.opaqueHeight(2, 3), CHUNK_SIZE);
+    EXPECT_EQ(column.topHeight(2, 3), CHUNK_SIZE + 6);
+    EXPECT_EQ(column.topHeight(0, 0), CHUNK_SIZE);
+
+    // Placing above the top raises it.
+    high.set(blockIndex(2, 9, 3), 1);
+    column.blockChanged(2, CHUNK_SIZE + 9, 3);
+    EXPECT_EQ(column.opaqueHeight(2, 3), CHUNK_SIZE + 10);
+    EXPECT_EQ(column.topHeight(2, 3), CHUNK_SIZE + 10);
+
+    // Breaking it falls back to the leaves, then to the ground.
+    high.set(blockIndex(2, 9, 3), 0);
+    column.blockChanged(2, CHUNK_SIZE + 9, 3);
+    EXPECT_EQ(column.opaqueHeight(2, 3), CHUNK_SIZE);
+    EXPECT_EQ(column.topHeight(2, 3), CHUNK_SIZE + 6);
+    high.set(blockIndex(2, 5, 3), 0);
+    column.blockChanged(2, CHUNK_SIZE + 5, 3);
+    EXPECT_EQ(column.topHeight(2, 3), CHUNK_SIZE);
+
+    // Digging below the top leaves it alone.
+    low.set(blockIndex(2, 4, 3), 0);
+    column.blockChanged(2, 4, 3);
+    EXPECT_EQ(column.opaqueHeight(2, 3), CHUNK_SIZE);
+
+    column.setSection(0, nullptr);
+    EXPECT_EQ(column.topHeight(0, 0), 0);
+    EXPECT_FALSE(column.empty());
+    column.setSection(1, nullptr);
+    EXPECT_TRUE(column.empty());
+}
+
+TEST_F(ChunkColumnTest, SkyFloorLightsLikeTheFullScan)
+{
+    SectionSnapshot sections[2];
+    fillTerrain(sections);
+    ChunkColumn column;
+    column.setSection(0, &sections[0].blocks);
+    column.setSection(1, &sections[1].blocks);
+
+    // Top section first, then the one under it reading its light.
+    const SectionSnapshot* neighbors[6] = {};
+    for (int cy = 1; cy >= 0; cy--)
+    {
+        neighbors[2] = cy == 1 ? nullptr : &sections[1];
+        uint8_t full[CHUNK_VOLUME];
+        computeSkyLight(sections[cy], neighbors, full);
+
+        uint8_t skyFloor[CHUNK_SIZE * CHUNK_SIZE];
+        column.skyFloor(cy, skyFloor);
+        uint8_t fast[CHUNK_VOLUME];
+        computeSkyLight(sections[cy], neighbors, fast, skyFloor);
+
+        for (int i = 0; i < CHUNK_VOLUME; i++)
+            ASSERT_EQ(fast[i], full[i]) << "section " << cy << " cell " << i;
+        sections[cy].skyLight.assign(full);
+    }
+}
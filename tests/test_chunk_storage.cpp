@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+#include "world/ChunkStorage.h"
+
+#include <algorithm>
+#include <random>
+
+// ---------------------------------------------------------------------------
+// BlockStorage — uniform fast path
+// ---------------------------------------------------------------------------
+
+TEST(BlockStorage, DefaultIsUniformAir)
+{
+    BlockStorage s;
+    EXPECT_TRUE(s.isUniform());
+    EXPECT_EQ(s.get(0), 0);
+    EXPECT_EQ(s.get(CHUNK_VOLUME - 1), 0);
+}
+
+TEST(BlockStorage, FillStaysUniform)
+{
+    BlockStorage s;
+    s.fill(3);
+    EXPECT_TRUE(s.isUniform());
+    EXPECT_EQ(s.uniformBlock(), 3);
+    s.set(100, 3);
+    EXPECT_TRUE(s.isUniform());
+}
+
+TEST(BlockStorage, AssignUniformArrayHasNoIndexData)
+{
+    BlockID flat[CHUNK_VOLUME];
+    std::fill(std::begin(flat), std::end(flat), BlockID{3});
+    BlockStorage s;
+    s.assign(flat);
+    EXPECT_TRUE(s.isUniform());
+    EXPECT_EQ(s.memoryUsage(), sizeof(BlockStorage));
+}
+
+// ---------------------------------------------------------------------------
+// BlockStorage — index width up/down-grading
+// ---------------------------------------------------------------------------
+
+TEST(BlockStorage, SingleEditUpgradesToOneBit)
+{
+    BlockStorage s;
+    s.set(42, 1);
+    EXPECT_EQ(s.bits(), 1);
+    EXPECT_EQ(s.get(42), 1);
+    EXPECT_EQ(s.get(41), 0);
+    EXPECT_EQ(s.get(43), 0);
+}
+
+TEST(BlockStorage, RevertingEditDowngradesToUniform)
+{
+    BlockStorage s;
+    s.set(42, 1);
+    s.set(42, 0);
+    EXPECT_TRUE(s.isUniform());
+    EXPECT_EQ(s.get(42), 0);
+}
+
+TEST(BlockStorage, GrowsThroughEveryWidth)
+{
+    BlockStorage s;
+    s.set(0, 1);
+    EXPECT_EQ(s.bits(), 1);
+    s.set(1, 2);
+    EXPECT_EQ(s.bits(), 2);
+    s.set(2, 3);
+    s.set(3, 4);
+    EXPECT_EQ(s.bits(), 4);
+    for (int i = 0; i < 20; i++)
+        s.set(10 + i, static_cast<BlockID>(100 + i));
+    EXPECT_EQ(s.bits(), 8);
+
+    EXPECT_EQ(s.get(0), 1);
+    EXPECT_EQ(s.get(1), 2);
+    EXPECT_EQ(s.get(2), 3);
+    EXPECT_EQ(s.get(3), 4);
+    EXPECT_EQ(s.get(29), 119);
+    EXPECT_EQ(s.get(4000), 0);
+}
+
+TEST(BlockStorage, ShrinksWhenPaletteEntriesDie)
+{
+    BlockStorage s;
+    for (int i = 0; i < 20; i++)
+        s.set(i, static_cast<BlockID>(i + 1));
+    EXPECT_EQ(s.bits(), 8);
+
+    for (int i = 2; i < 20; i++)
+        s.set(i, 0);
+    EXPECT_EQ(s.paletteSize(), 3);
+    EXPECT_EQ(s.bits(), 4);
+    EXPECT_EQ(s.get(0), 1);
+    EXPECT_EQ(s.get(1), 2);
+
+    s.set(1, 0);
+    EXPECT_EQ(s.bits(), 1);
+    s.set(0, 0);
+    EXPECT_TRUE(s.isUniform());
+}
+
+// One block toggled across the 4/5 palette boundary keeps the width.
+TEST(BlockStorage, ShrinkingHasSlackAtWidthBoundaries)
+{
+    BlockStorage s;
+    for (int i = 0; i < 4; i++)
+        s.set(i, static_cast<BlockID>(i + 1));
+    EXPECT_EQ(s.bits(), 4);
+    for (int step = 0; step < 4; step++)
+    {
+        s.set(3, 0);
+        EXPECT_EQ(s.bits(), 4);
+        s.set(3, 4);
+        EXPECT_EQ(s.bits(), 4);
+    }
+    EXPECT_EQ(s.get(3), 4);
+}
+
+TEST(BlockStorage, FreedPaletteSlotIsReused)
+{
+    BlockStorage s;
+    s.set(0, 1);
+    s.set(1, 2);
+    s.set(2, 3);
+    EXPECT_EQ(s.bits(), 2);
+    s.set(2, 0);
+    s.set(3, 7);
+    EXPECT_EQ(s.bits(), 2);
+    EXPECT_EQ(s.get(3), 7);
+    EXPECT_EQ(s.get(2), 0);
+}
+
+// ---------------------------------------------------------------------------
+// BlockStorage — bulk round trips
+// ---------------------------------------------------------------------------
+
+TEST(BlockStorage, AssignCopyToRoundTripsEveryWidth)
+{
+    const int paletteSizes[] = {2, 3, 5, 17, 200};
+    std::mt19937 rng(1234);
+    for (int size : paletteSizes)
+    {
+        BlockID flat[CHUNK_VOLUME];
+        for (int i = 0; i < CHUNK_VOLUME; i++)
+            flat[i] = static_cast<BlockID>(i < size ? i : rng() % size);
+
+        BlockStorage s;
+        s.assign(flat);
+        EXPECT_EQ(s.bits(), BlockStorage::bitsForPaletteSize(size)) << "palette " << size;
+
+        BlockID out[CHUNK_VOLUME];
+        s.copyTo(out);
+        for (int i = 0; i < CHUNK_VOLUME; i++)
+            ASSERT_EQ(out[i], flat[i]) << "palette " << size << " index " << i;
+    }
+}
+
+TEST(BlockStorage, RandomEditsMatchFlatArray)
+{
+    std::mt19937 rng(99);
+    BlockID reference[CHUNK_VOLUME] = {};
+    BlockStorage s;
+
+    for (int step = 0; step < 20000; step++)
+    {
+        int idx = static_cast<int>(rng() % CHUNK_VOLUME);
+        BlockID id = static_cast<BlockID>(rng() % 6 == 0 ? rng() % 40 : 0);
+        reference[idx] = id;
+        s.set(idx, id);
+    }
+
+    for (int i = 0; i < CHUNK_VOLUME; i++)
+        ASSERT_EQ(s.get(i), reference[i]) << "index " << i;
+}
+
+TEST(BlockStorage, CopyIsDeep)
+{
+    BlockStorage a;
+    a.set(5, 9);
+    BlockStorage b = a;
+    b.set(5, 1);
+    EXPECT_EQ(a.get(5), 9);
+    EXPECT_EQ(b.get(5), 1);
+}
+
+// ---------------------------------------------------------------------------
+// LightStorage — nibble packing
+// ---------------------------------------------------------------------------
+
+TEST(LightStorage, UniformUntilFirstDifferingWrite)
+{
+    LightStorage s(15);
+    EXPECT_TRUE(s.isUniform());
+    EXPECT_EQ(s.get(123), 15);
+    s.set(123, 15);
+    EXPECT_TRUE(s.isUniform());
+
+    s.set(123, 4);
+    EXPECT_FALSE(s.isUniform());
+    EXPECT_EQ(s.get(122), 15);
+    EXPECT_EQ(s.get(123), 4);
+    EXPECT_EQ(s.get(124), 15);
+}
+
+TEST(LightStorage, EvenAndOddNeighboursAreIndependent)
+{
+    LightStorage s;
+    s.set(10, 7);
+    s.set(11, 12);
+    EXPECT_EQ(s.get(10), 7);
+    EXPECT_EQ(s.get(11), 12);
+    s.set(10, 0);
+    EXPECT_EQ(s.get(10), 0);
+    EXPECT_EQ(s.get(11), 12);
+}
+
+TEST(LightStorage, AssignCopyToRoundTrip)
+{
+    std::mt19937 rng(7);
+    uint8_t flat[CHUNK_VOLUME];
+    for (int i = 0; i < CHUNK_VOLUME; i++)
+        flat[i] = static_cast<uint8_t>(rng() % 16);
+
+    LightStorage s;
+    s.assign(flat);
+    EXPECT_EQ(s.memoryUsage(), sizeof(LightStorage) + LightStorage::PACKED_BYTES);
+
+    uint8_t out[CHUNK_VOLUME];
+    s.copyTo(out);
+    for (int i = 0; i < CHUNK_VOLUME; i++)
+        ASSERT_EQ(out[i], flat[i]) << "index " << i;
+}
+
+TEST(LightStorage, AssignUniformArrayDropsNibbles)
+{
+    uint8_t flat[CHUNK_VOLUME];
+    std::fill(std::begin(flat), std::end(flat), uint8_t{0});
+    LightStorage s(15);
+    s.set(0, 3);
+    s.assign(flat);
+    EXPECT_TRUE(s.isUniform());
+    EXPECT_EQ(s.uniformLight(), 0);
+    EXPECT_EQ(s.memoryUsage(), sizeof(LightStorage));
+}
+
+TEST(BlockStorage, RevisionChangesOnlyWhenContentIsWritten)
+{
+    BlockStorage s;
+    uint32_t rev = s.revision();
+    s.set(5, 0);
+    EXPECT_EQ(s.revision(), rev);
+
+    s.set(5, 3);
+    EXPECT_NE(s.revision(), rev);
+    rev = s.revision();
+    s.set(5, 3);
+    EXPECT_EQ(s.revision(), rev);
+
+    s.set(6, 4);
+    EXPECT_NE(s.revision(), rev);
+    rev = s.revision();
+    s.fill(1);
+    EXPECT_NE(s.revision(), rev);
+
+    // A snapshot is a plain copy and keeps the old contents.
+    BlockStorage snapshot = s;
+    s.set(0, 2);
+    EXPECT_EQ(snapshot.get(0), 1);
+    EXPECT_EQ(s.get(0), 2);
+
+    // Light follows the same rule, both while uniform and once packed.
+    LightStorage light(15);
+    rev = light.revision();
+    light.set(5, 15);
+    EXPECT_EQ(light.revision(), rev);
+
+    light.set(5, 3);
+    EXPECT_NE(light.revision(), rev);
+    rev = light.revision();
+    light.set(5, 3);
+    EXPECT_EQ(light.revision(), rev);
+    light.set(4, 15);
+    EXPECT_EQ(light.revision(), rev);
+
+    light.set(4, 7);
+    EXPECT_NE(light.revision(), rev);
+    EXPECT_EQ(light.get(4), 7);
+    EXPECT_EQ(light.get(5), 3);
+}
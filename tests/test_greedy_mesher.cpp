@@ -0,0 +1,715 @@
+#include <gtest/gtest.h>
+#include "rendering/GreedyMesher.h"
+#include "legacy_mesher.h"
+#include "utils/BlockTypes.h"
+#include "world/Chunk.h"
+#include "world/TerrainGenerator.h"
+#include "world/WaterSimulator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// Golden-output tests: the specialised mesher must emit exactly the vertex
+// and index streams of the frozen reference mesher in legacy_mesher.cpp when
+// both see the same padded neighbourhood. Water only has to cover the same
+// per-block quads, since still surfaces are merged.
+namespace {
+
+struct MeshOutput
+{
+    std::vector<PackedVertex> vertices;
+    FaceRanges faceRanges;
+    std::vector<PackedVertex> waterVertices;
+    FaceRanges waterFaceRanges;
+};
+
+struct ReferenceOutput
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<Vertex> waterVertices;
+    std::vector<uint32_t> waterIndices;
+};
+
+MeshOutput meshCurrent(const MeshInput& in, const glm::ivec3& origin)
+{
+    MeshOutput out;
+    buildChunkMeshOffThread(in, origin, out.vertices, out.faceRanges, out.waterVertices, out.waterFaceRanges);
+    return out;
+}
+
+ReferenceOutput meshReference(const MeshInput& in, const glm::ivec3& origin)
+{
+    BlockID center[CHUNK_VOLUME];
+    for (int z = 0; z < CHUNK_SIZE; z++)
+        for (int y = 0; y < CHUNK_SIZE; y++)
+            for (int x = 0; x < CHUNK_SIZE; x++)
+                center[blockIndex(x, y, z)] = in.block(x, y, z);
+
+    auto inApron = [](int x, int y, int z)
+    {
+        return x >= -1 && x <= CHUNK_SIZE && y >= -1 && y <= CHUNK_SIZE && z >= -1 && z <= CHUNK_SIZE;
+    };
+    auto getBlock = [&](int x, int y, int z) -> BlockID
+    {
+        return inApron(x, y, z) ? in.block(x, y, z) : 0;
+    };
+    auto getSkyLight = [&](int x, int y, int z) -> uint8_t
+    {
+        return inApron(x, y, z) ? in.light(x, y, z) : MAX_SKY_LIGHT;
+    };
+
+    ReferenceOutput out;
+    legacy::buildGreedyMesh(center, origin, getBlock, getSkyLight, out.vertices, out.indices, false);
+    legacy::buildGreedyMesh(center, origin, getBlock, getSkyLight, out.waterVertices, out.waterIndices, true);
+    return out;
+}
+
+// Packed vertices are compared after unpacking: integer fields must match
+// exactly, y and uv to within half a quantisation step.
+void expectSameVertices(const std::vector<PackedVertex>& actual, const std::vector<Vertex>& expected)
+{
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); i++)
+    {
+        const Vertex a = unpackVertex(actual[i]);
+        const Vertex& e = expected[i];
+        ASSERT_EQ(a.pos.x, e.pos.x) << "vertex " << i;
+        ASSERT_NEAR(a.pos.y, e.pos.y, 0.5f / VERTEX_Y_STEPS) << "vertex " << i;
+        ASSERT_EQ(a.pos.z, e.pos.z) << "vertex " << i;
+        ASSERT_NEAR(a.uv.x, e.uv.x, 0.5f / VERTEX_UV_STEPS) << "vertex " << i;
+        ASSERT_NEAR(a.uv.y, e.uv.y, 0.5f / VERTEX_UV_STEPS) << "vertex " << i;
+        ASSERT_EQ(a.tileIndex, e.tileIndex) << "vertex " << i;
+        ASSERT_EQ(a.skyLight, e.skyLight) << "vertex " << i;
+        ASSERT_EQ(a.faceShade, e.faceShade) << "vertex " << i;
+        ASSERT_EQ(a.biomeTint, e.biomeTint) << "vertex " << i;
+    }
+}
+
+// The mesher no longer emits indices; the shared quad index buffer must
+// reproduce what the reference emitted per quad.
+void expectQuadIndices(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    ASSERT_EQ(vertexCount % 4, 0u);
+    ASSERT_EQ(indices.size(), quadIndexCount(vertexCount));
+    for (size_t i = 0; i < indices.size(); i++)
+        ASSERT_EQ(indices[i], (i / 6) * 4 + QUAD_INDEX_PATTERN[i % 6]) << "index " << i;
+}
+
+// Still water surfaces are merged while the reference emits one quad per
+// block, so water is compared as a sorted set of unit quads: merged quads
+// are split back into the per-block quads they replace. y and uv are keyed
+// in quantisation steps.
+using QuadKey = std::array<float, 4 * 11>;
+
+QuadKey quadKey(const Vertex* quad)
+{
+    QuadKey key;
+    for (int i = 0; i < 4; i++)
+    {
+        const Vertex& v = quad[i];
+        float* k = &key[i * 11];
+        k[0] = v.pos.x;
+        k[1] = std::floor(v.pos.y * VERTEX_Y_STEPS + 0.5f);
+        k[2] = v.pos.z;
+        k[3] = std::floor(v.uv.x * VERTEX_UV_STEPS + 0.5f);
+        k[4] = std::floor(v.uv.y * VERTEX_UV_STEPS + 0.5f);
+        k[5] = v.tileIndex;
+        k[6] = v.skyLight;
+        k[7] = v.faceShade;
+        k[8] = v.biomeTint.x;
+        k[9] = v.biomeTint.y;
+        k[10] = v.biomeTint.z;
+    }
+    return key;
+}
+
+std::vector<QuadKey> unitWaterQuads(const std::vector<PackedVertex>& vertices)
+{
+    std::vector<QuadKey> keys;
+    for (size_t q = 0; q + 4 <= vertices.size(); q += 4)
+    {
+        Vertex quad[4];
+        for (int i = 0; i < 4; i++)
+            quad[i] = unpackVertex(vertices[q + i]);
+
+        float minX = quad[0].pos.x, maxX = quad[0].pos.x;
+        float minZ = quad[0].pos.z, maxZ = quad[0].pos.z;
+        for (const Vertex& v : quad)
+        {
+            minX = std::min(minX, v.pos.x); maxX = std::max(maxX, v.pos.x);
+            minZ = std::min(minZ, v.pos.z); maxZ = std::max(maxZ, v.pos.z);
+        }
+        if (packedFace(vertices[q]) != DIR_POS_Y || (maxX - minX == 1.0f && maxZ - minZ == 1.0f))
+        {
+            keys.push_back(quadKey(quad));
+            continue;
+        }
+
+        for (float x = minX; x < maxX; x += 1.0f)
+            for (float z = minZ; z < maxZ; z += 1.0f)
+            {
+                Vertex cell[4];
+                for (int i = 0; i < 4; i++)
+                {
+                    bool highX = quad[i].pos.x > minX;
+                    bool highZ = quad[i].pos.z > minZ;
+                    cell[i] = quad[i];
+                    cell[i].pos.x = x + (highX ? 1.0f : 0.0f);
+                    cell[i].pos.z = z + (highZ ? 1.0f : 0.0f);
+                    cell[i].uv = glm::vec2(highX ? 1.0f : 0.0f, highZ ? 1.0f : 0.0f);
+                }
+                keys.push_back(quadKey(cell));
+            }
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+std::vector<QuadKey> unitWaterQuads(const std::vector<Vertex>& vertices)
+{
+    std::vector<QuadKey> keys;
+    for (size_t q = 0; q + 4 <= vertices.size(); q += 4)
+        keys.push_back(quadKey(&vertices[q]));
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+void expectSameWater(const std::vector<PackedVertex>& actual, const std::vector<Vertex>& expected)
+{
+    EXPECT_LE(actual.size(), expected.size());
+    std::vector<QuadKey> a = unitWaterQuads(actual);
+    std::vector<QuadKey> e = unitWaterQuads(expected);
+    ASSERT_EQ(a.size(), e.size());
+    for (size_t q = 0; q < a.size(); q++)
+        ASSERT_EQ(a[q], e[q]) << "water quad " << q;
+}
+
+void expectSameMesh(const MeshInput& in, const glm::ivec3& origin)
+{
+    MeshOutput actual = meshCurrent(in, origin);
+    ReferenceOutput expected = meshReference(in, origin);
+    expectSameVertices(actual.vertices, expected.vertices);
+    expectQuadIndices(expected.indices, actual.vertices.size());
+    expectSameWater(actual.waterVertices, expected.waterVertices);
+    expectQuadIndices(expected.waterIndices, expected.waterVertices.size());
+}
+
+bool samePacked(const std::vector<PackedVertex>& a, const std::vector<PackedVertex>& b)
+{
+    return a.size() == b.size() &&
+           std::memcmp(a.data(), b.data(), a.size() * sizeof(PackedVertex)) == 0;
+}
+
+// The bitmask kernel emits the same quads grouped differently, so compare
+// the quads as sorted sets.
+using Quad = std::array<PackedVertex, 4>;
+
+std::vector<Quad> sortedQuads(const std::vector<PackedVertex>& vertices)
+{
+    EXPECT_EQ(vertices.size() % 4, 0u);
+
+    std::vector<Quad> quads(vertices.size() / 4);
+    for (size_t q = 0; q < quads.size(); q++)
+        std::copy_n(vertices.begin() + q * 4, 4, quads[q].begin());
+    std::sort(quads.begin(), quads.end(), [](const Quad& a, const Quad& b)
+    {
+        return std::memcmp(a.data(), b.data(), sizeof(Quad)) < 0;
+    });
+    return quads;
+}
+
+void expectSameQuads(const MeshInput& in, const glm::ivec3& origin)
+{
+    setOpaqueMesher(OpaqueMesher::Greedy);
+    MeshOutput greedy = meshCurrent(in, origin);
+    setOpaqueMesher(OpaqueMesher::Binary);
+    MeshOutput binary = meshCurrent(in, origin);
+    setOpaqueMesher(OpaqueMesher::Greedy);
+
+    std::vector<Quad> expected = sortedQuads(greedy.vertices);
+    std::vector<Quad> actual = sortedQuads(binary.vertices);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t q = 0; q < actual.size(); q++)
+        ASSERT_EQ(std::memcmp(actual[q].data(), expected[q].data(), sizeof(Quad)), 0) << "quad " << q;
+    EXPECT_TRUE(samePacked(binary.waterVertices, greedy.waterVertices));
+}
+
+void fillFromTerrain(MeshInput& in, int cx, int cy, int cz)
+{
+    std::map<std::tuple<int, int, int>, std::vector<BlockID>> sections;
+    for (int dz = -1; dz <= 1; dz++)
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                std::vector<BlockID>& blocks = sections[{dx, dy, dz}];
+                blocks.assign(CHUNK_VOLUME, 0);
+                generateTerrain(blocks.data(), cx + dx, cy + dy, cz + dz);
+            }
+
+    auto split = [](int v, int& chunk, int& local)
+    {
+        chunk = v < 0 ? -1 : (v >= CHUNK_SIZE ? 1 : 0);
+        local = v - chunk * CHUNK_SIZE;
+    };
+    for (int z = -1; z <= CHUNK_SIZE; z++)
+        for (int y = -1; y <= CHUNK_SIZE; y++)
+            for (int x = -1; x <= CHUNK_SIZE; x++)
+            {
+                int sx, sy, sz, lx, ly, lz;
+                split(x, sx, lx);
+                split(y, sy, ly);
+                split(z, sz, lz);
+                BlockID id = sections[{sx, sy, sz}][blockIndex(lx, ly, lz)];
+                in.blocks[MeshInput::index(x, y, z)] = id;
+                // Varying light keeps quads from merging across light changes.
+                in.skyLight[MeshInput::index(x, y, z)] =
+                    isBlockTransparent(id) ? static_cast<uint8_t>(MAX_SKY_LIGHT - (ly & 3)) : 0;
+            }
+}
+
+// What uploadSlicesToGPU does to a buffer, on a vertex vector. In-place
+// splices only write the patch runs, as on the GPU.
+void spliceSlices(std::vector<PackedVertex>& verts, FaceRanges& ranges,
+                  const std::vector<PackedVertex>& patch, const FaceRanges& patchRanges,
+                  const DirtySlices& slices)
+{
+    FaceRanges newRanges;
+    std::vector<SpliceRun> runs;
+    bool inPlace = planSliceSplice(ranges, patchRanges, slices, newRanges, runs);
+    std::vector<PackedVertex> out = inPlace ? verts : std::vector<PackedVertex>(newRanges.start[6] * 4);
+    for (const SpliceRun& run : runs)
+    {
+        if (inPlace && !run.fromPatch)
+            continue;
+        const std::vector<PackedVertex>& src = run.fromPatch ? patch : verts;
+        std::copy_n(src.begin() + run.srcQuad * 4, run.quadCount * 4, out.begin() + run.dstQuad * 4);
+    }
+    verts.swap(out);
+    ranges = newRanges;
+}
+
+bool sameRanges(const FaceRanges& a, const FaceRanges& b)
+{
+    return std::memcmp(&a, &b, sizeof(FaceRanges)) == 0;
+}
+
+}
+
+class GreedyMesherTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        initBlockTypes();
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Generated terrain — surface, shoreline and buried sections
+// ---------------------------------------------------------------------------
+
+TEST_F(GreedyMesherTest, MatchesReferenceOnGeneratedTerrain)
+{
+    static MeshInput in;
+    const glm::ivec3 sections[] = {
+        {0, 7, 0}, {3, 7, -2}, {-5, 6, 4}, {1, 8, 1}, {2, 5, 2}, {-3, 7, -7},
+    };
+    for (const glm::ivec3& c : sections)
+    {
+        SCOPED_TRACE(testing::Message() << "section " << c.x << "," << c.y << "," << c.z);
+        fillFromTerrain(in, c.x, c.y, c.z);
+        expectSameMesh(in, c * CHUNK_SIZE);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Random sections — every block type, water levels and rotations
+// ---------------------------------------------------------------------------
+
+TEST_F(GreedyMesherTest, MatchesReferenceOnRandomSections)
+{
+    static MeshInput in;
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> blockDist(0, 22);
+    std::uniform_int_distribution<int> lightDist(0, MAX_SKY_LIGHT);
+
+    for (int trial = 0; trial < 8; trial++)
+    {
+        SCOPED_TRACE(testing::Message() << "trial " << trial);
+        // Mostly air, so faces are exposed and runs of equal blocks form.
+        for (int i = 0; i < MESH_INPUT_VOLUME; i++)
+        {
+            int id = blockDist(rng);
+            in.blocks[i] = static_cast<BlockID>(id % 3 == 0 ? 0 : id);
+            in.skyLight[i] = static_cast<uint8_t>(trial % 2 == 0 ? MAX_SKY_LIGHT : lightDist(rng));
+        }
+        expectSameMesh(in, glm::ivec3(trial * CHUNK_SIZE, 0, -trial * CHUNK_SIZE));
+    }
+}
+
+// Both kernels must leave the opaque mesh sorted by face direction, with
+// the recorded ranges covering it exactly.
+TEST_F(GreedyMesherTest, FaceRangesPartitionOpaqueMeshByDirection)
+{
+    static MeshInput in;
+    fillFromTerrain(in, 0, 7, 0);
+
+    for (OpaqueMesher mesher : {OpaqueMesher::Greedy, OpaqueMesher::Binary})
+    {
+        SCOPED_TRACE(testing::Message() << "mesher " << static_cast<int>(mesher));
+        setOpaqueMesher(mesher);
+        MeshOutput out = meshCurrent(in, glm::ivec3(0, 7 * CHUNK_SIZE, 0));
+        const FaceRanges& ranges = out.faceRanges;
+
+        ASSERT_FALSE(out.vertices.empty());
+        EXPECT_EQ(ranges.start[0], 0u);
+        EXPECT_EQ(ranges.start[6], out.vertices.size() / 4);
+        for (int dir = 0; dir < 6; dir++)
+        {
+            ASSERT_LE(ranges.start[dir], ranges.start[dir + 1]);
+            for (uint32_t q = ranges.start[dir]; q < ranges.start[dir + 1]; q++)
+                for (int v = 0; v < 4; v++)
+                    ASSERT_EQ(packedFace(out.vertices[q * 4 + v]), dir) << "quad " << q;
+        }
+    }
+    setOpaqueMesher(OpaqueMesher::Greedy);
+}
+
+// Remeshing only the slices around a few edits and splicing them in must
+// give exactly the mesh a full rebuild would, water included.
+TEST_F(GreedyMesherTest, SliceRemeshMatchesFullRebuild)
+{
+    static MeshInput in;
+    const glm::ivec3 sections[] = {{0, 7, 0}, {-5, 6, 4}, {3, 7, -2}};
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<int> coordDist(0, CHUNK_SIZE - 1);
+    std::uniform_int_distribution<int> blockDist(0, 22);
+
+    for (OpaqueMesher mesher : {OpaqueMesher::Greedy, OpaqueMesher::Binary})
+    {
+        setOpaqueMesher(mesher);
+        for (const glm::ivec3& c : sections)
+        {
+            fillFromTerrain(in, c.x, c.y, c.z);
+            const glm::ivec3 origin = c * CHUNK_SIZE;
+            MeshOutput mesh = meshCurrent(in, origin);
+
+            for (int step = 0; step < 24; step++)
+            {
+                SCOPED_TRACE(testing::Message() << "mesher " << static_cast<int>(mesher)
+                             << " section " << c.x << "," << c.y << "," << c.z << " step " << step);
+                DirtySlices slices;
+                slices.clear();
+                for (int e = 0; e <= step % 3; e++)
+                {
+                    glm::ivec3 p(coordDist(rng), coordDist(rng), coordDist(rng));
+                    int id = blockDist(rng);
+                    in.blocks[MeshInput::index(p.x, p.y, p.z)] = static_cast<BlockID>(id % 3 == 0 ? 0 : id);
+                    slices.markBox(p, p);
+                }
+                ASSERT_TRUE(slices.partial());
+
+                MeshOutput patch;
+                buildChunkMeshSlices(in, slices, origin, patch.vertices, patch.faceRanges,
+                                     patch.waterVertices, patch.waterFaceRanges);
+                spliceSlices(mesh.vertices, mesh.faceRanges, patch.vertices, patch.faceRanges, slices);
+                spliceSlices(mesh.waterVertices, mesh.waterFaceRanges, patch.waterVertices, patch.waterFaceRanges, slices);
+
+                MeshOutput full = meshCurrent(in, origin);
+                ASSERT_TRUE(samePacked(mesh.vertices, full.vertices));
+                ASSERT_TRUE(sameRanges(mesh.faceRanges, full.faceRanges));
+                ASSERT_TRUE(samePacked(mesh.waterVertices, full.waterVertices));
+                ASSERT_TRUE(sameRanges(mesh.waterFaceRanges, full.waterFaceRanges));
+            }
+        }
+    }
+    setOpaqueMesher(OpaqueMesher::Greedy);
+}
+
+TEST_F(GreedyMesherTest, StillWaterSurfaceMergesIntoOneQuad)
+{
+    static MeshInput in;
+    for (int z = -1; z <= CHUNK_SIZE; z++)
+        for (int y = -1; y <= CHUNK_SIZE; y++)
+            for (int x = -1; x <= CHUNK_SIZE; x++)
+            {
+                in.blocks[MeshInput::index(x, y, z)] = y < CHUNK_SIZE / 2 ? WATER_SOURCE : 0;
+                in.skyLight[MeshInput::index(x, y, z)] = MAX_SKY_LIGHT;
+            }
+
+    MeshOutput out = meshCurrent(in, glm::ivec3(0));
+    EXPECT_TRUE(out.vertices.empty());
+    ASSERT_EQ(out.waterVertices.size(), 4u);
+    for (PackedVertex v : out.waterVertices)
+    {
+        EXPECT_EQ(packedFace(v), DIR_POS_Y);
+        Vertex u = unpackVertex(v);
+        EXPECT_TRUE(u.pos.x == 0.0f || u.pos.x == CHUNK_SIZE);
+        EXPECT_TRUE(u.pos.z == 0.0f || u.pos.z == CHUNK_SIZE);
+        EXPECT_EQ(u.uv.x, u.pos.x);
+        EXPECT_EQ(u.uv.y, u.pos.z);
+    }
+    expectSameMesh(in, glm::ivec3(0));
+}
+
+// ---------------------------------------------------------------------------
+// Distance LOD
+// ---------------------------------------------------------------------------
+
+TEST_F(GreedyMesherTest, DownsampleFillsMajorityCellsWithTheirTopBlock)
+{
+    static MeshInput in;
+    static MeshInput out;
+    std::fill(std::begin(in.blocks), std::end(in.blocks), 0);
+    std::fill(std::begin(in.skyLight), std::end(in.skyLight), 0);
+
+    // Cell (0,0,0): dirt floor plus one grass block on top, 5 of 8 solid.
+    for (int z = 0; z < 2; z++)
+        for (int x = 0; x < 2; x++)
+            in.blocks[MeshInput::index(x, 0, z)] = 1;
+    in.blocks[MeshInput::index(1, 1, 1)] = 2;
+    in.skyLight[MeshInput::index(0, 1, 0)] = 9;
+    // Cell (2,0,0): 3 of 8 solid next to a water block.
+    in.blocks[MeshInput::index(2, 0, 0)] = 1;
+    in.blocks[MeshInput::index(3, 0, 0)] = 1;
+    in.blocks[MeshInput::index(2, 0, 1)] = 1;
+    in.blocks[MeshInput::index(3, 1, 1)] = WATER_SOURCE;
+    // Cell (4,0,0): the same 3 of 8, but resting on solid ground.
+    in.blocks[MeshInput::index(4, 0, 0)] = 1;
+    in.blocks[MeshInput::index(5, 0, 0)] = 1;
+    in.blocks[MeshInput::index(4, 0, 1)] = 1;
+    for (int z = 0; z < 2; z++)
+        for (int x = 4; x < 6; x++)
+            in.blocks[MeshInput::index(x, -1, z)] = 1;
+    // Solid apron blocks turn to air; liquids stay.
+    in.blocks[MeshInput::index(-1, 0, 0)] = 1;
+    in.blocks[MeshInput::index(-1, 0, 1)] = WATER_SOURCE;
+
+    downsampleMeshInput(in, 1, out);
+    for (int z = 0; z < 2; z++)
+        for (int y = 0; y < 2; y++)
+            for (int x = 0; x < 2; x++)
+            {
+                EXPECT_EQ(out.block(x, y, z), 2);
+                EXPECT_EQ(out.light(x, y, z), 9);
+                EXPECT_EQ(out.block(x + 2, y, z), (x == 1 && y == 1 && z == 1) ? WATER_SOURCE : 0);
+                EXPECT_EQ(out.block(x + 4, y, z), 1);
+            }
+    EXPECT_EQ(out.block(-1, 0, 0), 0);
+    EXPECT_EQ(out.block(-1, 0, 1), WATER_SOURCE);
+    EXPECT_EQ(out.light(-1, 0, 0), 9);
+}
+
+TEST_F(GreedyMesherTest, LodClosesSolidSectionWithSkirts)
+{
+    static MeshInput in;
+    std::fill(std::begin(in.blocks), std::end(in.blocks), 1);
+    std::fill(std::begin(in.skyLight), std::end(in.skyLight), MAX_SKY_LIGHT);
+
+    MeshOutput full;
+    buildChunkMeshAtLod(in, 0, glm::ivec3(0), full.vertices, full.faceRanges, full.waterVertices, full.waterFaceRanges);
+    EXPECT_TRUE(full.vertices.empty());
+
+    for (int lod = 1; lod < MESH_LOD_COUNT; lod++)
+    {
+        SCOPED_TRACE(testing::Message() << "lod " << lod);
+        MeshOutput out;
+        buildChunkMeshAtLod(in, lod, glm::ivec3(0), out.vertices, out.faceRanges, out.waterVertices, out.waterFaceRanges);
+        ASSERT_EQ(out.vertices.size(), 6u * 4u);
+        for (int dir = 0; dir < 6; dir++)
+            EXPECT_EQ(out.faceRanges.quadCount(dir), 1u);
+    }
+}
+
+TEST_F(GreedyMesherTest, LodReducesQuadsOnGeneratedTerrain)
+{
+    static MeshInput in;
+    const glm::ivec3 sections[] = {{0, 7, 0}, {3, 7, -2}, {-5, 6, 4}, {1, 8, 1}, {-3, 7, -7}};
+    size_t quads[MESH_LOD_COUNT] = {};
+    for (const glm::ivec3& c : sections)
+    {
+        fillFromTerrain(in, c.x, c.y, c.z);
+        for (int lod = 0; lod < MESH_LOD_COUNT; lod++)
+        {
+            MeshOutput out;
+            buildChunkMeshAtLod(in, lod, c * CHUNK_SIZE, out.vertices, out.faceRanges, out.waterVertices, out.waterFaceRanges);
+            quads[lod] += out.vertices.size() / 4;
+        }
+    }
+    for (int lod = 1; lod < MESH_LOD_COUNT; lod++)
+        EXPECT_LT(quads[lod], quads[lod - 1]) << "lod " << lod;
+}
+
+TEST_F(GreedyMesherTest, EmptyInputProducesNoGeometry)
+{
+    static MeshInput in;
+    std::fill(std::begin(in.blocks), std::end(in.blocks), 0);
+    std::fill(std::begin(in.skyLight), std::end(in.skyLight), MAX_SKY_LIGHT);
+
+    MeshOutput out = meshCurrent(in, glm::ivec3(0));
+    EXPECT_TRUE(out.vertices.empty());
+    EXPECT_TRUE(out.waterVertices.empty());
+}
+
+// ---------------------------------------------------------------------------
+// Bitmask kernel — same quads as the scalar greedy pass
+// ---------------------------------------------------------------------------
+
+TEST_F(GreedyMesherTest, BinaryKernelMatchesGreedyOnGeneratedTerrain)
+{
+    static MeshInput in;
+    const glm::ivec3 sections[] = {{0, 7, 0}, {-5, 6, 4}, {1, 8, 1}, {2, 5, 2}};
+    for (const glm::ivec3& c : sections)
+    {
+        SCOPED_TRACE(testing::Message() << "section " << c.x << "," << c.y << "," << c.z);
+        fillFromTerrain(in, c.x, c.y, c.z);
+        expectSameQuads(in, c * CHUNK_SIZE);
+    }
+}
+
+TEST_F(GreedyMesherTest, BinaryKernelMatchesGreedyOnRandomSections)
+{
+    static MeshInput in;
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<int> blockDist(0, 22);
+    std::uniform_int_distribution<int> lightDist(0, MAX_SKY_LIGHT);
+
+    for (int trial = 0; trial < 8; trial++)
+    {
+        SCOPED_TRACE(testing::Message() << "trial " << trial);
+        // Sparse trials leave long runs to merge; dense ones stress culling
+        // between transparent blocks of the same type.
+        int airEvery = trial < 4 ? 2 : 5;
+        for (int i = 0; i < MESH_INPUT_VOLUME; i++)
+        {
+            int id = blockDist(rng);
+            in.blocks[i] = static_cast<BlockID>(id % airEvery == 0 ? 0 : id);
+            in.skyLight[i] = static_cast<uint8_t>(trial % 2 == 0 ? MAX_SKY_LIGHT : lightDist(rng));
+        }
+        expectSameQuads(in, glm::ivec3(0, trial * CHUNK_SIZE, 0));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Light volume — light left out of the quads
+// ---------------------------------------------------------------------------
+
+static float opaqueFaceArea(const std::vector<PackedVertex>& vertices)
+{
+    float area = 0.0f;
+    for (size_t q = 0; q + 3 < vertices.size(); q += 4)
+    {
+        glm::vec3 p0 = unpackVertex(vertices[q]).pos;
+        glm::vec3 p1 = unpackVertex(vertices[q + 1]).pos;
+        glm::vec3 p2 = unpackVertex(vertices[q + 2]).pos;
+        glm::vec3 p3 = unpackVertex(vertices[q + 3]).pos;
+        area += 0.5f * glm::length(glm::cross(p2 - p0, p3 - p1));
+    }
+    return area;
+}
+
+TEST_F(GreedyMesherTest, LightVolumeMergesAcrossLightLevels)
+{
+    // A dirt floor under a shadow pattern, so every face of the floor top
+    // and of the pillars on it sees a different light from its neighbours.
+    static MeshInput in;
+    for (int z = -1; z <= CHUNK_SIZE; z++)
+        for (int y = -1; y <= CHUNK_SIZE; y++)
+            for (int x = -1; x <= CHUNK_SIZE; x++)
+            {
+                const int i = MeshInput::index(x, y, z);
+                const bool pillar = x == 4 && z == 4 && y < 12;
+                in.blocks[i] = y < 6 || pillar ? 1 : 0;
+                in.skyLight[i] = static_cast<uint8_t>(in.blocks[i] ? 0 : MAX_SKY_LIGHT - ((x + y + z) & 3));
+            }
+
+    in.lightVolume = false;
+    MeshOutput baked = meshCurrent(in, glm::ivec3(0));
+    in.lightVolume = true;
+    MeshOutput volume = meshCurrent(in, glm::ivec3(0));
+    setOpaqueMesher(OpaqueMesher::Binary);
+    MeshOutput binary = meshCurrent(in, glm::ivec3(0));
+    setOpaqueMesher(OpaqueMesher::Greedy);
+    in.lightVolume = false;
+
+    // The same faces in far fewer quads, none of which carry light.
+    EXPECT_LT(volume.vertices.size() * 10, baked.vertices.size());
+    EXPECT_FLOAT_EQ(opaqueFaceArea(volume.vertices), opaqueFaceArea(baked.vertices));
+    for (int d = 0; d < 6; d++)
+        EXPECT_EQ(volume.faceRanges.quadCount(d) == 0, baked.faceRanges.quadCount(d) == 0) << "dir " << d;
+    for (const PackedVertex& p : volume.vertices)
+        ASSERT_EQ(packedSkyLight(p), 0);
+    std::vector<Quad> expected = sortedQuads(volume.vertices);
+    std::vector<Quad> actual = sortedQuads(binary.vertices);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t q = 0; q < actual.size(); q++)
+        ASSERT_EQ(std::memcmp(actual[q].data(), expected[q].data(), sizeof(Quad)), 0) << "quad " << q;
+}
+
+// ---------------------------------------------------------------------------
+// PackedVertex — pack / unpack round trip
+// ---------------------------------------------------------------------------
+
+TEST_F(GreedyMesherTest, PackedVertexRoundTripsEveryField)
+{
+    for (int face = 0; face < 6; face++)
+    {
+        for (int light = 0; light <= MAX_SKY_LIGHT; light++)
+        {
+            for (int tint = 0; tint < TINT_PALETTE_SIZE; tint++)
+            {
+                glm::vec3 pos(face * 3 % 17, light, 16 - tint);
+                glm::vec2 uv(light, 16 - face);
+                int tile = 37 * face + tint;
+                PackedVertex p = packVertex(pos, uv, tile, static_cast<uint8_t>(light), face, tint);
+                Vertex v = unpackVertex(p);
+
+                EXPECT_EQ(v.pos, pos);
+                EXPECT_EQ(v.uv, uv);
+                EXPECT_EQ(v.tileIndex, static_cast<float>(tile));
+                EXPECT_EQ(v.skyLight, static_cast<float>(light) / MAX_SKY_LIGHT);
+                EXPECT_EQ(v.faceShade, FACE_SHADE[face]);
+                EXPECT_EQ(v.biomeTint, tintPaletteColor(tint));
+                EXPECT_EQ(packedFace(p), face);
+                EXPECT_EQ(packedSkyLight(p), light);
+                EXPECT_EQ(packedTint(p), tint);
+            }
+        }
+    }
+}
+
+TEST_F(GreedyMesherTest, PackedVertexQuantisesWaterHeightsAndUVs)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> height(0.0f, 16.0f);
+    std::uniform_real_distribution<float> texCoord(0.0f, 16.0f);
+
+    for (int i = 0; i < 1000; i++)
+    {
+        glm::vec3 pos(i % 17, height(rng), (i / 17) % 17);
+        glm::vec2 uv(texCoord(rng), texCoord(rng));
+        Vertex v = unpackVertex(packVertex(pos, uv, 4095, 0, DIR_POS_Y, TINT_NONE));
+
+        EXPECT_NEAR(v.pos.y, pos.y, 0.5f / VERTEX_Y_STEPS);
+        EXPECT_NEAR(v.uv.x, uv.x, 0.5f / VERTEX_UV_STEPS);
+        EXPECT_NEAR(v.uv.y, uv.y, 0.5f / VERTEX_UV_STEPS);
+        EXPECT_EQ(v.tileIndex, 4095.0f);
+    }
+}
+
+TEST_F(GreedyMesherTest, TintPaletteMatchesBiomeTints)
+{
+    EXPECT_EQ(tintPaletteColor(TINT_NONE), glm::vec3(1.0f));
+    for (int b = 0; b < BIOME_TINT_COUNT; b++)
+    {
+        EXPECT_EQ(tintPaletteColor(grassTintIndex(b)), getBiomeGrassTint(static_cast<BiomeID>(b)));
+        EXPECT_EQ(tintPaletteColor(foliageTintIndex(b)), getBiomeFoliageTint(static_cast<BiomeID>(b)));
+    }
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "rendering/Horizon.h"
+#include "world/TerrainGenerator.h"
+
+#include <algorithm>
+#include <vector>
+
+TEST(HorizonTest, TileFollowsGeneratorHeights)
+{
+    std::vector<HorizonVertex> verts;
+    bool sawLand = false;
+    const int seaLevel = getSeaLevel();
+
+    // A strip of tiles on both sides of the origin.
+    for (int tileX = -3; tileX <= 3; tileX++)
+    {
+        buildHorizonTile(tileX, -1, verts);
+        ASSERT_EQ(verts.size(), static_cast<size_t>(HORIZON_TILE_VERTICES));
+
+        for (int j = 0; j < HORIZON_TILE_SIDE; j++)
+        {
+            for (int i = 0; i < HORIZON_TILE_SIDE; i++)
+            {
+                const HorizonVertex& v = verts[j * HORIZON_TILE_SIDE + i];
+                EXPECT_FLOAT_EQ(v.pos.x, static_cast<float>(i * HORIZON_CELL_SIZE));
+                EXPECT_FLOAT_EQ(v.pos.z, static_cast<float>(j * HORIZON_CELL_SIZE));
+
+                int h = getTerrainHeightAt(tileX * HORIZON_TILE_SIZE + i * HORIZON_CELL_SIZE,
+                                           -HORIZON_TILE_SIZE + j * HORIZON_CELL_SIZE);
+                if (h < seaLevel)
+                {
+                    EXPECT_GT(v.pos.y, static_cast<float>(seaLevel));
+                    EXPECT_LT(v.pos.y, static_cast<float>(seaLevel + 1));
+                }
+                else
+                {
+                    EXPECT_FLOAT_EQ(v.pos.y, static_cast<float>(h + 1));
+                    sawLand = true;
+                }
+            }
+        }
+    }
+    EXPECT_TRUE(sawLand);
+}
+
+TEST(HorizonTest, TilesShareEdgeVertices)
+{
+    std::vector<HorizonVertex> left, right;
+    buildHorizonTile(4, 2, left);
+    buildHorizonTile(5, 2, right);
+
+    // The last column of one tile is the first column of the next, so
+    // neighbouring tiles meet without cracks.
+    for (int j = 0; j < HORIZON_TILE_SIDE; j++)
+    {
+        const HorizonVertex& a = left[j * HORIZON_TILE_SIDE + HORIZON_TILE_CELLS];
+        const HorizonVertex& b = right[j * HORIZON_TILE_SIDE];
+        EXPECT_FLOAT_EQ(a.pos.y, b.pos.y);
+        EXPECT_FLOAT_EQ(a.pos.x - HORIZON_TILE_SIZE, b.pos.x);
+    }
+}
+
+TEST(HorizonTest, IndicesCoverEveryCellWithinTheGrid)
+{
+    std::vector<uint16_t> indices = horizonTileIndices();
+    ASSERT_EQ(indices.size(), static_cast<size_t>(HORIZON_TILE_CELLS * HORIZON_TILE_CELLS * 6));
+    EXPECT_LT(*std::max_element(indices.begin(), indices.end()), HORIZON_TILE_VERTICES);
+}
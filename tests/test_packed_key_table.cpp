@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include "utils/PackedKeyTable.h"
+
+#include <random>
+#include <unordered_map>
+
+// ---------------------------------------------------------------------------
+// packCoordKey / unpackCoordKey
+// ---------------------------------------------------------------------------
+
+TEST(PackCoordKey, RoundTripsNegativeAndPositive)
+{
+    const glm::ivec3 coords[] = {
+        {0, 0, 0}, {-1, -1, -1}, {1, 2, 3}, {-1048576, 0, 1048575},
+        {12345, -67, -89012}, {1048575, 1048575, 1048575},
+    };
+    for (const glm::ivec3& c : coords)
+        EXPECT_EQ(unpackCoordKey(packCoordKey(c.x, c.y, c.z)), c);
+}
+
+TEST(PackCoordKey, DistinctCoordsGiveDistinctKeys)
+{
+    EXPECT_NE(packCoordKey(1, 0, 0), packCoordKey(0, 1, 0));
+    EXPECT_NE(packCoordKey(0, 1, 0), packCoordKey(0, 0, 1));
+    EXPECT_NE(packCoordKey(-1, 0, 0), packCoordKey(1, 0, 0));
+}
+
+TEST(PackCoordKey, NeverProducesEmptyKey)
+{
+    EXPECT_NE(packCoordKey(1048575, 1048575, 1048575), PackedKeyTable<int>::EMPTY_KEY);
+}
+
+// ---------------------------------------------------------------------------
+// PackedKeyTable
+// ---------------------------------------------------------------------------
+
+TEST(PackedKeyTable, EmplaceFindErase)
+{
+    PackedKeyTable<int> table;
+    EXPECT_EQ(table.find(packCoordKey(1, 2, 3)), nullptr);
+
+    auto [value, inserted] = table.emplace(packCoordKey(1, 2, 3));
+    EXPECT_TRUE(inserted);
+    *value = 42;
+
+    auto again = table.emplace(packCoordKey(1, 2, 3));
+    EXPECT_FALSE(again.second);
+    EXPECT_EQ(*again.first, 42);
+    EXPECT_EQ(table.size(), 1u);
+
+    EXPECT_TRUE(table.erase(packCoordKey(1, 2, 3)));
+    EXPECT_FALSE(table.erase(packCoordKey(1, 2, 3)));
+    EXPECT_TRUE(table.empty());
+}
+
+TEST(PackedKeyTable, RandomOpsMatchUnorderedMap)
+{
+    std::mt19937 rng(2024);
+    PackedKeyTable<int> table;
+    std::unordered_map<uint64_t, int> reference;
+
+    for (int step = 0; step < 50000; step++)
+    {
+        int x = static_cast<int>(rng() % 40) - 20;
+        int y = static_cast<int>(rng() % 8);
+        int z = static_cast<int>(rng() % 40) - 20;
+        uint64_t key = packCoordKey(x, y, z);
+
+        if (rng() % 3 == 0)
+        {
+            EXPECT_EQ(table.erase(key), reference.erase(key) > 0);
+        }
+        else
+        {
+            *table.emplace(key).first = step;
+            reference[key] = step;
+        }
+    }
+
+    ASSERT_EQ(table.size(), reference.size());
+    for (const auto& kv : reference)
+    {
+        const int* v = table.find(kv.first);
+        ASSERT_NE(v, nullptr);
+        EXPECT_EQ(*v, kv.second);
+    }
+
+    size_t visited = 0;
+    for (auto& slot : table)
+    {
+        EXPECT_EQ(reference.at(slot.key), slot.value);
+        visited++;
+    }
+    EXPECT_EQ(visited, reference.size());
+}
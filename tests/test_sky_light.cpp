@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include "world/SkyLight.h"
+#include "utils/BlockTypes.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+class SkyLightTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        initBlockTypes();
+    }
+};
+
+SectionSnapshot airSection(uint8_t light)
+{
+    SectionSnapshot s;
+    s.blocks.fill(0);
+    s.skyLight.fill(light);
+    return s;
+}
+
+// A 2x2 block of sections side by side, open to the sky.
+struct TestWorld : SkyLightWorld
+{
+    static constexpr int SECTIONS = 2;
+    static constexpr int WIDTH = SECTIONS * CHUNK_SIZE;
+
+    BlockID blocks[WIDTH * CHUNK_SIZE * WIDTH] = {};
+    uint8_t light[WIDTH * CHUNK_SIZE * WIDTH] = {};
+
+    static bool inside(const glm::ivec3& p)
+    {
+        return p.x >= 0 && p.x < WIDTH && p.y >= 0 && p.y < CHUNK_SIZE && p.z >= 0 && p.z < WIDTH;
+    }
+    static int index(const glm::ivec3& p) { return (p.z * CHUNK_SIZE + p.y) * WIDTH + p.x; }
+
+    bool cell(const glm::ivec3& pos, BlockID& block, uint8_t& l) override
+    {
+        if (!inside(pos))
+            return false;
+        block = blocks[index(pos)];
+        l = light[index(pos)];
+        return true;
+    }
+    void setLight(const glm::ivec3& pos, uint8_t l) override { light[index(pos)] = l; }
+
+    SectionSnapshot section(int sx, int sz) const
+    {
+        BlockID b[CHUNK_VOLUME];
+        uint8_t l[CHUNK_VOLUME];
+        for (int z = 0; z < CHUNK_SIZE; z++)
+            for (int y = 0; y < CHUNK_SIZE; y++)
+                for (int x = 0; x < CHUNK_SIZE; x++)
+                {
+                    int src = index({sx * CHUNK_SIZE + x, y, sz * CHUNK_SIZE + z});
+                    b[blockIndex(x, y, z)] = blocks[src];
+                    l[blockIndex(x, y, z)] = light[src];
+                }
+        SectionSnapshot s;
+        s.blocks.assign(b);
+        s.skyLight.assign(l);
+        return s;
+    }
+
+    // Lights every section from dark with computeSkyLight, passing light
+    // across borders until nothing changes, as the Light jobs would.
+    void relightFully()
+    {
+        std::memset(light, 0, sizeof(light));
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            for (int sz = 0; sz < SECTIONS; sz++)
+                for (int sx = 0; sx < SECTIONS; sx++)
+                {
+                    SectionSnapshot sides[4];
+                    const SectionSnapshot* neighbors[6] = {};
+                    if (sx + 1 < SECTIONS) { sides[0] = section(sx + 1, sz); neighbors[0] = &sides[0]; }
+                    if (sx > 0) { sides[1] = section(sx - 1, sz); neighbors[1] = &sides[1]; }
+                    if (sz + 1 < SECTIONS) { sides[2] = section(sx, sz + 1); neighbors[4] = &sides[2]; }
+                    if (sz > 0) { sides[3] = section(sx, sz - 1); neighbors[5] = &sides[3]; }
+
+                    uint8_t out[CHUNK_VOLUME];
+                    computeSkyLight(section(sx, sz), neighbors, out);
+                    for (int z = 0; z < CHUNK_SIZE; z++)
+                        for (int y = 0; y < CHUNK_SIZE; y++)
+                            for (int x = 0; x < CHUNK_SIZE; x++)
+                            {
+                                uint8_t& dst = light[index({sx * CHUNK_SIZE + x, y, sz * CHUNK_SIZE + z})];
+                                uint8_t value = out[blockIndex(x, y, z)];
+                                changed = changed || dst != value;
+                                dst = value;
+                            }
+                }
+        }
+    }
+};
+
+}
+
+TEST_F(SkyLightTest, OpenSkyLightsEveryAirCell)
+{
+    SectionSnapshot section = airSection(0);
+    const SectionSnapshot* neighbors[6] = {};
+    uint8_t light[CHUNK_VOLUME];
+    computeSkyLight(section, neighbors, light);
+    for (int i = 0; i < CHUNK_VOLUME; i++)
+        ASSERT_EQ(light[i], MAX_SKY_LIGHT) << "index " << i;
+}
+
+// Only full light falls without loss; anything dimmer fades on the way down.
+TEST_F(SkyLightTest, ColumnsStartFromTheSectionAbove)
+{
+    SectionSnapshot section = airSection(0);
+    section.blocks.set(blockIndex(5, 14, 5), 6);
+    SectionSnapshot above = airSection(0);
+    above.skyLight.set(blockIndex(3, 0, 3), 7);
+    for (int x = 0; x < CHUNK_SIZE; x++)
+        for (int z = 0; z < CHUNK_SIZE; z++)
+            if (x != 3 || z != 3)
+                above.blocks.set(blockIndex(x, 0, z), 1);
+    const SectionSnapshot* neighbors[6] = {nullptr, nullptr, &above, nullptr, nullptr, nullptr};
+
+    uint8_t light[CHUNK_VOLUME];
+    computeSkyLight(section, neighbors, light);
+    EXPECT_EQ(light[blockIndex(3, 15, 3)], 6);
+    EXPECT_EQ(light[blockIndex(3, 11, 3)], 2);
+    EXPECT_EQ(light[blockIndex(3, 9, 3)], 0);
+
+    above = airSection(MAX_SKY_LIGHT);
+    computeSkyLight(section, neighbors, light);
+    EXPECT_EQ(light[blockIndex(3, 0, 3)], MAX_SKY_LIGHT);
+    // Leaves on an even layer dim the column under them.
+    EXPECT_EQ(light[blockIndex(5, 15, 5)], MAX_SKY_LIGHT);
+    EXPECT_EQ(light[blockIndex(5, 14, 5)], MAX_SKY_LIGHT - 1);
+    EXPECT_EQ(light[blockIndex(5, 13, 5)], MAX_SKY_LIGHT - 1);
+}
+
+// Under the column heightmap, a solid section above gives no light even if
+// it still holds the full light it was created with.
+TEST_F(SkyLightTest, SolidSectionAboveGivesNoLight)
+{
+    SectionSnapshot section = airSection(0);
+    SectionSnapshot above = airSection(MAX_SKY_LIGHT);
+    above.blocks.fill(3);
+    const SectionSnapshot* neighbors[6] = {nullptr, nullptr, &above, nullptr, nullptr, nullptr};
+    uint8_t covered[CHUNK_SIZE * CHUNK_SIZE];
+    std::memset(covered, CHUNK_SIZE, sizeof(covered));
+
+    uint8_t light[CHUNK_VOLUME];
+    computeSkyLight(section, neighbors, light, covered);
+    for (int i = 0; i < CHUNK_VOLUME; i++)
+        ASSERT_EQ(light[i], 0) << "index " << i;
+}
+
+// A roofed section lit only through its +x side: light fades one level per
+// block away from that border.
+TEST_F(SkyLightTest, LightCrossesSectionBorders)
+{
+    SectionSnapshot section = airSection(0);
+    for (int z = 0; z < CHUNK_SIZE; z++)
+        for (int x = 0; x < CHUNK_SIZE; x++)
+            section.blocks.set(blockIndex(x, CHUNK_SIZE - 1, z), 1);
+    SectionSnapshot side = airSection(MAX_SKY_LIGHT);
+    const SectionSnapshot* neighbors[6] = {&side, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+    uint8_t light[CHUNK_VOLUME];
+    computeSkyLight(section, neighbors, light);
+    EXPECT_EQ(light[blockIndex(15, 8, 8)], MAX_SKY_LIGHT - 1);
+    EXPECT_EQ(light[blockIndex(10, 8, 8)], MAX_SKY_LIGHT - 6);
+    EXPECT_EQ(light[blockIndex(1, 8, 8)], 0);
+    EXPECT_EQ(light[blockIndex(10, CHUNK_SIZE - 1, 8)], 0);
+
+    uint8_t dark[CHUNK_VOLUME] = {};
+    EXPECT_TRUE(lightBorderChanged(dark, light, 0));
+    EXPECT_FALSE(lightBorderChanged(dark, light, 1));
+}
+
+// Random digging and building under a roof with holes: after every edit the
+// incremental update must land exactly where a full relight does.
+TEST_F(SkyLightTest, IncrementalUpdateMatchesFullRelight)
+{
+    static TestWorld world;
+    static TestWorld reference;
+    std::mt19937 rng(99);
+    for (int z = 0; z < TestWorld::WIDTH; z++)
+        for (int y = 0; y < CHUNK_SIZE; y++)
+            for (int x = 0; x < TestWorld::WIDTH; x++)
+            {
+                BlockID id = 0;
+                if (y < 6 || (y == 12 && rng() % 8 != 0))
+                    id = 1;
+                else if (y == 11 && rng() % 4 == 0)
+                    id = 6;
+                world.blocks[TestWorld::index({x, y, z})] = id;
+            }
+    world.relightFully();
+
+    std::uniform_int_distribution<int> horizontal(0, TestWorld::WIDTH - 1);
+    std::uniform_int_distribution<int> vertical(0, CHUNK_SIZE - 1);
+    const BlockID choices[] = {0, 0, 1, 6, 9};
+    for (int step = 0; step < 200; step++)
+    {
+        glm::ivec3 p(horizontal(rng), vertical(rng), horizontal(rng));
+        world.blocks[TestWorld::index(p)] = choices[rng() % 5];
+        updateSkyLight(world, p);
+
+        std::memcpy(reference.blocks, world.blocks, sizeof(world.blocks));
+        reference.relightFully();
+        ASSERT_EQ(std::memcmp(world.light, reference.light, sizeof(world.light)), 0)
+            << "step " << step << " at " << p.x << "," << p.y << "," << p.z;
+    }
+}
+
+// Solid placeholders used to hold full light; digging a sealed cell out of
+// stone that still claims it must leave the cell dark.
+TEST_F(SkyLightTest, DugCellInStaleSolidStaysDark)
+{
+    static TestWorld world;
+    for (int i = 0; i < TestWorld::WIDTH * CHUNK_SIZE * TestWorld::WIDTH; i++)
+    {
+        world.blocks[i] = 1;
+        world.light[i] = MAX_SKY_LIGHT;
+    }
+    const glm::ivec3 p(8, 4, 8);
+    world.blocks[TestWorld::index(p)] = 0;
+    updateSkyLight(world, p);
+    EXPECT_EQ(world.light[TestWorld::index(p)], 0);
+}
+
+TEST_F(SkyLightTest, BorderHashOnlySeesTheTouchingLayer)
+{
+    LightStorage light(MAX_SKY_LIGHT);
+    const uint32_t open = lightBorderHash(light, 0);
+    EXPECT_NE(open, 0u);
+
+    // Face +x reads the neighbour's x = 0 layer; deeper cells don't count.
+    light.set(blockIndex(1, 4, 4), 3);
+    EXPECT_EQ(lightBorderHash(light, 0), open);
+    light.set(blockIndex(0, 4, 4), 3);
+    EXPECT_NE(lightBorderHash(light, 0), open);
+    EXPECT_EQ(lightBorderHash(light, 1), open);
+}